@@ -1,6 +1,8 @@
 const express = require("express");
 const cors = require("cors");
-const { execFile } = require("child_process");
+const { execFile, spawn } = require("child_process");
+const net = require("net");
+const os = require("os");
 const path = require("path");
 
 const app = express();
@@ -14,20 +16,22 @@ const exePath =
 let parkingState = null; 
 let trafficNoise = 0;
 
-const PHASES = [
-  { code: "NS_GREEN",  text: "N-S green, E-W red",  allowGo: true },
-  { code: "NS_YELLOW", text: "N-S yellow, E-W red", allowGo: true },
-  { code: "EW_GREEN",  text: "N-S red, E-W green",  allowGo: false },
-  { code: "EW_YELLOW", text: "N-S red, E-W yellow", allowGo: false },
+// Engine phase names ("signal-status") -> payload fields
+const PHASES = {
+  "N-S green":  { code: "NS_GREEN",  text: "N-S green, E-W red",  allowGo: true },
+  "N-S yellow": { code: "NS_YELLOW", text: "N-S yellow, E-W red", allowGo: true },
+  "E-W green":  { code: "EW_GREEN",  text: "N-S red, E-W green",  allowGo: false },
+  "E-W yellow": { code: "EW_YELLOW", text: "N-S red, E-W yellow", allowGo: false },
+};
+// Our real-world intersections mapped to node IDs; their signal plans
+// (cycle, green wave) live in the engine
+const INTERSECTIONS = [
+  { id: "fortis",    name: "Fortis Crossing",            node: 2  }, // Fortis Hospital
+  { id: "corenthum", name: "Corenthum Junction",         node: 3  }, // The Corenthum
+  { id: "nh9",       name: "NH-9 Loop",                  node: 12 }, // NH-9 ramp
+  { id: "shipra",    name: "Shipra–IHC Cross",           node: 9  }, // IHC / Shipra area
 ];
-// Our real-world intersections mapped to node IDs
-let intersectionsState = [
-  { id: "fortis",    name: "Fortis Crossing",            node: 2,  phaseIndex: 0 }, // Fortis Hospital
-  { id: "corenthum", name: "Corenthum Junction",         node: 3,  phaseIndex: 1 }, // The Corenthum
-  { id: "nh9",       name: "NH-9 Loop",                  node: 12, phaseIndex: 2 }, // NH-9 ramp
-  { id: "shipra",    name: "Shipra–IHC Cross",           node: 9,  phaseIndex: 0 }, // IHC / Shipra area
-];
-function runCity(args) {
+function runCityOnce(args) {
   return new Promise((resolve, reject) => {
     execFile(exePath, args, { encoding: "utf8" }, (err, stdout, stderr) => {
       if (err) {
@@ -38,14 +42,93 @@ function runCity(args) {
     });
   });
 }
+
+// ---- Persistent engine daemon (`city serve <socket>`) ----
+// Frames are a 4-byte big-endian length followed by the payload:
+//   request  "<id> <command> <args...>"
+//   response "<id> ok <output>" | "<id> err <message>"
+const socketPath =
+  process.env.CITY_SOCKET || path.join(os.tmpdir(), "citysense.sock");
+let daemon = null; // { sock, pending: Map<id, {resolve, reject}> }
+let nextRequestId = 1;
+
+function connectDaemon(retries) {
+  const sock = net.createConnection(socketPath);
+  const pending = new Map();
+  let buffer = Buffer.alloc(0);
+
+  sock.on("connect", () => {
+    daemon = { sock, pending };
+    console.log(`Engine daemon connected on ${socketPath}`);
+  });
+  sock.on("data", (chunk) => {
+    buffer = Buffer.concat([buffer, chunk]);
+    while (buffer.length >= 4) {
+      const len = buffer.readUInt32BE(0);
+      if (buffer.length < 4 + len) break;
+      const payload = buffer.toString("utf8", 4, 4 + len);
+      buffer = buffer.subarray(4 + len);
+
+      const [id, status] = payload.split(" ", 2);
+      const body = payload.slice(id.length + status.length + 2);
+      const waiter = pending.get(id);
+      if (!waiter) continue;
+      pending.delete(id);
+      if (status === "ok") waiter.resolve(body.trim());
+      else waiter.reject(new Error(body));
+    }
+  });
+  sock.on("error", () => {
+    if (!daemon && retries > 0) {
+      setTimeout(() => connectDaemon(retries - 1), 200);
+    }
+  });
+  sock.on("close", () => {
+    if (daemon && daemon.sock === sock) daemon = null;
+    for (const waiter of pending.values()) {
+      waiter.reject(new Error("Engine daemon disconnected"));
+    }
+    pending.clear();
+  });
+}
+
+function startDaemon() {
+  if (process.platform === "win32") return; // no Unix sockets: one-shot only
+  const child = spawn(exePath, ["serve", socketPath], {
+    stdio: ["ignore", "ignore", "inherit"],
+  });
+  child.on("error", (err) => console.error("Engine daemon failed:", err));
+  child.on("exit", (code) => {
+    console.error(`Engine daemon exited (${code}), using one-shot calls`);
+  });
+  process.on("exit", () => child.kill());
+  for (const sig of ["SIGINT", "SIGTERM"]) process.on(sig, () => process.exit(0));
+  connectDaemon(25);
+}
+
+function runCity(args) {
+  if (!daemon) return runCityOnce(args);
+
+  return new Promise((resolve, reject) => {
+    const id = String(nextRequestId++);
+    const payload = Buffer.from([id, ...args].join(" "), "utf8");
+    const header = Buffer.alloc(4);
+    header.writeUInt32BE(payload.length, 0);
+    daemon.pending.set(id, { resolve, reject });
+    daemon.sock.write(Buffer.concat([header, payload]));
+  });
+}
 // /route?src=7&dest=8
 app.get("/route", async (req, res) => {
   try {
     const src = parseInt(req.query.src, 10) || 1;
     const dest = parseInt(req.query.dest, 10) || src;
 
-    // 1) distances from src to all nodes
-    const outDist = await runCity(["route", String(src)]);
+    // distances from src to all nodes, and the path from src to dest
+    const [outDist, outPath] = await Promise.all([
+      runCity(["route", String(src)]),
+      runCity(["route-path", String(src), String(dest)]),
+    ]);
     const parts = outDist.split(/\s+/).map((x) => x.trim());
     const n = parseInt(parts[0], 10) || 0;
     const distances = [];
@@ -58,12 +141,6 @@ app.get("/route", async (req, res) => {
       }
       distances.push({ node: nodeId, distance });
     }
-    // 2) path from src to dest
-    const outPath = await runCity([
-      "route-path",
-      String(src),
-      String(dest),
-    ]);
     const pt = outPath.split(/\s+/).map((x) => x.trim());
     const k = parseInt(pt[0], 10) || 0;
     const path =
@@ -165,31 +242,39 @@ app.get("/parking-status", async (req, res) => {
   }
 });
 
-// /signal-status — multiple intersections, independent cycles
+// /signal-status — current phase of every intersection, from the engine
 app.get("/signal-status", async (req, res) => {
   try {
-    // advance each intersection's phase
-    intersectionsState = intersectionsState.map((s) => {
-      const nextIndex = (s.phaseIndex + 1) % PHASES.length;
-      return { ...s, phaseIndex: nextIndex };
-    });
+    // format: "2:N-S green:12,3:E-W yellow:3,..." (node:phase:secondsLeft)
+    const out = await runCity(["signal-status"]);
+    const phases = new Map();
+    out
+      .split(",")
+      .map((s) => s.trim())
+      .filter(Boolean)
+      .forEach((s) => {
+        const [node, phase, left] = s.split(":");
+        phases.set(parseInt(node, 10), { phase, secondsLeft: parseInt(left, 10) });
+      });
 
     // build API payload
-    const intersections = intersectionsState.map((s) => {
-      const phase = PHASES[s.phaseIndex];
+    const intersections = INTERSECTIONS.filter((s) => phases.has(s.node)).map((s) => {
+      const { phase: name, secondsLeft } = phases.get(s.node);
+      const phase = PHASES[name] || { code: "UNKNOWN", text: name, allowGo: false };
       return {
         id: s.id,
         name: s.name,
         node: s.node,          // matches Graph node ID
         phaseCode: phase.code, // e.g. "NS_GREEN"
         phaseText: phase.text, // e.g. "N-S green, E-W red"
-        allowGo: phase.allowGo // true => vehicles allowed to go
+        allowGo: phase.allowGo, // true => vehicles allowed to go
+        secondsLeft            // until the next phase change
       };
     });
 
     // keep backward-compatible simple status text (for your sidebar)
     const first = intersections[0];
-    const status = `${first.name}: ${first.phaseText}`;
+    const status = first ? `${first.name}: ${first.phaseText}` : "No signals";
 
     res.json({ status, intersections });
   } catch (e) {
@@ -199,6 +284,8 @@ app.get("/signal-status", async (req, res) => {
 });
 
 
+startDaemon();
+
 const PORT = 5000;
 app.listen(PORT, () => {
   console.log(`API running on http://localhost:${PORT}`);
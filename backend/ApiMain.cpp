@@ -1,15 +1,78 @@
+#include <cstdlib>
+#include <ctime>
 #include <iostream>
+#include <sstream>
 #include <vector>
 #include <string>
 #include <limits>
 #include "core/CoreEngineService.h"
+#include "simulation/SignalScheduler.h"
+#include "simulation/SimulationSnapshot.h"
+#include "simulation/TrafficController.h"
+#include "EngineServer.h"
 
 static CoreEngineService engine;
+static TrafficController signals;
+static SignalScheduler signalClock(signals);
+// Ids of incidents queued by commands; never reused, so requests a
+// dispatch left queued are not overwritten by later ones
+static int nextIncidentId = 1;
 
-void initEngine() {
+// Signalised junctions of the demo city, keyed by graph node (the same
+// ones the frontend shows): a 64 s cycle of N-S green / yellow, E-W
+// green / yellow. Fortis -> NH-9 -> Shipra-IHC is a green wave, each
+// 4 km (~360 s at 40 km/h) behind the previous signal.
+static void initSignals() {
+    const int nodes[] = {2, 3, 12, 9};
+    for (int node : nodes) {
+        signals.addSignalPhase(node, "N-S", 30);
+        signals.addSignalPhase(node, "N-S yellow", 4);
+        signals.addSignalPhase(node, "E-W", 26);
+        signals.addSignalPhase(node, "E-W yellow", 4);
+    }
+    signalClock.coordinateCorridor({signals.intersectionIndex(2), signals.intersectionIndex(12),
+                                    signals.intersectionIndex(9)},
+                                   {360, 360});
+    signalClock.setOffset(signals.intersectionIndex(3), 34);
+    signalClock.start(0);
+}
+
+// Seconds since local midnight
+static int64_t secondOfDay() {
+    std::time_t now = std::time(nullptr);
+    std::tm local{};
+#ifdef _WIN32
+    localtime_s(&local, &now);
+#else
+    localtime_r(&now, &local);
+#endif
+    return local.tm_hour * 3600 + local.tm_min * 60 + local.tm_sec;
+}
+
+// serving: the process stays up, so a city graph file is worth
+// preprocessing for route-path queries
+void initEngine(bool serving) {
     static bool initialized = false;
     if (initialized) return;
     initialized = true;
+    initSignals();
+
+    // A binary city graph (see tools/GraphConvert) replaces the demo roads.
+    // It is mapped, not parsed, and prepared for concurrent searches like
+    // the demo roads. The daemon also builds the hierarchy for it (tens of
+    // seconds on a large city); a one-shot command would pay that on every
+    // run, so route-path there uses A* / Dijkstra.
+    if (const char *graphFile = std::getenv("CITYSENSE_GRAPH")) {
+        if (engine.loadCityGraphFile(graphFile)) {
+            std::cerr << "Engine initialized from " << graphFile << "\n";
+            engine.updateTraffic(0, 15);
+            engine.updateTraffic(1, 23);
+            engine.updateTraffic(2, 10);
+            engine.freezeGraph();
+            if (serving) engine.buildHierarchy();
+            return;
+        }
+    }
 
     std::cerr << "Engine initialized for JIIT + Indirapuram graph\n";
     engine.reserveNodes(12);
@@ -28,6 +91,17 @@ void initEngine() {
     // 11 - Orange County
     // 12 - NH-9 Ramp / Kala Patthar Junction
 
+    // Approximate locations, same as the map markers in the frontend
+    const double location[12][2] = {
+        {28.616986, 77.373589}, {28.618888, 77.372459}, {28.628151, 77.367783},
+        {28.621033, 77.362389}, {28.6245, 77.3685},     {28.6270, 77.3715},
+        {28.6298, 77.3679},     {28.6415, 77.3714},     {28.6425, 77.3730},
+        {28.6435, 77.3770},     {28.6405, 77.3685},     {28.6390, 77.3805},
+    };
+    for (int id = 1; id <= 12; ++id) {
+        engine.setNodeLocation(id, location[id - 1][0], location[id - 1][1]);
+    }
+
     auto addUndirected = [&](int a, int b, double w) {
         engine.addRoad(a, b, w);
         engine.addRoad(b, a, w);
@@ -60,102 +134,292 @@ void initEngine() {
     addUndirected(9, 11, 1.0);  // IHC <-> Orange County
     addUndirected(11, 8, 1.0);  // Orange County <-> Shipra
 
+    // Responder units: ambulances at Fortis and Shipra, fire crew at NH-9
+    engine.addResponderUnit(1, 2, "ambulance");
+    engine.addResponderUnit(2, 8, "ambulance");
+    engine.addResponderUnit(3, 12, "fire");
+
     // Some basic traffic data for congestion API (3 time slots)
     engine.updateTraffic(0, 15);
     engine.updateTraffic(1, 23);
     engine.updateTraffic(2, 10);
+
+    // Pack the road graph now so concurrent daemon queries only read it,
+    // and preprocess it for route-path queries
+    engine.freezeGraph();
+    engine.buildHierarchy();
 }
 
-int main(int argc, char** argv) {
-    if (argc < 2) {
-        return 0;
+// Formats "n d1 d2 ... dn" for a 1-based distance vector
+static void writeDistances(std::ostream &out, const std::vector<double> &dist) {
+    int n = static_cast<int>(dist.size()) - 1; // ignore index 0
+
+    out << n;
+    for (int i = 1; i <= n; ++i) {
+        double d = dist[i];
+        if (d == std::numeric_limits<double>::infinity()) {
+            out << " " << "inf";
+        } else {
+            out << " " << d;
+        }
     }
+}
 
-    initEngine();
-    std::string cmd = argv[1];
+// Runs one command; args[0] is the command name. Shared by the one-shot
+// CLI and the serve daemon, so output never carries a trailing newline.
+std::string runCommand(const std::vector<std::string> &args) {
+    std::ostringstream out;
+    int argc = static_cast<int>(args.size());
+    const std::string &cmd = args[0];
 
     if (cmd == "route") {
         int src = 1;
-        if (argc >= 3) src = std::stoi(argv[2]);
-
-        std::vector<double> dist = engine.computeRoute(src);
-        int n = static_cast<int>(dist.size()) - 1; // ignore index 0
+        if (argc >= 2) src = std::stoi(args[1]);
 
-        std::cout << n;
-        for (int i = 1; i <= n; ++i) {
-            double d = dist[i];
-            if (d == std::numeric_limits<double>::infinity()) {
-                std::cout << " " << "inf";
-            } else {
-                std::cout << " " << d;
-            }
-        }
-        std::cout << std::endl;
+        writeDistances(out, engine.computeRoute(src));
     }
 
     // ---------- emergency-route <src> ----------
     else if (cmd == "emergency-route") {
         int src = 1;
-        if (argc >= 3) src = std::stoi(argv[2]);
+        if (argc >= 2) src = std::stoi(args[1]);
 
-        engine.addEmergencyRequest(1, src, "ambulance", 1.0);
+        // Ahead of anything dispatch left queued (those count from 1)
+        engine.addEmergencyRequest(nextIncidentId++, src, "ambulance", 0.0);
         std::vector<double> routeDist;
         engine.processNextEmergency(routeDist);
 
-        int n = static_cast<int>(routeDist.size()) - 1;
-        std::cout << n;
-        for (int i = 1; i <= n; ++i) {
-            double d = routeDist[i];
-            if (d == std::numeric_limits<double>::infinity()) {
-                std::cout << " " << "inf";
+        writeDistances(out, routeDist);
+    }
+
+    // ---------- dispatch <n1,n2,...> [type] ----------
+    // Queues one incident per node (earlier = more urgent) and dispatches
+    // them with any left queued by earlier calls. Ids count up across
+    // calls. Output format: k, then per request: id unit cost len v1 ...
+    // vlen (unit -1, cost inf, len 0 when nobody can go; such requests
+    // stay queued unless their node is not in the graph)
+    else if (cmd == "dispatch") {
+        if (argc < 2) {
+            out << 0;
+            return out.str();
+        }
+        std::string type = argc >= 3 ? args[2] : "ambulance";
+
+        std::stringstream ss(args[1]);
+        std::string token;
+        while (std::getline(ss, token, ',')) {
+            if (token.empty()) continue;
+            int id = nextIncidentId++;
+            engine.addEmergencyRequest(id, std::stoi(token), type, static_cast<double>(id));
+        }
+
+        std::vector<DispatchAssignment> plan = engine.dispatchEmergencies();
+        out << plan.size();
+        for (const auto &a : plan) {
+            out << " " << a.requestId << " " << a.unitId << " ";
+            if (a.unitId < 0) {
+                out << "inf";
             } else {
-                std::cout << " " << d;
+                out << a.cost;
             }
+            out << " " << a.route.size();
+            for (int v : a.route) out << " " << v;
         }
-        std::cout << std::endl;
+    }
+
+    // ---------- unit-available <id> [0|1] ----------
+    else if (cmd == "unit-available") {
+        if (argc < 2) {
+            out << 0;
+            return out.str();
+        }
+        bool available = argc < 3 || args[2] != "0";
+        out << (engine.setResponderAvailable(std::stoi(args[1]), available) ? 1 : 0);
     }
 
     // ---------- congestion <start> <end> ----------
     else if (cmd == "congestion") {
-        if (argc < 4) {
-            std::cout << 0 << std::endl;
-            return 0;
+        if (argc < 3) {
+            out << 0;
+            return out.str();
+        }
+        int64_t start = std::stoll(args[1]);
+        int64_t end   = std::stoll(args[2]);
+        int64_t value = engine.getTrafficRange(start, end);
+        out << value;
+    }
+
+    // ---------- congestion-stats <start> <end> ----------
+    // Output format: sum min max count mean (all 0 when no minute has data)
+    else if (cmd == "congestion-stats") {
+        if (argc < 3) {
+            out << 0;
+            return out.str();
+        }
+        SeriesAggregate stats = engine.getTrafficStats(std::stoll(args[1]), std::stoll(args[2]));
+        if (stats.count == 0) {
+            out << "0 0 0 0 0";
+        } else {
+            out << stats.sum << " " << stats.min << " " << stats.max << " "
+                << stats.count << " " << stats.mean();
         }
-        int start = std::stoi(argv[2]);
-        int end   = std::stoi(argv[3]);
-        int value = engine.getTrafficRange(start, end);
-        std::cout << value << std::endl;
     }
 
     else if (cmd == "parking-status") {
-    // zone1: JIIT/Fortis
-    // zone2: IT Belt
-    // zone3: Indirapuram
-    std::cout << "zone1:3/10,zone2:5/8,zone3:7/12" << std::endl;
-}
-    // ---------- stub: signal-status ----------
+        // zone1: JIIT/Fortis
+        // zone2: IT Belt
+        // zone3: Indirapuram
+        out << "zone1:3/10,zone2:5/8,zone3:7/12";
+    }
+    // ---------- signal-status [secondOfDay] ----------
+    // Phases at that time (default: now, local), from the signal plans.
+    // Output format: node:phase:secondsLeft,...  e.g. "2:N-S green:12"
     else if (cmd == "signal-status") {
-        std::cout << "intersection1:N-S green,E-W red" << std::endl;
-    }
- 
-// ---------- route-path <src> <dest> ----------
-// Output format: k v1 v2 ... vk   where k = path length
-else if (cmd == "route-path") {
-    if (argc < 4) {
-        std::cout << 0 << std::endl;
-        return 0;
+        int64_t t = argc >= 2 ? std::stoll(args[1]) : secondOfDay();
+        if (t < signalClock.now()) {
+            signalClock.start(t);   // a new day, or an earlier time asked for
+        } else {
+            signalClock.advanceTo(t);
+        }
+        for (int i = 0; i < signals.intersectionCount(); ++i) {
+            int count = 0;
+            const SignalPhase &phase = signals.phaseList(i, count)[signals.phaseOf(i)];
+            if (i > 0) out << ",";
+            out << signals.intersectionId(i) << ":" << approachesName(phase.green)
+                << (phase.yellow ? " yellow" : " green") << ":"
+                << signalClock.nextChange(i) - signalClock.now();
+        }
     }
 
-    int src = std::stoi(argv[2]);
-    int dest = std::stoi(argv[3]);
+    // ---------- route-path <src> <dest> [departMinute] ----------
+    // Output format: k v1 v2 ... vk   where k = path length
+    else if (cmd == "route-path") {
+        if (argc < 3) {
+            out << 0;
+            return out.str();
+        }
+
+        int src = std::stoi(args[1]);
+        int dest = std::stoi(args[2]);
 
-    std::vector<int> path = engine.computePath(src, dest);
+        // Optional departure minute: time-dependent route over the history
+        std::vector<int> path = argc >= 4 ? engine.computePath(src, dest, std::stoi(args[3]))
+                                          : engine.computePath(src, dest);
 
-    std::cout << path.size();
-    for (int v : path) {
-        std::cout << " " << v;
+        out << path.size();
+        for (int v : path) {
+            out << " " << v;
+        }
     }
-    std::cout << std::endl;
+
+    // ---------- route-stats <src> <dest> ----------
+    // Output format: dijkstra <settled> <cost> astar <settled> <cost> ch <settled> <cost>
+    else if (cmd == "route-stats") {
+        if (argc < 3) {
+            out << 0;
+            return out.str();
+        }
+
+        int src = std::stoi(args[1]);
+        int dest = std::stoi(args[2]);
+
+        SearchStats plain, astar, ch;
+        engine.computePath(src, dest, PathAlgorithm::Dijkstra, &plain);
+        engine.computePath(src, dest, PathAlgorithm::BidirectionalAStar, &astar);
+        engine.computePath(src, dest, PathAlgorithm::Hierarchy, &ch);
+
+        out << "dijkstra " << plain.settled << " " << plain.cost
+            << " astar " << astar.settled << " " << astar.cost
+            << " ch " << ch.settled << " " << ch.cost;
+    }
+
+    // ---------- matrix <s1,s2,...> <t1,t2,...> ----------
+    // Output format: rows cols d(s1,t1) d(s1,t2) ... (row-major)
+    else if (cmd == "matrix") {
+        if (argc < 3) {
+            out << 0 << " " << 0;
+            return out.str();
+        }
+
+        auto parseList = [](const std::string &csv) {
+            std::vector<int> ids;
+            std::stringstream ss(csv);
+            std::string token;
+            while (std::getline(ss, token, ',')) {
+                if (!token.empty()) ids.push_back(std::stoi(token));
+            }
+            return ids;
+        };
+        std::vector<int> sources = parseList(args[1]);
+        std::vector<int> targets = parseList(args[2]);
+
+        std::vector<double> matrix = engine.computeDistanceMatrix(sources, targets);
+
+        out << sources.size() << " " << targets.size();
+        for (double d : matrix) {
+            if (d == std::numeric_limits<double>::infinity()) {
+                out << " " << "inf";
+            } else {
+                out << " " << d;
+            }
+        }
+    }
+
+    // ---------- snapshot <path> / restore <path> ----------
+    // Saves / resumes the live state (congestion, emergency queue, traffic
+    // history, signals). Output: 1 on success, 0 (reason on stderr) if not
+    else if (cmd == "snapshot" || cmd == "restore") {
+        if (argc < 2) {
+            out << 0;
+            return out.str();
+        }
+        SimulationSnapshot state(&engine, &signals, nullptr, nullptr);
+        if (cmd == "snapshot") {
+            out << (state.snapshot(args[1]) ? 1 : 0);
+        } else {
+            bool ok = state.restore(args[1]);
+            // The wheel's due times belong to the old phases; the plans
+            // take over again from the current clock
+            if (ok) signalClock.start(signalClock.now());
+            out << (ok ? 1 : 0);
+        }
+    }
+
+    // ---------- cache-stats ----------
+    // Output format: hits H misses M evictions E entries N bytes B
+    else if (cmd == "cache-stats") {
+        RouteCacheStats stats = engine.routeCacheStats();
+        out << "hits " << stats.hits << " misses " << stats.misses
+            << " evictions " << stats.evictions << " entries " << stats.entries
+            << " bytes " << stats.bytes;
+    }
+    return out.str();
+}
+
+// Commands that change engine state; the daemon runs these exclusively
+static bool isMutatingCommand(const std::string &cmd) {
+    return cmd == "emergency-route" || cmd == "dispatch" || cmd == "unit-available" ||
+           cmd == "signal-status" || cmd == "restore";
 }
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        return 0;
+    }
+
+    std::string cmd = argv[1];
+    initEngine(cmd == "serve");
+
+    // ---------- serve [socketPath] ----------
+    // Keep the city loaded and answer framed requests (see EngineServer.h)
+    if (cmd == "serve") {
+        std::string socketPath = argc >= 3 ? argv[2] : "/tmp/citysense.sock";
+        EngineServer server(runCommand, isMutatingCommand);
+        return server.run(socketPath) ? 0 : 1;
+    }
+
+    std::vector<std::string> args(argv + 1, argv + argc);
+    std::string output = runCommand(args);
+    if (!output.empty()) std::cout << output << std::endl;
     return 0;
 }
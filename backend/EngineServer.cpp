@@ -0,0 +1,200 @@
+// ===================== EngineServer.cpp =====================
+#include "EngineServer.h"
+#include <iostream>
+#include <sstream>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+struct EngineServer::Connection {
+    int fd;
+    std::mutex writeLock;
+
+    explicit Connection(int f) : fd(f) {}
+    ~Connection() {
+#ifndef _WIN32
+        close(fd);
+#endif
+    }
+};
+
+EngineServer::EngineServer(Handler h,
+                           std::function<bool(const std::string &)> mutating,
+                           int workers)
+    : handler(std::move(h)), isMutating(std::move(mutating)) {
+    if (workers <= 0) {
+        workers = static_cast<int>(std::thread::hardware_concurrency());
+        if (workers < 2) workers = 2;
+    }
+    for (int i = 0; i < workers; ++i) {
+        workerThreads.emplace_back(&EngineServer::workerLoop, this);
+    }
+}
+
+EngineServer::~EngineServer() {
+    {
+        std::lock_guard<std::mutex> lk(jobsLock);
+        stopping = true;
+    }
+    jobsReady.notify_all();
+    for (auto &t : workerThreads) t.join();
+}
+
+// ---------------- REQUEST EXECUTION ----------------
+
+std::string EngineServer::execute(const std::string &payload) {
+    std::istringstream iss(payload);
+    std::string requestId;
+    iss >> requestId;
+
+    std::vector<std::string> args;
+    std::string token;
+    while (iss >> token) args.push_back(token);
+
+    if (requestId.empty() || args.empty()) {
+        return (requestId.empty() ? "0" : requestId) + " err empty request";
+    }
+
+    try {
+        std::string out;
+        if (isMutating(args[0])) {
+            std::unique_lock<std::shared_mutex> lk(engineLock);
+            out = handler(args);
+        } else {
+            std::shared_lock<std::shared_mutex> lk(engineLock);
+            out = handler(args);
+        }
+        return requestId + " ok " + out;
+    } catch (const std::exception &e) {
+        return requestId + " err " + e.what();
+    }
+}
+
+void EngineServer::workerLoop() {
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lk(jobsLock);
+            jobsReady.wait(lk, [&] { return stopping || !jobs.empty(); });
+            if (jobs.empty()) return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        std::string response = execute(job.payload);
+
+#ifndef _WIN32
+        // Frame header and body go out under one lock so concurrent
+        // responses on the same connection never interleave.
+        uint32_t len = static_cast<uint32_t>(response.size());
+        unsigned char header[4] = {
+            static_cast<unsigned char>(len >> 24), static_cast<unsigned char>(len >> 16),
+            static_cast<unsigned char>(len >> 8), static_cast<unsigned char>(len)};
+        std::string frame(reinterpret_cast<char *>(header), 4);
+        frame += response;
+
+        std::lock_guard<std::mutex> lk(job.conn->writeLock);
+        size_t sent = 0;
+        while (sent < frame.size()) {
+            ssize_t w = send(job.conn->fd, frame.data() + sent, frame.size() - sent, MSG_NOSIGNAL);
+            if (w < 0 && errno == EINTR) continue;
+            if (w <= 0) break; // client went away
+            sent += static_cast<size_t>(w);
+        }
+#endif
+    }
+}
+
+// ---------------- SOCKET HANDLING ----------------
+
+#ifndef _WIN32
+static bool readFully(int fd, char *buf, size_t len) {
+    size_t got = 0;
+    while (got < len) {
+        ssize_t r = recv(fd, buf + got, len - got, 0);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) return false;
+        got += static_cast<size_t>(r);
+    }
+    return true;
+}
+#endif
+
+void EngineServer::readLoop(std::shared_ptr<Connection> conn) {
+#ifndef _WIN32
+    for (;;) {
+        unsigned char header[4];
+        if (!readFully(conn->fd, reinterpret_cast<char *>(header), 4)) return;
+
+        uint32_t len = (uint32_t(header[0]) << 24) | (uint32_t(header[1]) << 16) |
+                       (uint32_t(header[2]) << 8) | uint32_t(header[3]);
+        if (len > kMaxFrame) {
+            std::cerr << "Dropping client: frame of " << len << " bytes\n";
+            return;
+        }
+
+        std::string payload(len, '\0');
+        if (len > 0 && !readFully(conn->fd, &payload[0], len)) return;
+
+        {
+            std::lock_guard<std::mutex> lk(jobsLock);
+            jobs.push_back({conn, std::move(payload)});
+        }
+        jobsReady.notify_one();
+    }
+#else
+    (void)conn;
+#endif
+}
+
+bool EngineServer::run(const std::string &socketPath) {
+#ifndef _WIN32
+    signal(SIGPIPE, SIG_IGN);
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "Socket path too long: " << socketPath << "\n";
+        return false;
+    }
+    std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+
+    int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        std::cerr << "socket() failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+
+    unlink(socketPath.c_str()); // stale socket from a previous run
+    if (bind(listenFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 ||
+        listen(listenFd, 64) < 0) {
+        std::cerr << "Failed to listen on " << socketPath << ": "
+                  << std::strerror(errno) << "\n";
+        close(listenFd);
+        return false;
+    }
+
+    std::cerr << "Engine serving on " << socketPath << "\n";
+    for (;;) {
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "accept() failed: " << std::strerror(errno) << "\n";
+            break;
+        }
+        auto conn = std::make_shared<Connection>(fd);
+        std::thread(&EngineServer::readLoop, this, conn).detach();
+    }
+    close(listenFd);
+    return false;
+#else
+    std::cerr << "serve mode needs Unix domain sockets: " << socketPath << "\n";
+    return false;
+#endif
+}
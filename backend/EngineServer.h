@@ -0,0 +1,65 @@
+// ===================== EngineServer.h =====================
+#ifndef ENGINE_SERVER_H
+#define ENGINE_SERVER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Long-running engine front end on a Unix domain socket.
+//
+// Every frame is a 4-byte big-endian payload length followed by the payload.
+//   request : "<requestId> <command> <args...>"
+//   response: "<requestId> ok <output>"  or  "<requestId> err <message>"
+//
+// A connection may keep many requests in flight; they are executed by a
+// fixed set of workers and answered as they complete, so responses can
+// arrive out of order and must be matched by requestId.
+class EngineServer {
+public:
+    // Runs one command (args[0] is the command name) and returns its output.
+    using Handler = std::function<std::string(const std::vector<std::string> &args)>;
+
+    // handler   - executes a command
+    // isMutating - commands that change engine state run exclusively;
+    //              everything else shares the engine between workers
+    EngineServer(Handler handler,
+                 std::function<bool(const std::string &cmd)> isMutating,
+                 int workers = 0);
+    ~EngineServer();
+
+    // Bind, listen and serve until the process is terminated.
+    // Returns false if the socket could not be set up.
+    bool run(const std::string &socketPath);
+
+    static constexpr unsigned kMaxFrame = 1u << 20;
+
+private:
+    struct Connection;
+    struct Job {
+        std::shared_ptr<Connection> conn;
+        std::string payload;
+    };
+
+    Handler handler;
+    std::function<bool(const std::string &)> isMutating;
+    std::shared_mutex engineLock;
+
+    std::mutex jobsLock;
+    std::condition_variable jobsReady;
+    std::deque<Job> jobs;
+    std::vector<std::thread> workerThreads;
+    bool stopping = false;
+
+    void workerLoop();
+    void readLoop(std::shared_ptr<Connection> conn);
+    std::string execute(const std::string &payload);
+};
+
+#endif
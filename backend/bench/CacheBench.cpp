@@ -0,0 +1,91 @@
+// ===================== CacheBench.cpp =====================
+// computeRoute() over a skewed stream of origins (a few depots issue most
+// requests) with the route cache disabled and enabled, plus the cost of a
+// congestion update that invalidates every cached tree.
+//
+//   CacheBench [side=200] [requests=400] [origins=40] [capMiB=64]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "CoreEngineService.h"
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+double replay(CoreEngineService &engine, const std::vector<int> &stream, double &checksum) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int src : stream) checksum += engine.computeRoute(src)[1];
+    return secondsSince(t0);
+}
+
+void report(const char *label, double sec, const RouteCacheStats &s) {
+    std::printf("%-22s: %7.3f s  hits %llu misses %llu evictions %llu entries %zu (%.1f MiB)\n",
+                label, sec, static_cast<unsigned long long>(s.hits),
+                static_cast<unsigned long long>(s.misses),
+                static_cast<unsigned long long>(s.evictions), s.entries,
+                s.bytes / (1024.0 * 1024.0));
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int side = argc > 1 ? std::atoi(argv[1]) : 200;
+    int requests = argc > 2 ? std::atoi(argv[2]) : 400;
+    int origins = argc > 3 ? std::atoi(argv[3]) : 40;
+    std::size_t capMiB = argc > 4 ? std::atoi(argv[4]) : 64;
+    int n = side * side;
+
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> len(1.0, 4.0);
+
+    CoreEngineService engine;
+    engine.reserveNodes(n);
+    for (int r = 0; r < side; ++r) {
+        for (int c = 0; c < side; ++c) {
+            int u = r * side + c + 1;
+            if (c + 1 < side) {
+                double w = len(rng);
+                engine.addRoad(u, u + 1, w);
+                engine.addRoad(u + 1, u, w);
+            }
+            if (r + 1 < side) {
+                double w = len(rng);
+                engine.addRoad(u, u + side, w);
+                engine.addRoad(u + side, u, w);
+            }
+        }
+    }
+    engine.freezeGraph();
+
+    // Origin k is drawn with weight 1 / (k + 1)
+    std::vector<int> depots(origins);
+    std::uniform_int_distribution<int> pick(1, n);
+    for (auto &d : depots) d = pick(rng);
+    std::vector<double> weights(origins);
+    for (int k = 0; k < origins; ++k) weights[k] = 1.0 / (k + 1);
+    std::discrete_distribution<int> skew(weights.begin(), weights.end());
+    std::vector<int> stream(requests);
+    for (auto &s : stream) s = depots[skew(rng)];
+
+    double checksum = 0.0;
+    engine.setRouteCacheLimit(0);
+    double offSec = replay(engine, stream, checksum);
+    report("cache off", offSec, engine.routeCacheStats());
+
+    engine.setRouteCacheLimit(capMiB << 20);
+    double onSec = replay(engine, stream, checksum);
+    report("cache on", onSec, engine.routeCacheStats());
+
+    engine.applyCongestionToEdge(1, 2, 1.5);
+    double staleSec = replay(engine, stream, checksum);
+    report("after congestion", staleSec, engine.routeCacheStats());
+
+    std::printf("graph: %d nodes, %d requests over %d origins, tree %.2f MiB (checksum %.1f)\n",
+                n, requests, origins, (n + 1) * 12.0 / (1024.0 * 1024.0), checksum);
+    return 0;
+}
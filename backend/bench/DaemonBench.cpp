@@ -0,0 +1,164 @@
+// ===================== DaemonBench.cpp =====================
+// Latency / throughput of `city serve` against one `city` process per call,
+// which is what api/server.js did for every HTTP request.
+//
+//   DaemonBench <path/to/city> [requests=200] [inflight=16]
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// One-shot call with stdout captured, like child_process.execFile
+std::string spawnOnce(const std::string &city, std::vector<std::string> args) {
+    int fds[2];
+    if (pipe(fds) != 0) return "";
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+    posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", 0, 0);
+    posix_spawn_file_actions_addclose(&actions, fds[0]);
+
+    args.insert(args.begin(), city);
+    std::vector<char *> argv;
+    for (auto &a : args) argv.push_back(&a[0]);
+    argv.push_back(nullptr);
+
+    pid_t pid;
+    posix_spawn(&pid, city.c_str(), &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(fds[1]);
+
+    std::string out;
+    char buf[4096];
+    ssize_t r;
+    while ((r = read(fds[0], buf, sizeof(buf))) > 0) out.append(buf, static_cast<size_t>(r));
+    close(fds[0]);
+    waitpid(pid, nullptr, 0);
+    return out;
+}
+
+void sendFrame(int fd, const std::string &payload) {
+    uint32_t len = static_cast<uint32_t>(payload.size());
+    unsigned char header[4] = {
+        static_cast<unsigned char>(len >> 24), static_cast<unsigned char>(len >> 16),
+        static_cast<unsigned char>(len >> 8), static_cast<unsigned char>(len)};
+    std::string frame(reinterpret_cast<char *>(header), 4);
+    frame += payload;
+    (void)!write(fd, frame.data(), frame.size());
+}
+
+std::string readFrame(int fd) {
+    unsigned char header[4];
+    size_t got = 0;
+    while (got < 4) {
+        ssize_t r = read(fd, header + got, 4 - got);
+        if (r <= 0) return "";
+        got += static_cast<size_t>(r);
+    }
+    uint32_t len = (uint32_t(header[0]) << 24) | (uint32_t(header[1]) << 16) |
+                   (uint32_t(header[2]) << 8) | uint32_t(header[3]);
+    std::string payload(len, '\0');
+    got = 0;
+    while (got < len) {
+        ssize_t r = read(fd, &payload[got], len - got);
+        if (r <= 0) return "";
+        got += static_cast<size_t>(r);
+    }
+    return payload;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: DaemonBench <path/to/city> [requests] [inflight]\n");
+        return 1;
+    }
+    std::string city = argv[1];
+    int requests = argc > 2 ? std::atoi(argv[2]) : 200;
+    int inflight = argc > 3 ? std::atoi(argv[3]) : 16;
+    std::string socketPath = "/tmp/citysense-bench-" + std::to_string(getpid()) + ".sock";
+
+    // ---- spawn per call ----
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < requests; ++i) spawnOnce(city, {"route", std::to_string(1 + i % 12)});
+    double spawnSec = secondsSince(t0);
+
+    // ---- daemon ----
+    std::vector<std::string> daemonArgs = {city, "serve", socketPath};
+    std::vector<char *> dargv;
+    for (auto &a : daemonArgs) dargv.push_back(&a[0]);
+    dargv.push_back(nullptr);
+    pid_t daemon;
+    posix_spawn(&daemon, city.c_str(), nullptr, nullptr, dargv.data(), environ);
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", socketPath.c_str());
+    int fd = -1;
+    for (int attempt = 0; attempt < 100 && fd < 0; ++attempt) {
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+            close(fd);
+            fd = -1;
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+    }
+    if (fd < 0) {
+        std::fprintf(stderr, "could not reach daemon on %s\n", socketPath.c_str());
+        kill(daemon, SIGTERM);
+        return 1;
+    }
+
+    // One request at a time: per-request latency
+    t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < requests; ++i) {
+        sendFrame(fd, std::to_string(i) + " route " + std::to_string(1 + i % 12));
+        readFrame(fd);
+    }
+    double serialSec = secondsSince(t0);
+
+    // `inflight` requests outstanding at all times: throughput
+    t0 = std::chrono::steady_clock::now();
+    int sent = 0, received = 0;
+    while (received < requests) {
+        while (sent < requests && sent - received < inflight) {
+            sendFrame(fd, std::to_string(sent) + " route " + std::to_string(1 + sent % 12));
+            ++sent;
+        }
+        if (readFrame(fd).empty()) break;
+        ++received;
+    }
+    double pipelinedSec = secondsSince(t0);
+
+    close(fd);
+    kill(daemon, SIGTERM);
+    waitpid(daemon, nullptr, 0);
+    unlink(socketPath.c_str());
+
+    std::printf("%d route requests\n", requests);
+    std::printf("spawn per call     : %8.3f ms/request  %9.0f req/s\n",
+                spawnSec * 1e3 / requests, requests / spawnSec);
+    std::printf("daemon, 1 in flight: %8.3f ms/request  %9.0f req/s\n",
+                serialSec * 1e3 / requests, requests / serialSec);
+    std::printf("daemon, %d in flight: %7.3f ms/request  %9.0f req/s\n",
+                inflight, pipelinedSec * 1e3 / requests, requests / pipelinedSec);
+    return 0;
+}
@@ -0,0 +1,161 @@
+// ===================== DispatchBench.cpp =====================
+// Burst dispatch: 10k queued incidents against a fleet of typed units.
+//   batched     - dispatchEmergencies(), one multi-source search per type
+//   per-request - one search per incident on the reverse graph, stopping
+//                 at the first free unit of the right type
+//   old         - one full dijkstra() per incident (processNextEmergency),
+//                 timed on a sample and scaled up
+//
+//   DispatchBench [side=300] [requests=10000] [units=12000]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+#include "CoreEngineService.h"
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+const char *TYPES[] = {"ambulance", "fire", "police"};
+
+struct Incident {
+    int node;
+    int type;
+};
+
+// Sequential greedy baseline: nearest free unit by a reverse search from
+// each incident in priority order
+double perRequest(const GraphManager &g, const std::vector<Incident> &incidents,
+                  std::vector<std::vector<int>> freeUnitsAt, const std::vector<int> &unitType,
+                  int &assigned) {
+    const CsrGraph &rev = g.reverseGraph();
+    const double INF = std::numeric_limits<double>::infinity();
+    std::vector<double> dist(g.nodeCount() + 1, INF);
+    std::vector<int> touched;
+    double total = 0.0;
+    assigned = 0;
+
+    using State = std::pair<double, int>;
+    for (const Incident &inc : incidents) {
+        std::priority_queue<State, std::vector<State>, std::greater<State>> pq;
+        dist[inc.node] = 0.0;
+        touched.push_back(inc.node);
+        pq.push({0.0, inc.node});
+        while (!pq.empty()) {
+            auto [d, u] = pq.top();
+            pq.pop();
+            if (d > dist[u]) continue;
+            bool found = false;
+            for (auto it = freeUnitsAt[u].begin(); it != freeUnitsAt[u].end(); ++it) {
+                if (unitType[*it] == inc.type) {
+                    freeUnitsAt[u].erase(it);
+                    total += d;
+                    ++assigned;
+                    found = true;
+                    break;
+                }
+            }
+            if (found) break;
+            for (uint32_t r = rev.begin(u); r < rev.end(u); ++r) {
+                uint32_t from = rev.targets[r];
+                double nd = d + g.edgeCost(static_cast<uint32_t>(rev.ids[r]));
+                if (nd < dist[from]) {
+                    if (dist[from] == INF) touched.push_back(static_cast<int>(from));
+                    dist[from] = nd;
+                    pq.push({nd, static_cast<int>(from)});
+                }
+            }
+        }
+        for (int v : touched) dist[v] = INF;
+        touched.clear();
+    }
+    return total;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int side = argc > 1 ? std::atoi(argv[1]) : 300;
+    int numRequests = argc > 2 ? std::atoi(argv[2]) : 10000;
+    int numUnits = argc > 3 ? std::atoi(argv[3]) : 12000;
+    int n = side * side;
+
+    std::mt19937 rng(31);
+    std::uniform_real_distribution<double> len(1.0, 4.0);
+    CoreEngineService engine;
+    GraphManager plain;
+    engine.reserveNodes(n);
+    plain.reserveNodes(n);
+    for (int r = 0; r < side; ++r) {
+        for (int c = 0; c < side; ++c) {
+            int u = r * side + c + 1;
+            auto both = [&](int a, int b) {
+                double w = len(rng);
+                engine.addRoad(a, b, w);
+                engine.addRoad(b, a, w);
+                plain.addEdge(a, b, w);
+                plain.addEdge(b, a, w);
+            };
+            if (c + 1 < side) both(u, u + 1);
+            if (r + 1 < side) both(u, u + side);
+        }
+    }
+    engine.freezeGraph();
+    plain.freeze();
+
+    // Fleet and incidents: half ambulance, a third fire, the rest police
+    std::uniform_int_distribution<int> pick(1, n);
+    std::discrete_distribution<int> kind({3, 2, 1});
+    std::vector<int> unitType(numUnits + 1);
+    std::vector<std::vector<int>> freeUnitsAt(n + 1);
+    for (int id = 1; id <= numUnits; ++id) {
+        int node = pick(rng);
+        unitType[id] = kind(rng);
+        engine.addResponderUnit(id, node, TYPES[unitType[id]]);
+        freeUnitsAt[node].push_back(id);
+    }
+    std::vector<Incident> incidents(numRequests);
+    for (auto &inc : incidents) inc = {pick(rng), kind(rng)};
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < numRequests; ++i) {
+        engine.addEmergencyRequest(i + 1, incidents[i].node, TYPES[incidents[i].type], i + 1.0);
+    }
+    std::vector<DispatchAssignment> plan = engine.dispatchEmergencies();
+    double batchSec = secondsSince(t0);
+    int batchAssigned = 0;
+    double batchCost = 0.0;
+    for (const auto &a : plan) {
+        if (a.unitId < 0) continue;
+        ++batchAssigned;
+        batchCost += a.cost;
+    }
+
+    int seqAssigned = 0;
+    t0 = std::chrono::steady_clock::now();
+    double seqCost = perRequest(plain, incidents, freeUnitsAt, unitType, seqAssigned);
+    double seqSec = secondsSince(t0);
+
+    int sample = std::min(numRequests, 100);
+    t0 = std::chrono::steady_clock::now();
+    double checksum = 0.0;
+    for (int i = 0; i < sample; ++i) checksum += plain.dijkstra(incidents[i].node)[1];
+    double oldSec = secondsSince(t0) * numRequests / sample;
+
+    std::printf("graph: %d nodes, %d units, burst of %d requests\n", n, numUnits, numRequests);
+    std::printf("batched dispatch     : %8.3f s  %9.0f requests/s  %d assigned, total cost %.1f\n",
+                batchSec, numRequests / batchSec, batchAssigned, batchCost);
+    std::printf("per-request search   : %8.3f s  %9.0f requests/s  %d assigned, total cost %.1f\n",
+                seqSec, numRequests / seqSec, seqAssigned, seqCost);
+    std::printf("old full dijkstra    : %8.3f s  %9.0f requests/s  (scaled from %d, checksum %.1f)\n",
+                oldSec, numRequests / oldSec, sample, checksum);
+    return 0;
+}
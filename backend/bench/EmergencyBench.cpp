@@ -0,0 +1,129 @@
+// ===================== EmergencyBench.cpp =====================
+// Emergency queue churn: push, cancel a share of the requests, raise the
+// priority of another share, then drain in batches. The baseline is a
+// std::priority_queue of string-typed requests where cancel/update can
+// only be done lazily (a tombstone set plus re-pushed copies).
+//
+//   EmergencyBench [requests=1000000] [changes=100000] [batch=1000]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <queue>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "EmergencyManager.h"
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+struct NamedRequest {
+    int id;
+    int sourceNode;
+    std::string type;
+    double priority;
+};
+
+struct Later {
+    bool operator()(const NamedRequest &a, const NamedRequest &b) const {
+        if (a.priority == b.priority) return a.id > b.id;
+        return a.priority > b.priority;
+    }
+};
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int requests = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int changes = argc > 2 ? std::atoi(argv[2]) : 100000;
+    std::size_t batch = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1000;
+
+    const char *types[] = {"ambulance", "fire", "police", "hazmat"};
+    std::mt19937 rng(13);
+    std::uniform_real_distribution<double> prio(1.0, 100.0);
+    std::uniform_int_distribution<int> node(1, 100000), kind(0, 3), who(1, requests);
+
+    std::vector<NamedRequest> input(requests);
+    for (int i = 0; i < requests; ++i) {
+        input[i] = {i + 1, node(rng), types[kind(rng)], prio(rng)};
+    }
+    std::vector<int> cancels(changes), raises(changes);
+    std::vector<double> raisedTo(changes);
+    for (int i = 0; i < changes; ++i) {
+        cancels[i] = who(rng);
+        raises[i] = who(rng);
+        raisedTo[i] = prio(rng) * 0.5;
+    }
+
+    // ---------------- BASELINE ----------------
+    auto t0 = std::chrono::steady_clock::now();
+    std::priority_queue<NamedRequest, std::vector<NamedRequest>, Later> pq;
+    std::unordered_set<int> cancelled;
+    std::unordered_map<int, double> current;       // id -> live priority
+    for (const auto &r : input) {
+        pq.push(r);
+        current[r.id] = r.priority;
+    }
+    for (int i = 0; i < changes; ++i) {
+        if (current.erase(cancels[i])) cancelled.insert(cancels[i]);
+        auto it = current.find(raises[i]);
+        if (it == current.end() || raisedTo[i] >= it->second) continue;
+        it->second = raisedTo[i];
+        NamedRequest copy = input[raises[i] - 1];
+        copy.priority = raisedTo[i];
+        pq.push(copy);
+    }
+    std::vector<NamedRequest> out;
+    uint64_t baseSum = 0;
+    std::size_t baseCount = 0;
+    while (!pq.empty()) {
+        out.clear();
+        while (!pq.empty() && out.size() < batch) {
+            NamedRequest r = pq.top();
+            pq.pop();
+            auto it = current.find(r.id);
+            if (it == current.end() || it->second != r.priority) continue;
+            current.erase(it);
+            out.push_back(std::move(r));
+        }
+        for (const auto &r : out) baseSum = baseSum * 31 + static_cast<uint64_t>(r.id);
+        baseCount += out.size();
+    }
+    double baseSec = secondsSince(t0);
+
+    // ---------------- INDEXED QUEUE ----------------
+    t0 = std::chrono::steady_clock::now();
+    EmergencyManager queue;
+    for (const auto &r : input) queue.addEmergency(r.id, r.sourceNode, r.type, r.priority);
+    std::vector<double> live(requests + 1);
+    for (const auto &r : input) live[r.id] = r.priority;
+    for (int i = 0; i < changes; ++i) {
+        queue.cancel(cancels[i]);
+        // Same rule as the baseline: only ever raise urgency
+        if (!queue.contains(raises[i]) || raisedTo[i] >= live[raises[i]]) continue;
+        live[raises[i]] = raisedTo[i];
+        queue.updatePriority(raises[i], raisedTo[i]);
+    }
+    std::vector<EmergencyRequest> drained;
+    uint64_t sum = 0;
+    std::size_t count = 0;
+    while (queue.hasEmergency()) {
+        drained.clear();
+        queue.drain(batch, drained);
+        for (const auto &r : drained) sum = sum * 31 + static_cast<uint64_t>(r.id);
+        count += drained.size();
+    }
+    double indexedSec = secondsSince(t0);
+
+    std::printf("%d requests, %d cancels, %d priority updates, batches of %zu\n",
+                requests, changes, changes, batch);
+    std::printf("priority_queue + tombstones : %8.3f s  (%zu served)\n", baseSec, baseCount);
+    std::printf("indexed 4-ary heap          : %8.3f s  (%zu served)\n", indexedSec, count);
+    std::printf("same order: %s\n", sum == baseSum && count == baseCount ? "yes" : "no");
+    return 0;
+}
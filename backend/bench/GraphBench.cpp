@@ -0,0 +1,132 @@
+// ===================== GraphBench.cpp =====================
+// Memory / throughput of the CSR road graph against the previous
+// vector<vector<Edge>> + dense adjMatrix layout on a synthetic grid city.
+//
+//   GraphBench [side=1000] [queries=5]
+//
+// side x side intersections, every neighbour pair joined by two one-way
+// roads of 1.0 - 4.0 km. Build with -DCMAKE_BUILD_TYPE=Release.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "GraphManager.h"
+
+namespace {
+
+// Layout GraphManager used before the CSR rewrite
+struct LegacyEdge {
+    int to;
+    double weight;
+    int id;
+};
+
+struct LegacyGraph {
+    std::vector<std::vector<LegacyEdge>> adj;
+    std::unordered_map<long long, double> congestion;
+
+    double getCongestion(int u, int v) const {
+        auto it = congestion.find((static_cast<long long>(u) << 32) |
+                                  static_cast<unsigned long long>(v));
+        return it == congestion.end() ? 1.0 : it->second;
+    }
+
+    std::vector<double> dijkstra(int src) const {
+        std::vector<double> dist(adj.size(), std::numeric_limits<double>::infinity());
+        using State = std::pair<double, int>;
+        std::priority_queue<State, std::vector<State>, std::greater<State>> pq;
+        dist[src] = 0.0;
+        pq.push({0.0, src});
+        while (!pq.empty()) {
+            auto [d, u] = pq.top();
+            pq.pop();
+            if (d > dist[u]) continue;
+            for (const auto &e : adj[u]) {
+                double wt = e.weight * getCongestion(u, e.to);
+                if (dist[e.to] > d + wt) {
+                    dist[e.to] = d + wt;
+                    pq.push({dist[e.to], e.to});
+                }
+            }
+        }
+        return dist;
+    }
+
+    std::size_t memoryBytes() const {
+        std::size_t bytes = adj.capacity() * sizeof(std::vector<LegacyEdge>);
+        for (const auto &row : adj) bytes += row.capacity() * sizeof(LegacyEdge);
+        return bytes;
+    }
+};
+
+double secondsSince(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int side = argc > 1 ? std::atoi(argv[1]) : 1000;
+    int queries = argc > 2 ? std::atoi(argv[2]) : 5;
+    int n = side * side;
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> len(1.0, 4.0);
+
+    GraphManager graph(n);
+    LegacyGraph legacy;
+    legacy.adj.assign(n + 1, {});
+
+    auto t0 = std::chrono::steady_clock::now();
+    int edgeId = 0;
+    auto road = [&](int a, int b) {
+        double w = static_cast<float>(len(rng));
+        graph.addEdge(a, b, w, edgeId);
+        graph.addEdge(b, a, w, edgeId + 1);
+        legacy.adj[a].push_back({b, w, edgeId});
+        legacy.adj[b].push_back({a, w, edgeId + 1});
+        edgeId += 2;
+    };
+    for (int r = 0; r < side; ++r) {
+        for (int c = 0; c < side; ++c) {
+            int u = r * side + c + 1;
+            if (c + 1 < side) road(u, u + 1);
+            if (r + 1 < side) road(u, u + side);
+        }
+    }
+    graph.freeze();
+    double buildSec = secondsSince(t0);
+
+    double matrixBytes = static_cast<double>(n + 1) * (n + 1) * sizeof(double);
+    std::printf("graph: %d nodes, %zu directed edges (build %.2fs)\n",
+                n, graph.edgeCount(), buildSec);
+    std::printf("memory  legacy adj lists : %10.1f MB\n", legacy.memoryBytes() / 1e6);
+    std::printf("memory  legacy adjMatrix : %10.1f MB (not allocated)\n", matrixBytes / 1e6);
+    std::printf("memory  CSR              : %10.1f MB\n", graph.memoryBytes() / 1e6);
+
+    std::uniform_int_distribution<int> pick(1, n);
+    std::vector<int> sources(queries);
+    for (auto &s : sources) s = pick(rng);
+
+    double checksum = 0.0;
+    t0 = std::chrono::steady_clock::now();
+    for (int s : sources) checksum += legacy.dijkstra(s)[n];
+    double legacySec = secondsSince(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    for (int s : sources) checksum -= graph.dijkstra(s)[n];
+    double csrSec = secondsSince(t0);
+
+    double edges = static_cast<double>(graph.edgeCount()) * queries;
+    std::printf("dijkstra legacy : %8.1f ms/query  %6.1f M edges/s\n",
+                legacySec * 1e3 / queries, edges / legacySec / 1e6);
+    std::printf("dijkstra CSR    : %8.1f ms/query  %6.1f M edges/s\n",
+                csrSec * 1e3 / queries, edges / csrSec / 1e6);
+    std::printf("checksum delta  : %g\n", checksum);
+    return 0;
+}
@@ -0,0 +1,125 @@
+// ===================== HierarchyBench.cpp =====================
+// Preprocessing, customization and query cost of the contraction
+// hierarchy against Dijkstra, before and after a congestion update.
+//
+//   HierarchyBench [side=200] [queries=500]
+//
+// Grid city with 1.0 - 4.0 km roads, a fifth of them one-way.
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <vector>
+#include "ContractionHierarchy.h"
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// Cost of walking a node path over the cheapest parallel road per hop
+double walk(const GraphManager &g, const std::vector<int> &path) {
+    const CsrGraph &csr = g.forwardGraph();
+    double total = 0.0;
+    for (std::size_t k = 1; k < path.size(); ++k) {
+        double hop = std::numeric_limits<double>::infinity();
+        for (uint32_t i = csr.begin(path[k - 1]); i < csr.end(path[k - 1]); ++i) {
+            if (csr.targets[i] == static_cast<uint32_t>(path[k])) hop = std::min(hop, g.edgeCost(i));
+        }
+        total += hop;
+    }
+    return total;
+}
+
+void compare(GraphManager &graph, const ContractionHierarchy &ch, int queries,
+             std::mt19937 &rng, const char *label) {
+    std::uniform_int_distribution<int> pick(1, graph.nodeCount());
+    double secPlain = 0.0, secCh = 0.0;
+    long long settledPlain = 0, settledCh = 0;
+    int bad = 0;
+    for (int q = 0; q < queries; ++q) {
+        int s = pick(rng), t = pick(rng);
+        SearchStats plain, hier;
+        auto t0 = std::chrono::steady_clock::now();
+        graph.shortestPath(s, t, PathAlgorithm::Dijkstra, &plain);
+        auto t1 = std::chrono::steady_clock::now();
+        std::vector<int> path = ch.shortestPath(s, t, &hier);
+        auto t2 = std::chrono::steady_clock::now();
+        secPlain += std::chrono::duration<double>(t1 - t0).count();
+        secCh += std::chrono::duration<double>(t2 - t1).count();
+        settledPlain += plain.settled;
+        settledCh += hier.settled;
+
+        double tol = 1e-9 * (1.0 + plain.cost);
+        bool ok = std::isinf(plain.cost) ? path.empty()
+                                         : std::fabs(plain.cost - hier.cost) < tol &&
+                                               path.front() == s && path.back() == t &&
+                                               std::fabs(walk(graph, path) - plain.cost) < 1e-6;
+        if (!ok) ++bad;
+    }
+    std::printf("[%s]\n", label);
+    std::printf("  dijkstra : %8.0f settled/query  %9.3f ms/query\n",
+                double(settledPlain) / queries, secPlain * 1e3 / queries);
+    std::printf("  CH       : %8.0f settled/query  %9.3f ms/query\n",
+                double(settledCh) / queries, secCh * 1e3 / queries);
+    std::printf("  wrong    : %d\n", bad);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int side = argc > 1 ? std::atoi(argv[1]) : 200;
+    int queries = argc > 2 ? std::atoi(argv[2]) : 500;
+    int n = side * side;
+
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> len(1.0, 4.0);
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+
+    GraphManager graph(n);
+    auto road = [&](int a, int b) {
+        double w = len(rng);
+        double r = coin(rng);
+        if (r < 0.9) graph.addEdge(a, b, w);
+        if (r > 0.1) graph.addEdge(b, a, w);
+    };
+    for (int r = 0; r < side; ++r) {
+        for (int c = 0; c < side; ++c) {
+            int u = r * side + c + 1;
+            if (c + 1 < side) road(u, u + 1);
+            if (r + 1 < side) road(u, u + side);
+        }
+    }
+    graph.freeze();
+
+    ContractionHierarchy ch;
+    auto t0 = std::chrono::steady_clock::now();
+    ch.build(graph);
+    double buildSec = secondsSince(t0);
+    t0 = std::chrono::steady_clock::now();
+    ch.customize(graph);
+    double customizeSec = secondsSince(t0);
+
+    std::printf("graph: %d nodes, %zu edges\n", n, graph.edgeCount());
+    std::printf("build %.3fs, customize %.3fs, %zu arcs, %.1f MB\n",
+                buildSec, customizeSec, ch.arcCount(), ch.memoryBytes() / 1e6);
+    compare(graph, ch, queries, rng, "free flow");
+
+    // Congest 1% of the roads and re-customize instead of rebuilding
+    const CsrGraph &csr = graph.forwardGraph();
+    std::uniform_int_distribution<int> pick(1, n);
+    std::uniform_real_distribution<double> jam(1.5, 4.0);
+    for (int k = 0; k < static_cast<int>(graph.edgeCount() / 100); ++k) {
+        int u = pick(rng);
+        if (csr.begin(u) == csr.end(u)) continue;
+        graph.setCongestion(u, csr.targets[csr.begin(u)], jam(rng));
+    }
+    t0 = std::chrono::steady_clock::now();
+    ch.customize(graph);
+    std::printf("re-customize after congestion: %.3fs\n", secondsSince(t0));
+    compare(graph, ch, queries, rng, "congested");
+    return 0;
+}
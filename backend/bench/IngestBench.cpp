@@ -0,0 +1,136 @@
+// ===================== IngestBench.cpp =====================
+// Text edge-file ingest throughput: getline + istringstream per line (the
+// old loadGraph loop) against LineReader + FieldCursor, parse only, on a
+// generated "u v w id" file. The file is written first, so both passes
+// read it from a warm page cache.
+//
+//   IngestBench [megabytes=2048] [path=/tmp/citysense_edges.txt] [keep=0]
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "LineReader.h"
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+struct Totals {
+    uint64_t edges = 0;
+    uint64_t idSum = 0;
+    double weightSum = 0.0;
+};
+
+uint64_t generate(const std::string &path, uint64_t bytes) {
+    std::FILE *out = std::fopen(path.c_str(), "wb");
+    if (!out) return 0;
+    std::mt19937 rng(23);
+    std::uniform_int_distribution<int> node(1, 5000000);
+    std::uniform_int_distribution<int> metres(100, 4000);
+    std::vector<char> buf(1 << 20);
+    uint64_t written = 0;
+    int id = 0;
+    while (written < bytes) {
+        std::size_t used = 0;
+        while (used + 64 < buf.size()) {
+            char *p = buf.data() + used;
+            char *end = buf.data() + buf.size();
+            p = std::to_chars(p, end, node(rng)).ptr;
+            *p++ = ' ';
+            p = std::to_chars(p, end, node(rng)).ptr;
+            *p++ = ' ';
+            int m = metres(rng);               // km with three decimals
+            p = std::to_chars(p, end, m / 1000).ptr;
+            *p++ = '.';
+            *p++ = static_cast<char>('0' + m / 100 % 10);
+            *p++ = static_cast<char>('0' + m / 10 % 10);
+            *p++ = static_cast<char>('0' + m % 10);
+            *p++ = ' ';
+            p = std::to_chars(p, end, ++id).ptr;
+            *p++ = '\n';
+            used = static_cast<std::size_t>(p - buf.data());
+        }
+        std::fwrite(buf.data(), 1, used, out);
+        written += used;
+    }
+    std::fclose(out);
+    return written;
+}
+
+Totals parseStream(const std::string &path) {
+    Totals t;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        std::istringstream iss(line);
+        int u, v, id = 0;
+        double w;
+        if (!(iss >> u >> v >> w)) continue;
+        if (!(iss >> id)) id = 0;
+        ++t.edges;
+        t.idSum += id;
+        t.weightSum += w;
+    }
+    return t;
+}
+
+Totals parseFromChars(const std::string &path) {
+    Totals t;
+    LineReader in(path);
+    std::string_view line;
+    while (in.next(line)) {
+        FieldCursor f(line);
+        int u, v, id = 0;
+        double w;
+        if (!f.nextInt(u) || !f.nextInt(v) || !f.nextDouble(w)) continue;
+        if (!f.atEnd() && !f.nextInt(id)) continue;
+        ++t.edges;
+        t.idSum += id;
+        t.weightSum += w;
+    }
+    return t;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    uint64_t megabytes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2048;
+    std::string path = argc > 2 ? argv[2] : "/tmp/citysense_edges.txt";
+    bool keep = argc > 3 && std::atoi(argv[3]) != 0;
+
+    auto t0 = std::chrono::steady_clock::now();
+    uint64_t bytes = generate(path, megabytes << 20);
+    if (bytes == 0) {
+        std::fprintf(stderr, "cannot write %s\n", path.c_str());
+        return 1;
+    }
+    double genSec = secondsSince(t0);
+    double mb = bytes / (1024.0 * 1024.0);
+
+    t0 = std::chrono::steady_clock::now();
+    Totals fast = parseFromChars(path);
+    double fastSec = secondsSince(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    Totals slow = parseStream(path);
+    double slowSec = secondsSince(t0);
+
+    bool same = fast.edges == slow.edges && fast.idSum == slow.idSum &&
+                fast.weightSum == slow.weightSum;
+    std::printf("file: %.0f MB, %llu edges (generated in %.1f s)\n", mb,
+                static_cast<unsigned long long>(fast.edges), genSec);
+    std::printf("getline + istringstream : %7.2f s  %7.1f MB/s\n", slowSec, mb / slowSec);
+    std::printf("LineReader + from_chars : %7.2f s  %7.1f MB/s\n", fastSec, mb / fastSec);
+    std::printf("same totals: %s\n", same ? "yes" : "NO");
+
+    if (!keep) std::remove(path.c_str());
+    return 0;
+}
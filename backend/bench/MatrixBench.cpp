@@ -0,0 +1,92 @@
+// ===================== MatrixBench.cpp =====================
+// Many-to-many travel-cost matrix: computeRoute() per source (full SSSP,
+// fresh dist vector each time) against computeDistanceMatrix().
+//
+//   MatrixBench [side=300] [sources=200] [targets=2000] [threads=0]
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include "CoreEngineService.h"
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int side = argc > 1 ? std::atoi(argv[1]) : 300;
+    int numSources = argc > 2 ? std::atoi(argv[2]) : 200;
+    int numTargets = argc > 3 ? std::atoi(argv[3]) : 2000;
+    int threads = argc > 4 ? std::atoi(argv[4]) : 0;
+    int n = side * side;
+
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> len(1.0, 4.0);
+
+    CoreEngineService engine;
+    engine.reserveNodes(n);
+    for (int r = 0; r < side; ++r) {
+        for (int c = 0; c < side; ++c) {
+            int u = r * side + c + 1;
+            if (c + 1 < side) {
+                double w = len(rng);
+                engine.addRoad(u, u + 1, w);
+                engine.addRoad(u + 1, u, w);
+            }
+            if (r + 1 < side) {
+                double w = len(rng);
+                engine.addRoad(u, u + side, w);
+                engine.addRoad(u + side, u, w);
+            }
+        }
+    }
+    engine.freezeGraph();
+
+    // Dispatch-like: sources clustered in one district, targets city-wide
+    std::uniform_int_distribution<int> pick(1, n);
+    std::uniform_int_distribution<int> district(0, side / 5);
+    std::vector<int> sources(numSources), targets(numTargets);
+    for (auto &s : sources) s = district(rng) * side + district(rng) + 1;
+    for (auto &t : targets) t = pick(rng);
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<double> loop(sources.size() * targets.size());
+    for (std::size_t i = 0; i < sources.size(); ++i) {
+        std::vector<double> dist = engine.computeRoute(sources[i]);
+        for (std::size_t j = 0; j < targets.size(); ++j) {
+            loop[i * targets.size() + j] = dist[targets[j]];
+        }
+    }
+    double loopSec = secondsSince(t0);
+
+    engine.setWorkerThreads(1);
+    t0 = std::chrono::steady_clock::now();
+    std::vector<double> single = engine.computeDistanceMatrix(sources, targets);
+    double singleSec = secondsSince(t0);
+
+    engine.setWorkerThreads(threads);
+    engine.computeDistanceMatrix(sources, {targets[0]}); // spin up the pool
+    t0 = std::chrono::steady_clock::now();
+    std::vector<double> parallel = engine.computeDistanceMatrix(sources, targets);
+    double parallelSec = secondsSince(t0);
+
+    int mismatches = 0;
+    for (std::size_t k = 0; k < loop.size(); ++k) {
+        if (loop[k] != single[k] || loop[k] != parallel[k]) ++mismatches;
+    }
+
+    unsigned hw = std::thread::hardware_concurrency();
+    std::printf("graph: %d nodes, matrix %d x %d\n", n, numSources, numTargets);
+    std::printf("computeRoute loop           : %8.3f s\n", loopSec);
+    std::printf("distance matrix, 1 thread   : %8.3f s\n", singleSec);
+    std::printf("distance matrix, %2d threads : %8.3f s  (%u hardware threads)\n",
+                threads > 0 ? threads : static_cast<int>(hw), parallelSec, hw);
+    std::printf("mismatches: %d\n", mismatches);
+    return 0;
+}
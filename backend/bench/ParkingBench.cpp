@@ -0,0 +1,280 @@
+// ===================== ParkingBench.cpp =====================
+// Filling parking zones one arrival at a time (find the first free spot,
+// assign it) and listing the free spots of nearly full zones: the old
+// string-keyed manager (copied here) against ParkingManager. Then
+// k-nearest free spots by road cost on a grid city, early-terminating
+// search against a full Dijkstra plus a scan of every spot, and a batch
+// of arrivals assigned without double booking. Last, advance bookings in
+// one busy zone: availability and earliest-free queries from the zone
+// timeline against checking every spot's bookings, then undo of all of it.
+//
+//   ParkingBench [zones=20] [spotsPerZone=2000] [listQueries=20000] [side=200]
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "CoreEngineService.h"
+#include "ParkingManager.h"
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// The previous layout: spotID -> spot, zone -> list of spotIDs
+class StringParking {
+private:
+    std::unordered_map<std::string, ParkingSpot> spots;
+    std::unordered_map<int, std::vector<std::string>> zoneMap;
+
+public:
+    void addSpot(const std::string &id, int zone) {
+        spots[id] = {id, zone, false, -1};
+        zoneMap[zone].push_back(id);
+    }
+    bool assignSpot(const std::string &id, int vehicle) {
+        auto it = spots.find(id);
+        if (it == spots.end() || it->second.occupied) return false;
+        it->second.occupied = true;
+        it->second.vehicleID = vehicle;
+        return true;
+    }
+    std::string findNearestFreeSpot(int zone) const {
+        auto it = zoneMap.find(zone);
+        if (it == zoneMap.end()) return "";
+        for (const auto &id : it->second) {
+            if (!spots.find(id)->second.occupied) return id;
+        }
+        return "";
+    }
+    std::vector<std::string> getFreeSpotsInZone(int zone) const {
+        std::vector<std::string> out;
+        for (const auto &id : zoneMap.find(zone)->second) {
+            if (!spots.find(id)->second.occupied) out.push_back(id);
+        }
+        return out;
+    }
+};
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int zones = argc > 1 ? std::atoi(argv[1]) : 20;
+    int perZone = argc > 2 ? std::atoi(argv[2]) : 2000;
+    int listQueries = argc > 3 ? std::atoi(argv[3]) : 20000;
+    int side = argc > 4 ? std::atoi(argv[4]) : 200;
+
+    std::mt19937 rng(17);
+    std::vector<int> arrivals;
+    for (int z = 1; z <= zones; ++z) {
+        for (int k = 0; k < perZone - 5; ++k) arrivals.push_back(z);  // leave 5 free
+    }
+    std::shuffle(arrivals.begin(), arrivals.end(), rng);
+    std::uniform_int_distribution<int> zonePick(1, zones);
+    std::vector<int> listZones(listQueries);
+    for (auto &z : listZones) z = zonePick(rng);
+
+    StringParking before;
+    ParkingManager after;
+    for (int z = 1; z <= zones; ++z) {
+        for (int k = 0; k < perZone; ++k) {
+            std::string id = "Z" + std::to_string(z) + "-" + std::to_string(k);
+            before.addSpot(id, z);
+            after.addSpot(id, z);
+        }
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::size_t checkBefore = 0;
+    for (std::size_t v = 0; v < arrivals.size(); ++v) {
+        std::string id = before.findNearestFreeSpot(arrivals[v]);
+        checkBefore += before.assignSpot(id, static_cast<int>(v)) ? std::hash<std::string>()(id) : 0;
+    }
+    double fillBefore = secondsSince(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    std::size_t checkAfter = 0;
+    for (std::size_t v = 0; v < arrivals.size(); ++v) {
+        int spot = after.findFreeSpot(arrivals[v]);
+        checkAfter += after.assignSpot(static_cast<uint32_t>(spot), static_cast<int>(v))
+                          ? std::hash<std::string>()(after.spotName(static_cast<uint32_t>(spot))) : 0;
+    }
+    double fillAfter = secondsSince(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    std::size_t listedBefore = 0;
+    for (int z : listZones) listedBefore += before.getFreeSpotsInZone(z).size();
+    double listBefore = secondsSince(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    std::size_t listedAfter = 0;
+    for (int z : listZones) listedAfter += after.getFreeSpotsInZone(z).size();
+    double listAfter = secondsSince(t0);
+
+    std::printf("%d zones x %d spots, %zu arrivals, %d free-list queries\n",
+                zones, perZone, arrivals.size(), listQueries);
+    std::printf("string-keyed : fill %8.3f s  list %8.3f s\n", fillBefore, listBefore);
+    std::printf("bitsets      : fill %8.3f s  list %8.3f s\n", fillAfter, listAfter);
+    std::printf("same assignments: %s\n",
+                checkBefore == checkAfter && listedBefore == listedAfter ? "yes" : "no");
+
+    // ---------------- NEAREST BY ROAD COST ----------------
+    int n = side * side;
+    std::uniform_real_distribution<double> len(1.0, 4.0);
+    CoreEngineService engine;
+    engine.reserveNodes(n);
+    for (int r = 0; r < side; ++r) {
+        for (int c = 0; c < side; ++c) {
+            int u = r * side + c + 1;
+            if (c + 1 < side) {
+                double w = len(rng);
+                engine.addRoad(u, u + 1, w);
+                engine.addRoad(u + 1, u, w);
+            }
+            if (r + 1 < side) {
+                double w = len(rng);
+                engine.addRoad(u, u + side, w);
+                engine.addRoad(u + side, u, w);
+            }
+        }
+    }
+    engine.freezeGraph();
+    const GraphManager &graph = engine.roadGraph();
+
+    // Lots of 4 spots on 2% of the nodes, 90% of the spots taken
+    ParkingManager city;
+    std::uniform_int_distribution<int> nodePick(1, n), pct(0, 99);
+    for (int lot = 0; lot < n / 50; ++lot) {
+        int node = nodePick(rng);
+        for (int k = 0; k < 4; ++k) {
+            uint32_t spot = city.addSpot("L" + std::to_string(lot) + "-" + std::to_string(k),
+                                         lot % zones + 1, node);
+            if (pct(rng) < 90) city.assignSpot(spot, 1000000 + lot);
+        }
+    }
+
+    const int K = 5, lookups = 200;
+    std::vector<int> from(lookups);
+    for (auto &f : from) f = nodePick(rng);
+
+    t0 = std::chrono::steady_clock::now();
+    double scanCost = 0;
+    for (int f : from) {
+        std::vector<double> dist = graph.dijkstra(f);
+        std::vector<double> costs;
+        for (uint32_t s = 0; s < city.spotCount(); ++s) {
+            if (!city.isOccupied(s)) costs.push_back(dist[city.spotNodeOf(s)]);
+        }
+        std::partial_sort(costs.begin(), costs.begin() + std::min<std::size_t>(K, costs.size()),
+                          costs.end());
+        for (int k = 0; k < K && k < static_cast<int>(costs.size()); ++k) scanCost += costs[k];
+    }
+    double scanSec = secondsSince(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    double nearCost = 0;
+    for (int f : from) {
+        for (const ParkingMatch &m : city.findNearestFreeSpots(graph, f, K)) nearCost += m.cost;
+    }
+    double nearSec = secondsSince(t0);
+
+    std::vector<int> arriving(2000), vehicleIds(2000);
+    for (std::size_t i = 0; i < arriving.size(); ++i) {
+        arriving[i] = nodePick(rng);
+        vehicleIds[i] = static_cast<int>(i);
+    }
+    t0 = std::chrono::steady_clock::now();
+    std::vector<ParkingMatch> plan = city.assignNearestSpots(graph, arriving, vehicleIds);
+    double batchSec = secondsSince(t0);
+    std::vector<char> taken(city.spotCount(), 0);
+    std::size_t parked = 0, doubled = 0;
+    for (const ParkingMatch &m : plan) {
+        if (m.spot < 0) continue;
+        ++parked;
+        if (taken[m.spot]++) ++doubled;
+    }
+
+    std::printf("grid %d nodes, %zu spots, %d lookups of %d nearest\n",
+                n, city.spotCount(), lookups, K);
+    std::printf("full Dijkstra + scan : %8.3f s\n", scanSec);
+    std::printf("bounded expansion    : %8.3f s\n", nearSec);
+    std::printf("same costs: %s\n", std::abs(scanCost - nearCost) < 1e-6 * scanCost ? "yes" : "no");
+    std::printf("batch of %zu arrivals: %8.3f s, %zu parked, %zu double-booked\n",
+                arriving.size(), batchSec, parked, doubled);
+
+    // ---------------- RESERVATIONS ----------------
+    ParkingManager lot;
+    const int lotSpots = perZone, week = 7 * 1440;
+    for (int k = 0; k < lotSpots; ++k) lot.addSpot("R" + std::to_string(k), 1);
+    // Two busy days, booked until most requests are turned away
+    std::uniform_int_distribution<int> when(0, 2 * 1440), stay(30, 240);
+    int booked = 0;
+    for (int r = 0; r < lotSpots * 40; ++r) {
+        int start = when(rng);
+        if (lot.reserveInZone(1, start, start + stay(rng), r) >= 0) ++booked;
+    }
+
+    struct Ask { int start, length; };
+    std::vector<Ask> asks(listQueries);
+    for (auto &a : asks) a = {when(rng), stay(rng)};
+
+    t0 = std::chrono::steady_clock::now();
+    std::size_t scanHits = 0;
+    int64_t scanEarliest = 0;
+    for (const Ask &a : asks) {
+        bool any = false;
+        for (uint32_t s = 0; s < static_cast<uint32_t>(lotSpots) && !any; ++s) {
+            any = !lot.isReserved(s, a.start, a.start + a.length);
+        }
+        scanHits += any;
+        // Earliest: step through candidate minutes until some spot is free
+        int64_t t = a.start;
+        for (; t + a.length <= week; ++t) {
+            bool free = false;
+            for (uint32_t s = 0; s < static_cast<uint32_t>(lotSpots) && !free; ++s) {
+                free = !lot.isReserved(s, t, t + a.length);
+            }
+            if (free) break;
+        }
+        scanEarliest += t + a.length <= week ? t : -1;
+        if (&a - asks.data() == 200) break;    // the scan is slow; sample it
+    }
+    double resScanSec = secondsSince(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    std::size_t hits = 0;
+    int64_t earliest = 0;
+    for (const Ask &a : asks) {
+        hits += lot.zoneAvailable(1, a.start, a.start + a.length);
+        earliest += lot.earliestFreeSlot(1, a.start, a.length);
+        if (&a - asks.data() == 200) break;
+    }
+    double resSampleSec = secondsSince(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    std::size_t allHits = 0;
+    for (const Ask &a : asks) {
+        allHits += lot.zoneAvailable(1, a.start, a.start + a.length);
+        allHits += lot.earliestFreeSlot(1, a.start, a.length) >= 0;
+    }
+    double resAllSec = secondsSince(t0);
+
+    for (int k = 0; k < booked; ++k) lot.undoLastChange();
+    std::size_t left = 0;
+    for (uint32_t s = 0; s < static_cast<uint32_t>(lotSpots); ++s) left += lot.isReserved(s, 0, week);
+
+    std::printf("zone of %d spots, %d bookings over two days\n", lotSpots, booked);
+    std::printf("per-spot scan, 201 queries : %8.3f s\n", resScanSec);
+    std::printf("zone timeline, 201 queries : %8.4f s  (%zu queries: %.4f s)\n",
+                resSampleSec, asks.size(), resAllSec);
+    std::printf("same answers: %s, bookings left after undo: %zu\n",
+                scanHits == hits && scanEarliest == earliest ? "yes" : "no", left);
+    return 0;
+}
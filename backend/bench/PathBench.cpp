@@ -0,0 +1,78 @@
+// ===================== PathBench.cpp =====================
+// Settled nodes and query time of point-to-point Dijkstra against
+// bidirectional A* on a synthetic grid city with coordinates.
+//
+//   PathBench [side=300] [queries=200]
+//
+// Intersections sit ~150 m apart; each road costs its length times a
+// 1.0 - 1.6 detour factor and 10% of roads carry congestion 1 - 3x.
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include "GraphManager.h"
+
+int main(int argc, char **argv) {
+    int side = argc > 1 ? std::atoi(argv[1]) : 300;
+    int queries = argc > 2 ? std::atoi(argv[2]) : 200;
+    int n = side * side;
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> detour(1.0, 1.6);
+    std::uniform_real_distribution<double> jam(1.0, 3.0);
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+
+    const double step = 0.00135; // degrees, ~150 m
+    GraphManager graph(n);
+    for (int r = 0; r < side; ++r) {
+        for (int c = 0; c < side; ++c) {
+            graph.setNodeLocation(r * side + c + 1, 28.5 + r * step, 77.2 + c * step);
+        }
+    }
+    auto road = [&](int a, int b) {
+        double w = 0.15 * detour(rng);
+        graph.addEdge(a, b, w);
+        graph.addEdge(b, a, w);
+        if (coin(rng) < 0.1) graph.setCongestion(a, b, jam(rng));
+    };
+    for (int r = 0; r < side; ++r) {
+        for (int c = 0; c < side; ++c) {
+            int u = r * side + c + 1;
+            if (c + 1 < side) road(u, u + 1);
+            if (r + 1 < side) road(u, u + side);
+        }
+    }
+    graph.freeze();
+
+    std::uniform_int_distribution<int> pick(1, n);
+    long long settledPlain = 0, settledAStar = 0;
+    double secPlain = 0.0, secAStar = 0.0;
+    int mismatches = 0;
+
+    for (int q = 0; q < queries; ++q) {
+        int s = pick(rng), t = pick(rng);
+        SearchStats plain, astar;
+
+        auto t0 = std::chrono::steady_clock::now();
+        graph.shortestPath(s, t, PathAlgorithm::Dijkstra, &plain);
+        auto t1 = std::chrono::steady_clock::now();
+        graph.shortestPath(s, t, PathAlgorithm::BidirectionalAStar, &astar);
+        auto t2 = std::chrono::steady_clock::now();
+
+        secPlain += std::chrono::duration<double>(t1 - t0).count();
+        secAStar += std::chrono::duration<double>(t2 - t1).count();
+        settledPlain += plain.settled;
+        settledAStar += astar.settled;
+        if (std::fabs(plain.cost - astar.cost) > 1e-9 * (1.0 + plain.cost)) ++mismatches;
+    }
+
+    std::printf("graph: %d nodes, %zu edges, %d random queries\n",
+                n, graph.edgeCount(), queries);
+    std::printf("dijkstra         : %9.0f settled/query  %8.3f ms/query\n",
+                double(settledPlain) / queries, secPlain * 1e3 / queries);
+    std::printf("bidirectional A* : %9.0f settled/query  %8.3f ms/query\n",
+                double(settledAStar) / queries, secAStar * 1e3 / queries);
+    std::printf("cost mismatches  : %d\n", mismatches);
+    return 0;
+}
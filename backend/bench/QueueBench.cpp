@@ -0,0 +1,100 @@
+// ===================== QueueBench.cpp =====================
+// Full single-source Dijkstra with each QueueKind on two graphs:
+//   grid  - side x side, two-way roads of 1.0 - 4.0 km
+//   city  - the same grid with a quarter of the roads missing, 0.2 - 4.0 km
+//           roads and fast arterials every tenth row/column, some one-way
+// Distances are checked against the binary heap.
+//
+//   QueueBench [side=300] [sources=30]
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "GraphManager.h"
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+void buildGrid(GraphManager &g, int side, bool cityLike, std::mt19937 &rng) {
+    std::uniform_real_distribution<double> gridLen(1.0, 4.0);
+    std::uniform_real_distribution<double> cityLen(0.2, 4.0);
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    g.reserveNodes(side * side);
+
+    auto road = [&](int u, int v, bool arterial) {
+        if (!cityLike) {
+            double w = gridLen(rng);
+            g.addEdge(u, v, w);
+            g.addEdge(v, u, w);
+            return;
+        }
+        if (!arterial && coin(rng) < 0.25) return;
+        double w = cityLen(rng) * (arterial ? 0.4 : 1.0);
+        g.addEdge(u, v, w);
+        if (arterial || coin(rng) > 0.1) g.addEdge(v, u, w);
+    };
+
+    for (int r = 0; r < side; ++r) {
+        for (int c = 0; c < side; ++c) {
+            int u = r * side + c + 1;
+            if (c + 1 < side) road(u, u + 1, r % 10 == 0);
+            if (r + 1 < side) road(u, u + side, c % 10 == 0);
+        }
+    }
+    g.freeze();
+}
+
+void run(const char *label, GraphManager &g, int sources, std::mt19937 &rng) {
+    const QueueKind kinds[] = {QueueKind::BinaryHeap, QueueKind::RadixHeap,
+                               QueueKind::Dial, QueueKind::QuaternaryHeap};
+    const char *names[] = {"binary heap", "radix heap", "dial", "4-ary indexed"};
+
+    std::uniform_int_distribution<int> pick(1, g.nodeCount());
+    std::vector<int> src(sources);
+    for (auto &s : src) s = pick(rng);
+
+    std::vector<std::vector<double>> reference;
+    std::printf("%s: %d nodes, %zu edges\n", label, g.nodeCount(), g.edgeCount());
+    for (int k = 0; k < 4; ++k) {
+        g.setQueueKind(kinds[k]);
+        double maxDiff = 0.0;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < sources; ++i) {
+            std::vector<double> dist = g.dijkstra(src[i]);
+            if (k == 0) {
+                reference.push_back(std::move(dist));
+                continue;
+            }
+            for (std::size_t v = 0; v < dist.size(); ++v) {
+                if (dist[v] != reference[i][v]) {
+                    maxDiff = std::max(maxDiff, std::fabs(dist[v] - reference[i][v]));
+                }
+            }
+        }
+        double sec = secondsSince(t0);
+        std::printf("  %-14s: %7.2f ms/search   max |diff| %g\n", names[k],
+                    1000.0 * sec / sources, maxDiff);
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int side = argc > 1 ? std::atoi(argv[1]) : 300;
+    int sources = argc > 2 ? std::atoi(argv[2]) : 30;
+    std::mt19937 rng(17);
+
+    GraphManager grid;
+    buildGrid(grid, side, false, rng);
+    run("grid", grid, sources, rng);
+
+    GraphManager city;
+    buildGrid(city, side, true, rng);
+    run("city", city, sources, rng);
+    return 0;
+}
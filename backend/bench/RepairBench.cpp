@@ -0,0 +1,104 @@
+// ===================== RepairBench.cpp =====================
+// Congestion updates with watched sources: incremental repair of their
+// shortest-path trees (applyCongestionToEdge) against recomputing every
+// watched tree from scratch after each update. Repaired distances are
+// checked against a fresh Dijkstra at the end.
+//
+//   RepairBench [side=300] [depots=8] [updates=200]
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "CoreEngineService.h"
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int side = argc > 1 ? std::atoi(argv[1]) : 300;
+    int depots = argc > 2 ? std::atoi(argv[2]) : 8;
+    int updates = argc > 3 ? std::atoi(argv[3]) : 200;
+    int n = side * side;
+
+    std::mt19937 rng(29);
+    std::uniform_real_distribution<double> len(1.0, 4.0);
+
+    CoreEngineService engine;
+    GraphManager plain;              // same roads, recomputed from scratch
+    engine.reserveNodes(n);
+    plain.reserveNodes(n);
+    std::vector<std::pair<int, int>> roads;
+    auto addUndirected = [&](int a, int b) {
+        double w = len(rng);
+        engine.addRoad(a, b, w);
+        engine.addRoad(b, a, w);
+        plain.addEdge(a, b, w);
+        plain.addEdge(b, a, w);
+        roads.push_back({a, b});
+        roads.push_back({b, a});
+    };
+    for (int r = 0; r < side; ++r) {
+        for (int c = 0; c < side; ++c) {
+            int u = r * side + c + 1;
+            if (c + 1 < side) addUndirected(u, u + 1);
+            if (r + 1 < side) addUndirected(u, u + side);
+        }
+    }
+    engine.freezeGraph();
+    plain.freeze();
+
+    std::uniform_int_distribution<int> pick(1, n);
+    std::vector<int> sources(depots);
+    for (auto &s : sources) {
+        s = pick(rng);
+        engine.watchSource(s);
+    }
+
+    // Jams come and go: multipliers between 0.7 (cleared) and 3.0
+    std::uniform_int_distribution<std::size_t> road(0, roads.size() - 1);
+    std::uniform_real_distribution<double> jam(0.7, 3.0);
+    std::vector<std::pair<std::pair<int, int>, double>> stream(updates);
+    for (auto &u : stream) u = {roads[road(rng)], jam(rng)};
+
+    std::size_t work = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (const auto &u : stream) {
+        engine.applyCongestionToEdge(u.first.first, u.first.second, u.second);
+        work += engine.lastRepairWork();
+    }
+    double repairSec = secondsSince(t0);
+
+    double checksum = 0.0;
+    t0 = std::chrono::steady_clock::now();
+    for (const auto &u : stream) {
+        plain.setCongestion(u.first.first, u.first.second, u.second);
+        for (int s : sources) checksum += plain.dijkstra(s)[1];
+    }
+    double fullSec = secondsSince(t0);
+
+    double maxDiff = 0.0;
+    for (int s : sources) {
+        std::vector<double> repaired = engine.computeRoute(s);
+        std::vector<double> fresh = plain.dijkstra(s);
+        for (std::size_t v = 0; v < fresh.size(); ++v) {
+            if (repaired[v] != fresh[v]) maxDiff = std::max(maxDiff, std::fabs(repaired[v] - fresh[v]));
+        }
+    }
+
+    double perUpdate = static_cast<double>(updates) * depots;
+    std::printf("graph: %d nodes, %d watched sources, %d congestion updates\n", n, depots, updates);
+    std::printf("full recompute : %8.3f s  %9.3f ms per tree update  (%d nodes each)\n",
+                fullSec, 1000.0 * fullSec / perUpdate, n);
+    std::printf("repair         : %8.3f s  %9.3f ms per tree update  (%.0f nodes examined on average)\n",
+                repairSec, 1000.0 * repairSec / perUpdate, work / perUpdate);
+    std::printf("max |repaired - recomputed| = %g (checksum %.1f)\n", maxDiff, checksum);
+    return 0;
+}
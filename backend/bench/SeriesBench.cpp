@@ -0,0 +1,160 @@
+// ===================== SeriesBench.cpp =====================
+// Per-road traffic counters: a million registered series, a few thousand
+// of them busy over two days. Ingest and multi-series range sums against
+// one sum segment tree per series (the old single-series layout, with
+// 64-bit nodes). Then min/max/mean over ranges of up to a week from the
+// aggregate tiers against scanning the raw minutes.
+//
+//   SeriesBench [series=1000000] [active=10000] [updates=5000000] [queries=2000] [width=500]
+//               [weekSeries=1000]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "TimeSeriesManager.h"
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// Old layout: sum segment tree over a power-of-two number of minutes
+struct SumTree {
+    int n = 1;
+    std::vector<int64_t> tree;
+    explicit SumTree(int slots) {
+        while (n < slots) n <<= 1;
+        tree.assign(2 * n, 0);
+    }
+    void add(int idx, int64_t delta) {
+        for (int pos = idx + n; pos >= 1; pos >>= 1) tree[pos] += delta;
+    }
+    int64_t query(int l, int r) const {
+        int64_t res = 0;
+        for (int L = l + n, R = r + n; L <= R; L >>= 1, R >>= 1) {
+            if (L & 1) res += tree[L++];
+            if (!(R & 1)) res += tree[R--];
+        }
+        return res;
+    }
+};
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int numSeries = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int active = argc > 2 ? std::atoi(argv[2]) : 10000;
+    int updates = argc > 3 ? std::atoi(argv[3]) : 5000000;
+    int queries = argc > 4 ? std::atoi(argv[4]) : 2000;
+    int width = argc > 5 ? std::atoi(argv[5]) : 500;
+    int weekSeries = argc > 6 ? std::atoi(argv[6]) : 1000;
+    const int minutes = 2 * TimeSeriesManager::MINUTES_PER_DAY;
+    active = std::min(active, numSeries);
+
+    std::mt19937 rng(14);
+    std::uniform_int_distribution<int> busy(0, active - 1), minute(0, minutes - 1);
+    std::uniform_int_distribution<int> delta(1, 9);
+
+    struct Update { int series, minute, delta; };
+    std::vector<Update> stream(updates);
+    for (auto &u : stream) u = {busy(rng), minute(rng), delta(rng)};
+
+    struct Query { std::vector<uint32_t> series; int from, to; };
+    std::vector<Query> batch(queries);
+    for (auto &q : batch) {
+        q.series.resize(width);
+        for (auto &s : q.series) s = static_cast<uint32_t>(busy(rng));
+        q.from = minute(rng);
+        q.to = minute(rng);
+        if (q.from > q.to) std::swap(q.from, q.to);
+    }
+
+    // ---------------- SEGMENT TREE PER SERIES ----------------
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<SumTree> trees(active, SumTree(minutes));
+    for (const auto &u : stream) trees[u.series].add(u.minute, u.delta);
+    double treeIngest = secondsSince(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    int64_t treeSum = 0;
+    for (const auto &q : batch) {
+        for (uint32_t s : q.series) treeSum += trees[s].query(q.from, q.to);
+    }
+    double treeQuery = secondsSince(t0);
+    std::size_t treeBytes = static_cast<std::size_t>(active) * trees[0].tree.size() * sizeof(int64_t);
+    trees.clear();
+    trees.shrink_to_fit();
+
+    // ---------------- COLUMNAR STORE ----------------
+    TimeSeriesManager store(7);
+    for (int id = 0; id < numSeries; ++id) store.seriesId(SeriesKind::Edge, id);
+    t0 = std::chrono::steady_clock::now();
+    for (const auto &u : stream) store.add(static_cast<uint32_t>(u.series), u.minute, u.delta);
+    double storeIngest = secondsSince(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    int64_t storeSum = 0;
+    for (const auto &q : batch) storeSum += store.rangeSum(q.series, q.from, q.to);
+    double storeQuery = secondsSince(t0);
+
+    std::printf("%d series (%d busy), %d updates over 2 days, %d queries x %d series\n",
+                numSeries, active, updates, queries, width);
+    std::printf("segment tree per series : ingest %7.3f s  query %7.3f s  %7.1f MiB\n",
+                treeIngest, treeQuery, treeBytes / 1048576.0);
+    std::printf("columnar day segments   : ingest %7.3f s  query %7.3f s  %7.1f MiB\n",
+                storeIngest, storeQuery, store.memoryBytes() / 1048576.0);
+    std::printf("sums match: %s\n", treeSum == storeSum ? "yes" : "no");
+
+    // ---------------- WEEK AGGREGATES ----------------
+    store = TimeSeriesManager(7);
+    const int week = 7 * TimeSeriesManager::MINUTES_PER_DAY;
+    std::vector<int64_t> raw(static_cast<std::size_t>(weekSeries) * week, 0);
+    std::vector<char> seen(raw.size(), 0);
+    std::uniform_int_distribution<int> weekSeriesPick(0, weekSeries - 1), weekMinute(0, week - 1);
+    std::uniform_int_distribution<int> signedDelta(-5, 9);
+    for (int id = 0; id < weekSeries; ++id) store.seriesId(SeriesKind::Edge, id);
+    for (int i = 0; i < updates; ++i) {
+        int sid = weekSeriesPick(rng), m = weekMinute(rng), d = signedDelta(rng);
+        store.add(static_cast<uint32_t>(sid), m, d);
+        std::size_t k = static_cast<std::size_t>(sid) * week + m;
+        raw[k] += d;
+        seen[k] = 1;
+    }
+    std::vector<std::pair<int, int>> ranges(queries);
+    std::vector<uint32_t> picks(queries);
+    for (int q = 0; q < queries; ++q) {
+        int a = weekMinute(rng), b = weekMinute(rng);
+        ranges[q] = {std::min(a, b), std::max(a, b)};
+        picks[q] = static_cast<uint32_t>(weekSeriesPick(rng));
+    }
+
+    t0 = std::chrono::steady_clock::now();
+    int64_t scanCheck = 0;
+    for (int q = 0; q < queries; ++q) {
+        SeriesAggregate agg;
+        const int64_t *row = raw.data() + static_cast<std::size_t>(picks[q]) * week;
+        const char *rowSeen = seen.data() + static_cast<std::size_t>(picks[q]) * week;
+        for (int m = ranges[q].first; m <= ranges[q].second; ++m) {
+            if (rowSeen[m]) agg.include(row[m]);
+        }
+        scanCheck += agg.sum + agg.count + (agg.count ? agg.min + agg.max : 0);
+    }
+    double scanSec = secondsSince(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    int64_t tierCheck = 0;
+    for (int q = 0; q < queries; ++q) {
+        SeriesAggregate agg = store.aggregate(picks[q], ranges[q].first, ranges[q].second);
+        tierCheck += agg.sum + agg.count + (agg.count ? agg.min + agg.max : 0);
+    }
+    double tierSec = secondsSince(t0);
+
+    std::printf("%d series over 7 days, %d min/max/mean queries\n", weekSeries, queries);
+    std::printf("raw minute scan         : %8.4f s\n", scanSec);
+    std::printf("aggregate tiers         : %8.4f s\n", tierSec);
+    std::printf("aggregates match: %s\n", scanCheck == tierCheck ? "yes" : "no");
+    return 0;
+}
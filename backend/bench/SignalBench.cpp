@@ -0,0 +1,78 @@
+// ===================== SignalBench.cpp =====================
+// A day of signal timing for a city: every intersection runs a four-phase
+// cycle (N-S green / yellow, E-W green / yellow) of its own length, with
+// corridors of twenty signals coordinated as green waves. Phase changes
+// fired by the SignalScheduler's timing wheel against a per-second
+// tickAll over every signal clock; both must end in the same phases.
+//
+//   SignalBench [intersections=10000] [hours=24]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "SignalScheduler.h"
+#include "TrafficController.h"
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+void buildCity(TrafficController &traffic, SignalScheduler &scheduler, int count) {
+    const uint8_t ns = approachBit(Approach::North) | approachBit(Approach::South);
+    const uint8_t ew = approachBit(Approach::East) | approachBit(Approach::West);
+    for (int i = 0; i < count; ++i) {
+        int index = traffic.addIntersection(i);
+        int green = 20 + (i * 7) % 31;
+        traffic.addSignalPhase(index, ns, green);
+        traffic.addSignalPhase(index, ns, 4, true);
+        traffic.addSignalPhase(index, ew, 70 - green);
+        traffic.addSignalPhase(index, ew, 4, true);
+    }
+    // Corridors of 20 consecutive signals, 35-50 s of driving apart
+    for (int first = 0; first + 20 <= count; first += 20) {
+        std::vector<int> corridor;
+        std::vector<int64_t> travel;
+        for (int k = 0; k < 20; ++k) {
+            corridor.push_back(first + k);
+            travel.push_back(35 + (first + k) % 16);
+        }
+        scheduler.coordinateCorridor(corridor, travel, first % 78);
+    }
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    int count = argc > 1 ? std::atoi(argv[1]) : 10000;
+    int hours = argc > 2 ? std::atoi(argv[2]) : 24;
+    int64_t seconds = static_cast<int64_t>(hours) * 3600;
+
+    TrafficController ticked, wheeled;
+    SignalScheduler tickSetup(ticked), scheduler(wheeled);
+    buildCity(ticked, tickSetup, count);
+    buildCity(wheeled, scheduler, count);
+    // Same starting phases (offsets applied) for both
+    tickSetup.start(0);
+    scheduler.start(0);
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int64_t s = 0; s < seconds; ++s) ticked.tickAll(1, 0);
+    double tickTime = secondsSince(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    std::size_t changes = scheduler.advanceTo(seconds);
+    double wheelTime = secondsSince(t0);
+
+    int differing = 0;
+    for (int i = 0; i < count; ++i) differing += ticked.phaseOf(i) != wheeled.phaseOf(i);
+
+    std::printf("%d signals, %d h simulated, %zu phase changes\n", count, hours, changes);
+    std::printf("tickAll every second : %8.3f s\n", tickTime);
+    std::printf("timing wheel         : %8.3f s  (%.1f ns/change, %.0fx real time)\n",
+                wheelTime, changes ? 1e9 * wheelTime / static_cast<double>(changes) : 0.0,
+                wheelTime > 0 ? static_cast<double>(seconds) / wheelTime : 0.0);
+    std::printf("same phases at the end: %s\n", differing == 0 ? "yes" : "NO");
+    return 0;
+}
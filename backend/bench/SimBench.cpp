@@ -0,0 +1,137 @@
+// ===================== SimBench.cpp =====================
+// Cost of one VehicleSimulator tick: the old per-vehicle full Dijkstra
+// against the pooled trip-cost tick, and a determinism check of the
+// pooled tick across thread counts (positions and undo order).
+//
+//   SimBench [side=150] [vehicles=3000] [threads=0]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+#include "VehicleSimulator.h"
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+struct Trip {
+    int id, start, dest;
+};
+
+// Runs two ticks (new destinations in between), then undoes half the
+// moves; returns every vehicle's node after each phase
+std::vector<int> run(CoreEngineService &engine, const std::vector<Trip> &trips,
+                     int threads, double &tickSec) {
+    engine.setWorkerThreads(threads);
+    TrafficController traffic;
+    ParkingManager parking;
+    VehicleSimulator sim(&traffic, &parking, &engine);
+    for (const Trip &t : trips) sim.addVehicle(t.id, t.start, t.dest);
+
+    auto t0 = std::chrono::steady_clock::now();
+    sim.simulateStep();
+    tickSec = secondsSince(t0);
+
+    std::vector<int> trace;
+    Vehicle v;
+    for (const Trip &t : trips) {
+        sim.getVehicle(t.id, v);
+        trace.push_back(v.currentNode);
+    }
+    for (const Trip &t : trips) {
+        sim.getVehicle(t.id, v);
+        sim.addVehicle(t.id, v.currentNode, t.start);
+    }
+    sim.simulateStep();
+    for (std::size_t k = 0; k < trips.size() / 2; ++k) sim.undoLastAction();
+    for (const Trip &t : trips) {
+        sim.getVehicle(t.id, v);
+        trace.push_back(v.currentNode);
+    }
+    return trace;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int side = argc > 1 ? std::atoi(argv[1]) : 150;
+    int numVehicles = argc > 2 ? std::atoi(argv[2]) : 3000;
+    int threads = argc > 3 ? std::atoi(argv[3]) : 0;
+    int n = side * side;
+    int islands = side;                      // unreachable nodes past the grid
+
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> len(1.0, 4.0);
+
+    CoreEngineService engine;
+    engine.reserveNodes(n + islands);
+    for (int r = 0; r < side; ++r) {
+        for (int c = 0; c < side; ++c) {
+            int u = r * side + c + 1;
+            if (c + 1 < side) {
+                double w = len(rng);
+                engine.addRoad(u, u + 1, w);
+                engine.addRoad(u + 1, u, w);
+            }
+            if (r + 1 < side) {
+                double w = len(rng);
+                engine.addRoad(u, u + side, w);
+                engine.addRoad(u + side, u, w);
+            }
+        }
+    }
+    engine.freezeGraph();
+
+    std::uniform_int_distribution<int> pick(1, n + islands);
+    std::vector<Trip> trips(numVehicles);
+    for (int i = 0; i < numVehicles; ++i) trips[i] = {1000 + i * 7, pick(rng), pick(rng)};
+
+    // Old tick: full single-source Dijkstra per vehicle, serially
+    auto t0 = std::chrono::steady_clock::now();
+    int reachable = 0;
+    for (const Trip &t : trips) {
+        std::vector<double> dist = engine.computeRoute(t.start);
+        if (t.dest < static_cast<int>(dist.size()) &&
+            dist[t.dest] != std::numeric_limits<double>::infinity()) {
+            ++reachable;
+        }
+    }
+    double oldSec = secondsSince(t0);
+    // The ticks below must search, not read the trees the old tick cached
+    engine.clearRouteCache();
+
+    double dijkstraSec, singleSec, parallelSec, hierarchySec;
+    std::vector<int> dijkstraTrace = run(engine, trips, 1, dijkstraSec);
+
+    t0 = std::chrono::steady_clock::now();
+    engine.buildHierarchy();
+    double buildSec = secondsSince(t0);
+
+    std::vector<int> single = run(engine, trips, 1, singleSec);
+    std::vector<int> parallel = run(engine, trips, threads, parallelSec);
+    std::vector<int> oversubscribed = run(engine, trips, 8, hierarchySec);
+
+    int moved = 0;
+    for (std::size_t k = 0; k < trips.size(); ++k) {
+        if (single[k] == trips[k].dest && trips[k].start != trips[k].dest) ++moved;
+    }
+    bool same = single == parallel && single == oversubscribed && single == dijkstraTrace;
+
+    unsigned hw = std::thread::hardware_concurrency();
+    std::printf("graph: %d nodes (+%d unreachable), %d vehicles, %d reachable\n",
+                n, islands, numVehicles, reachable);
+    std::printf("old tick (computeRoute each)   : %8.3f s\n", oldSec);
+    std::printf("tick, Dijkstra, 1 thread       : %8.3f s\n", dijkstraSec);
+    std::printf("hierarchy build                : %8.3f s\n", buildSec);
+    std::printf("tick, hierarchy, 1 thread      : %8.3f s\n", singleSec);
+    std::printf("tick, hierarchy, %2d threads    : %8.3f s  (%u hardware threads)\n",
+                threads > 0 ? threads : static_cast<int>(hw), parallelSec, hw);
+    std::printf("tick, hierarchy,  8 threads    : %8.3f s\n", hierarchySec);
+    std::printf("moved %d, identical across runs: %s\n", moved, same ? "yes" : "NO");
+    return 0;
+}
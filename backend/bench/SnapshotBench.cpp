@@ -0,0 +1,198 @@
+// ===================== SnapshotBench.cpp =====================
+// Saving and resuming a large run. Builds a city state (congested grid,
+// emergency queue, a week of per-road traffic history, signals with
+// queues, parking with bookings, a million vehicles) the way a run
+// would, then times SimulationSnapshot::snapshot and restore into fresh
+// components on the same road graph, with and without the checksum pass.
+// The restored state is checked with queries and by snapshotting it again,
+// which must give the same bytes.
+//
+//   SnapshotBench [series=3000] [vehicles=1000000] [side=300] [path=/tmp/citysense.snap]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+#include "SimulationSnapshot.h"
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+void buildGrid(CoreEngineService &engine, int side) {
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> len(0.2, 1.5);
+    engine.reserveNodes(side * side);
+    for (int r = 0; r < side; ++r) {
+        for (int c = 0; c < side; ++c) {
+            int u = r * side + c + 1;
+            if (c + 1 < side) {
+                double w = len(rng);
+                engine.addRoad(u, u + 1, w);
+                engine.addRoad(u + 1, u, w);
+            }
+            if (r + 1 < side) {
+                double w = len(rng);
+                engine.addRoad(u, u + side, w);
+                engine.addRoad(u + side, u, w);
+            }
+        }
+    }
+    engine.freezeGraph();
+}
+
+struct City {
+    CoreEngineService engine;
+    TrafficController traffic;
+    ParkingManager parking;
+    VehicleSimulator sim;
+    City() : sim(&traffic, &parking, &engine) {}
+    SimulationSnapshot snapshots() { return SimulationSnapshot(&engine, &traffic, &parking, &sim); }
+};
+
+bool sameFiles(const std::string &a, const std::string &b) {
+    std::ifstream fa(a, std::ios::binary), fb(b, std::ios::binary);
+    std::istreambuf_iterator<char> ia(fa), ib(fb), end;
+    for (; ia != end && ib != end; ++ia, ++ib) {
+        if (*ia != *ib) return false;
+    }
+    return ia == end && ib == end;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int series = argc > 1 ? std::atoi(argv[1]) : 3000;
+    int vehicles = argc > 2 ? std::atoi(argv[2]) : 1000000;
+    int side = argc > 3 ? std::atoi(argv[3]) : 300;
+    std::string path = argc > 4 ? argv[4] : "/tmp/citysense.snap";
+    int nodes = side * side;
+    const int days = 7;
+    const int intersections = 20000;
+    const int spots = 100000;
+
+    std::mt19937 rng(17);
+    std::uniform_int_distribution<int> node(1, nodes);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    // ---------------- live state ----------------
+    City live;
+    buildGrid(live.engine, side);
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < nodes / 5; ++k) {
+        int u = node(rng);
+        int v = u % side != 0 ? u + 1 : u - 1;
+        live.engine.applyCongestionToEdge(u, v, 1.0 + 3.0 * unit(rng));
+    }
+    const char *types[] = {"ambulance", "fire", "police", "hazmat"};
+    for (int id = 1; id <= 200000; ++id) {
+        live.engine.addEmergencyRequest(id, node(rng), types[id % 4], unit(rng) * 100.0);
+    }
+    // Hourly counts per road over the week, plus the city counter
+    for (int d = 0; d < days; ++d) {
+        for (int h = 0; h < 24; ++h) {
+            int64_t minute = (d * 24 + h) * 60 + static_cast<int>(unit(rng) * 60);
+            for (int s = 0; s < series; ++s) {
+                live.engine.recordTraffic(SeriesKind::Edge, s, minute, 1 + (s + h) % 17);
+            }
+            live.engine.updateTraffic(static_cast<int>(minute), 40 + h);
+        }
+    }
+    for (int i = 0; i < intersections; ++i) {
+        int id = i + 1;
+        live.traffic.addSignalPhase(id, "N-S", 30);
+        live.traffic.addSignalPhase(id, "N-S yellow", 4);
+        live.traffic.addSignalPhase(id, "E-W", 26);
+        live.traffic.addSignalPhase(id, "E-W yellow", 4);
+        for (int q = 0; q < 12; ++q) {
+            live.traffic.enqueueVehicle(i, static_cast<Approach>(q % APPROACHES), id * 16 + q);
+        }
+    }
+    live.traffic.tickAll(37);
+    for (int s = 0; s < spots; ++s) {
+        live.parking.addSpot("P" + std::to_string(s), s % 50, s % 3 == 0 ? node(rng) : 0);
+    }
+    live.parking.setReservationWindow(0, 2 * 1440);
+    for (int s = 0; s < spots; s += 3) live.parking.assignSpot(static_cast<uint32_t>(s), s);
+    for (int b = 0; b < 20000; ++b) {
+        int64_t start = static_cast<int64_t>(unit(rng) * 2800);
+        live.parking.reserveSpot(static_cast<uint32_t>(b * 5 % spots), start, start + 30, b);
+    }
+    live.sim.setUndoCapacity(1 << 10);
+    for (int v = 0; v < vehicles; ++v) live.sim.addVehicle(v * 3 + 1, node(rng), node(rng));
+    for (int v = 0; v < vehicles; v += 7) live.sim.tryParking(v * 3 + 1, v % 50);
+    double buildSec = secondsSince(t0);
+
+    // ---------------- snapshot ----------------
+    SimulationSnapshot saver = live.snapshots();
+    t0 = std::chrono::steady_clock::now();
+    bool saved = saver.snapshot(path);
+    double saveSec = secondsSince(t0);
+    double mb = saver.fileBytes() / 1e6;
+
+    // ---------------- restore ----------------
+    City fork;
+    buildGrid(fork.engine, side);
+    SimulationSnapshot loader = fork.snapshots();
+    t0 = std::chrono::steady_clock::now();
+    bool restored = loader.restore(path);
+    double restoreSec = secondsSince(t0);
+
+    City fast;
+    buildGrid(fast.engine, side);
+    SimulationSnapshot fastLoader = fast.snapshots();
+    t0 = std::chrono::steady_clock::now();
+    bool restoredFast = fastLoader.restore(path, false);
+    double fastSec = secondsSince(t0);
+
+    // ---------------- checks ----------------
+    bool same = saved && restored && restoredFast;
+    for (int k = 0; k < 1000 && same; ++k) {
+        int u = node(rng);
+        int v = u % side != 0 ? u + 1 : u - 1;
+        same = fork.engine.roadGraph().getCongestion(u, v) == live.engine.roadGraph().getCongestion(u, v);
+        int s = k % series;
+        int64_t from = static_cast<int64_t>(unit(rng) * days * 1440);
+        same = same &&
+               fork.engine.getTrafficRange(SeriesKind::Edge, {s}, from, from + 500) ==
+                   live.engine.getTrafficRange(SeriesKind::Edge, {s}, from, from + 500) &&
+               fork.engine.getTrafficStats(from, from + 3000).max ==
+                   live.engine.getTrafficStats(from, from + 3000).max;
+        int i = k * 13 % intersections;
+        same = same && fork.traffic.getCurrentDirection(i + 1) == live.traffic.getCurrentDirection(i + 1) &&
+               fork.traffic.dequeueAt(i) == live.traffic.dequeueAt(i);
+        uint32_t spot = static_cast<uint32_t>(k * 97 % spots);
+        same = same && fork.parking.getVehicleInSpot(spot) == live.parking.getVehicleInSpot(spot) &&
+               fork.parking.isReserved(spot, 0, 2 * 1440) == live.parking.isReserved(spot, 0, 2 * 1440) &&
+               fork.parking.freeSpotCount(k % 50) == live.parking.freeSpotCount(k % 50);
+        Vehicle a, b;
+        int id = (k * 7919 % vehicles) * 3 + 1;
+        same = same && fork.sim.getVehicle(id, a) && live.sim.getVehicle(id, b) &&
+               a.currentNode == b.currentNode && a.destinationNode == b.destinationNode &&
+               a.parked == b.parked;
+    }
+    // The checks dequeued from both; snapshot the pair again and compare
+    std::string again = path + ".again", liveAgain = path + ".live";
+    bool identical = fork.snapshots().snapshot(again) && live.snapshots().snapshot(liveAgain) &&
+                     sameFiles(again, liveAgain);
+    std::remove(again.c_str());
+    std::remove(liveAgain.c_str());
+    std::remove(path.c_str());
+
+    std::printf("grid %d nodes, %d road series x %d days, 200000 emergencies, %d signals, %d spots, %d vehicles\n",
+                nodes, series, days, intersections, spots, vehicles);
+    std::printf("building the state by replay :  %7.3f s\n", buildSec);
+    std::printf("snapshot                     :  %7.3f s  %8.1f MB  %6.0f MB/s\n", saveSec, mb,
+                mb / saveSec);
+    std::printf("restore, checksum verified   :  %7.3f s  %6.0f MB/s\n", restoreSec, mb / restoreSec);
+    std::printf("restore, no checksum         :  %7.3f s  %6.0f MB/s\n", fastSec, mb / fastSec);
+    std::printf("same state: %s, snapshot of the restored state identical: %s\n",
+                same ? "yes" : "NO", identical ? "yes" : "NO");
+    return 0;
+}
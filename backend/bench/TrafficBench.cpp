@@ -0,0 +1,140 @@
+// ===================== TrafficBench.cpp =====================
+// Signal ticks over a city of intersections: every second each signal
+// counts down its phase and every green lane lets one vehicle through,
+// while new arrivals join the lanes. The old nested-map controller
+// (copied here, driven through its per-intersection calls) against
+// TrafficController::tickAll over the flat arrays.
+//
+//   TrafficBench [intersections=50000] [seconds=600] [arrivalsPerSecond=20000]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <queue>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "TrafficController.h"
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// The previous layout: intersection -> direction string -> std::queue,
+// phases as (direction string, duration)
+class MapTraffic {
+private:
+    struct Phase {
+        std::string direction;
+        int duration;
+    };
+    std::unordered_map<int, std::unordered_map<std::string, std::queue<int>>> queues;
+    std::unordered_map<int, std::vector<Phase>> phases;
+    std::unordered_map<int, int> current;
+
+public:
+    void addSignalPhase(int id, const std::string &dir, int duration) {
+        phases[id].push_back({dir, duration});
+        current.emplace(id, 0);
+    }
+    void enqueueVehicle(int id, const std::string &dir, int vehicle) { queues[id][dir].push(vehicle); }
+    std::string getCurrentDirection(int id) const {
+        auto it = phases.find(id);
+        return it->second[current.find(id)->second].direction;
+    }
+    int phaseDuration(int id) const { return phases.find(id)->second[current.find(id)->second].duration; }
+    void advancePhase(int id) {
+        int &idx = current[id];
+        idx = (idx + 1) % static_cast<int>(phases[id].size());
+    }
+    int dequeueVehicle(int id) {
+        auto &lane = queues[id][getCurrentDirection(id)];
+        if (lane.empty()) return -1;
+        int v = lane.front();
+        lane.pop();
+        return v;
+    }
+};
+
+struct Arrival {
+    int intersection;
+    bool northSouth;
+};
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    int count = argc > 1 ? std::atoi(argv[1]) : 50000;
+    int seconds = argc > 2 ? std::atoi(argv[2]) : 600;
+    int perSecond = argc > 3 ? std::atoi(argv[3]) : 20000;
+
+    std::mt19937 rng(23);
+    std::uniform_int_distribution<int> pick(0, count - 1);
+    std::vector<Arrival> arrivals(static_cast<std::size_t>(seconds) * perSecond);
+    for (auto &a : arrivals) a = {pick(rng), (rng() & 1u) != 0};
+
+    MapTraffic before;
+    TrafficController after(256);
+    for (int i = 0; i < count; ++i) {
+        int green = 20 + i % 21;
+        before.addSignalPhase(i, "N-S", green);
+        before.addSignalPhase(i, "E-W", 60 - green);
+        after.addSignalPhase(i, "N-S", green);
+        after.addSignalPhase(i, "E-W", 60 - green);
+    }
+
+    // Old: one countdown per intersection kept by the caller
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<int> left(count);
+    for (int i = 0; i < count; ++i) left[i] = before.phaseDuration(i);
+    long long sumBefore = 0, passedBefore = 0;
+    std::size_t next = 0;
+    for (int s = 0; s < seconds; ++s) {
+        for (int k = 0; k < perSecond; ++k, ++next) {
+            const Arrival &a = arrivals[next];
+            before.enqueueVehicle(a.intersection, a.northSouth ? "N-S" : "E-W", static_cast<int>(next));
+        }
+        for (int i = 0; i < count; ++i) {
+            if (--left[i] == 0) {
+                before.advancePhase(i);
+                left[i] = before.phaseDuration(i);
+            }
+            int v = before.dequeueVehicle(i);
+            if (v >= 0) {
+                sumBefore += v;
+                ++passedBefore;
+            }
+        }
+    }
+    double tickBefore = secondsSince(t0);
+
+    // New: both approaches of a phase are green, so a phase's single old
+    // lane maps to North (N-S) or East (E-W) to discharge the same vehicles
+    t0 = std::chrono::steady_clock::now();
+    long long sumAfter = 0, passedAfter = 0, dropped = 0;
+    std::vector<int> out;
+    next = 0;
+    for (int s = 0; s < seconds; ++s) {
+        for (int k = 0; k < perSecond; ++k, ++next) {
+            const Arrival &a = arrivals[next];
+            if (!after.enqueueVehicle(a.intersection, a.northSouth ? Approach::North : Approach::East,
+                                      static_cast<int>(next))) {
+                ++dropped;
+            }
+        }
+        out.clear();
+        after.tickAll(1, 1, &out);
+        for (int v : out) sumAfter += v;
+        passedAfter += static_cast<long long>(out.size());
+    }
+    double tickAfter = secondsSince(t0);
+
+    std::printf("%d intersections, %d s, %d arrivals/s\n", count, seconds, perSecond);
+    std::printf("nested maps  : %8.3f s  (%lld vehicles through)\n", tickBefore, passedBefore);
+    std::printf("flat arrays  : %8.3f s  (%lld vehicles through)\n", tickAfter, passedAfter);
+    std::printf("same discharge: %s (lane overflow: %lld)\n",
+                sumBefore == sumAfter && passedBefore == passedAfter ? "yes" : "NO", dropped);
+    return 0;
+}
@@ -0,0 +1,137 @@
+// ===================== UndoBench.cpp =====================
+// The undo log over a long run: the old UndoStack of string-keyed
+// UndoActions (copied here) against the UndoJournal ring. Every tick
+// moves every vehicle; heap bytes of the log are sampled as the run goes
+// on, then the last few ticks are rolled back (popping one action at a
+// time with std::stoi against one jump to a checkpoint).
+//
+//   UndoBench [vehicles=10000] [ticks=300] [rollback=8] [kept=16]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <stack>
+#include <string>
+#include <vector>
+#include "UndoJournal.h"
+
+// Live heap bytes, counted by replacing the global allocation functions
+static std::size_t liveBytes = 0;
+
+void *operator new(std::size_t size) {
+    void *p = std::malloc(size + 16);
+    if (!p) throw std::bad_alloc();
+    *static_cast<std::size_t *>(p) = size;
+    liveBytes += size;
+    return static_cast<char *>(p) + 16;
+}
+void operator delete(void *p) noexcept {
+    if (!p) return;
+    char *base = static_cast<char *>(p) - 16;
+    liveBytes -= *reinterpret_cast<std::size_t *>(base);
+    std::free(base);
+}
+void operator delete(void *p, std::size_t) noexcept { operator delete(p); }
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+struct OldUndoAction {
+    std::string type;
+    std::string targetID;
+    bool prevOccupied;
+    int prevVehicleID;
+};
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    int vehicles = argc > 1 ? std::atoi(argv[1]) : 10000;
+    int ticks = argc > 2 ? std::atoi(argv[2]) : 300;
+    int back = argc > 3 ? std::atoi(argv[3]) : 8;
+    int kept = argc > 4 ? std::atoi(argv[4]) : 16;
+    if (back > kept) back = kept;
+
+    // Node of every vehicle after every tick, so both logs replay the same run
+    std::mt19937 rng(9);
+    std::uniform_int_distribution<int> node(1, 100000);
+    std::vector<int> start(vehicles);
+    for (int &n : start) n = node(rng);
+    std::vector<int> moves(static_cast<std::size_t>(ticks) * vehicles);
+    for (int &n : moves) n = node(rng);
+    int samples[] = {ticks / 4, ticks / 2, ticks};
+
+    // ---------------- old: string-keyed stack ----------------
+    std::vector<int> before = start;
+    std::size_t base = liveBytes;
+    std::vector<std::size_t> bytesBefore;
+    auto t0 = std::chrono::steady_clock::now();
+    std::stack<OldUndoAction> stk;
+    for (int t = 0; t < ticks; ++t) {
+        for (int v = 0; v < vehicles; ++v) {
+            OldUndoAction a;
+            a.type = "movement";
+            a.targetID = std::to_string(v);
+            a.prevOccupied = false;
+            a.prevVehicleID = before[v];
+            stk.push(a);
+            before[v] = moves[static_cast<std::size_t>(t) * vehicles + v];
+        }
+        for (int s : samples) {
+            if (t + 1 == s) bytesBefore.push_back(liveBytes - base);
+        }
+    }
+    double logBefore = secondsSince(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    for (long long k = 0; k < static_cast<long long>(back) * vehicles; ++k) {
+        OldUndoAction a = stk.top();
+        stk.pop();
+        if (a.type == "movement") before[std::stoi(a.targetID)] = a.prevVehicleID;
+    }
+    double undoBefore = secondsSince(t0);
+
+    // ---------------- new: journal ring ----------------
+    std::vector<int> after = start;
+    base = liveBytes;
+    std::vector<std::size_t> bytesAfter;
+    t0 = std::chrono::steady_clock::now();
+    UndoJournal journal(static_cast<std::size_t>(kept) * vehicles, 64);
+    for (int t = 0; t < ticks; ++t) {
+        journal.checkpoint();
+        for (int v = 0; v < vehicles; ++v) {
+            UndoEntry entry{};
+            entry.domain = UndoDomain::Vehicles;
+            entry.target = v;
+            entry.before = after[v];
+            journal.record(entry);
+            after[v] = moves[static_cast<std::size_t>(t) * vehicles + v];
+        }
+        for (int s : samples) {
+            if (t + 1 == s) bytesAfter.push_back(liveBytes - base);
+        }
+    }
+    double logAfter = secondsSince(t0);
+
+    std::size_t retained = journal.checkpoints();
+    t0 = std::chrono::steady_clock::now();
+    bool rolled = journal.rollback(static_cast<std::size_t>(back),
+                                   [&after](const UndoEntry &e) { after[e.target] = e.before; });
+    double undoAfter = secondsSince(t0);
+
+    std::printf("%d vehicles x %d ticks, roll back %d ticks, journal sized for %d ticks (%zu entries)\n",
+                vehicles, ticks, back, kept, journal.capacity());
+    std::printf("UndoStack  : log %7.3f s  heap after %d/%d/%d ticks %8.1f/%8.1f/%8.1f MB  roll back %8.4f s\n",
+                logBefore, samples[0], samples[1], samples[2], bytesBefore[0] / 1e6,
+                bytesBefore[1] / 1e6, bytesBefore[2] / 1e6, undoBefore);
+    std::printf("UndoJournal: log %7.3f s  heap after %d/%d/%d ticks %8.1f/%8.1f/%8.1f MB  roll back %8.4f s\n",
+                logAfter, samples[0], samples[1], samples[2], bytesAfter[0] / 1e6,
+                bytesAfter[1] / 1e6, bytesAfter[2] / 1e6, undoAfter);
+    std::printf("entry: %zu bytes, checkpoints in the ring: %zu; same state after roll back: %s\n",
+                sizeof(UndoEntry), retained, rolled && before == after ? "yes" : "NO");
+    return 0;
+}
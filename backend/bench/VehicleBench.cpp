@@ -0,0 +1,195 @@
+// ===================== VehicleBench.cpp =====================
+// The vehicle store at a million vehicles: the old unordered_map<int,
+// Vehicle> (copied here) against VehicleTable. Heap bytes per vehicle,
+// the store's share of a simulation tick (unparked vehicles in id order,
+// their trips read, every one moved), "unparked vehicles at node X"
+// filters, and add/remove churn.
+//
+//   VehicleBench [vehicles=1000000] [nodes=10000] [filters=200]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "VehicleTable.h"
+
+// Live heap bytes, counted by replacing the global allocation functions
+static std::size_t liveBytes = 0;
+
+void *operator new(std::size_t size) {
+    void *p = std::malloc(size + 16);
+    if (!p) throw std::bad_alloc();
+    *static_cast<std::size_t *>(p) = size;
+    liveBytes += size;
+    return static_cast<char *>(p) + 16;
+}
+void operator delete(void *p) noexcept {
+    if (!p) return;
+    char *base = static_cast<char *>(p) - 16;
+    liveBytes -= *reinterpret_cast<std::size_t *>(base);
+    std::free(base);
+}
+void operator delete(void *p, std::size_t) noexcept { operator delete(p); }
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+struct OldVehicle {
+    int id;
+    int currentNode;
+    int destinationNode;
+    bool parked;
+};
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    int count = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int nodes = argc > 2 ? std::atoi(argv[2]) : 10000;
+    int filters = argc > 3 ? std::atoi(argv[3]) : 200;
+
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<int> node(1, nodes);
+    std::vector<int> ids(count);
+    for (int k = 0; k < count; ++k) ids[k] = k * 7 + 3;
+    std::shuffle(ids.begin(), ids.end(), rng);
+    std::vector<int> at(count), dest(count);
+    for (int k = 0; k < count; ++k) {
+        at[k] = node(rng);
+        dest[k] = node(rng);
+    }
+    std::vector<int> probes(filters);
+    for (int &p : probes) p = node(rng);
+
+    // ---------------- build ----------------
+    std::size_t base = liveBytes;
+    auto t0 = std::chrono::steady_clock::now();
+    std::unordered_map<int, OldVehicle> before;
+    for (int k = 0; k < count; ++k) {
+        before[ids[k]] = {ids[k], at[k], dest[k], k % 10 == 0};
+    }
+    double buildBefore = secondsSince(t0);
+    std::size_t bytesBefore = liveBytes - base;
+
+    base = liveBytes;
+    t0 = std::chrono::steady_clock::now();
+    VehicleTable after;
+    for (int k = 0; k < count; ++k) {
+        uint32_t slot = after.add(ids[k], at[k], dest[k]);
+        after.setParked(slot, k % 10 == 0);
+    }
+    double buildAfter = secondsSince(t0);
+    std::size_t bytesAfter = liveBytes - base;
+
+    // ---------------- tick ----------------
+    t0 = std::chrono::steady_clock::now();
+    long long checkBefore = 0;
+    {
+        std::vector<int> order;
+        order.reserve(before.size());
+        for (const auto &kv : before) {
+            if (!kv.second.parked) order.push_back(kv.first);
+        }
+        std::sort(order.begin(), order.end());
+        std::vector<int> sources(order.size()), dests(order.size());
+        for (std::size_t k = 0; k < order.size(); ++k) {
+            const OldVehicle &v = before[order[k]];
+            sources[k] = v.currentNode;
+            dests[k] = v.destinationNode;
+        }
+        for (std::size_t k = 0; k < order.size(); ++k) {
+            OldVehicle &v = before[order[k]];
+            v.currentNode = v.destinationNode;
+            checkBefore += sources[k] ^ dests[k];
+        }
+    }
+    double tickBefore = secondsSince(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    long long checkAfter = 0;
+    {
+        std::vector<uint32_t> slots;
+        after.unparked(slots);
+        const int32_t *idCol = after.idColumn();
+        std::sort(slots.begin(), slots.end(),
+                  [idCol](uint32_t a, uint32_t b) { return idCol[a] < idCol[b]; });
+        const int32_t *nodeCol = after.nodeColumn();
+        const int32_t *destCol = after.destinationColumn();
+        std::vector<int> sources(slots.size()), dests(slots.size());
+        for (std::size_t k = 0; k < slots.size(); ++k) {
+            sources[k] = nodeCol[slots[k]];
+            dests[k] = destCol[slots[k]];
+        }
+        for (std::size_t k = 0; k < slots.size(); ++k) {
+            after.setNode(slots[k], after.destination(slots[k]));
+            checkAfter += sources[k] ^ dests[k];
+        }
+    }
+    double tickAfter = secondsSince(t0);
+
+    // ---------------- filters ----------------
+    t0 = std::chrono::steady_clock::now();
+    std::size_t foundBefore = 0;
+    for (int x : probes) {
+        std::vector<int> out;
+        for (const auto &kv : before) {
+            if (kv.second.currentNode == x && !kv.second.parked) out.push_back(kv.first);
+        }
+        foundBefore += out.size();
+    }
+    double filterBefore = secondsSince(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    std::size_t foundAfter = 0;
+    std::vector<uint32_t> out;
+    for (int x : probes) {
+        after.unparkedAt(x, out);
+        foundAfter += out.size();
+    }
+    double filterAfter = secondsSince(t0);
+
+    // ---------------- churn ----------------
+    int churn = count / 10;
+    t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < churn; ++k) {
+        before.erase(ids[k]);
+        before[ids[k] + 1] = {ids[k] + 1, at[k], dest[k], false};
+    }
+    double churnBefore = secondsSince(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < churn; ++k) {
+        after.remove(ids[k]);
+        after.add(ids[k] + 1, at[k], dest[k]);
+    }
+    double churnAfter = secondsSince(t0);
+
+    // Every vehicle still found at its own node after the churn
+    bool indexOk = true;
+    for (const auto &kv : before) {
+        int64_t slot = after.find(kv.first);
+        indexOk = indexOk && slot >= 0 && after.id(static_cast<uint32_t>(slot)) == kv.first &&
+                  after.node(static_cast<uint32_t>(slot)) == kv.second.currentNode;
+    }
+
+    std::printf("%d vehicles over %d nodes (10%% parked)\n", count, nodes);
+    std::printf("unordered_map: %5.1f B/vehicle  build %7.3f s  tick %7.3f s  %d filters %7.3f s  churn %7.3f s\n",
+                static_cast<double>(bytesBefore) / count, buildBefore, tickBefore, filters,
+                filterBefore, churnBefore);
+    std::printf("VehicleTable : %5.1f B/vehicle  build %7.3f s  tick %7.3f s  %d filters %7.3f s  churn %7.3f s\n",
+                static_cast<double>(bytesAfter) / count, buildAfter, tickAfter, filters,
+                filterAfter, churnAfter);
+    std::printf("  of which columns: %.1f B/vehicle\n",
+                static_cast<double>(after.size() * (4 * sizeof(int32_t) + 1)) / after.size());
+    std::printf("same results: %s\n",
+                checkBefore == checkAfter && foundBefore == foundAfter &&
+                        before.size() == after.size() && indexOk
+                    ? "yes" : "NO");
+    return 0;
+}
@@ -0,0 +1,440 @@
+// ===================== ContractionHierarchy.cpp =====================
+#include "ContractionHierarchy.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+
+namespace {
+
+// Per-thread query state, reused across queries. A node's entries are
+// valid only when stamp[v] == gen, so nothing is cleared between queries.
+struct QueryScratch {
+    std::vector<double> distF, distB;
+    std::vector<int> parentF, parentB;
+    std::vector<uint32_t> stamp;
+    uint32_t gen = 0;
+
+    void reset(int n) {
+        if (static_cast<int>(stamp.size()) != n + 1) {
+            distF.assign(n + 1, 0.0);
+            distB.assign(n + 1, 0.0);
+            parentF.assign(n + 1, -1);
+            parentB.assign(n + 1, -1);
+            stamp.assign(n + 1, 0);
+            gen = 0;
+        }
+        if (++gen == 0) { // wrapped around
+            std::fill(stamp.begin(), stamp.end(), 0);
+            gen = 1;
+        }
+    }
+
+    void touch(int v) {
+        if (stamp[v] == gen) return;
+        stamp[v] = gen;
+        distF[v] = distB[v] = std::numeric_limits<double>::infinity();
+        parentF[v] = parentB[v] = -1;
+    }
+};
+
+
+// Nested-dissection order from BFS level separators. A subproblem is split
+// at the median BFS level from a pseudo-peripheral node: that level
+// separates the levels above it from those below, so it gets the highest
+// ranks of the subproblem and both sides are ordered recursively below it.
+// Disconnected pieces are simply split apart with an empty separator.
+std::vector<uint32_t> dissectionOrder(const std::vector<std::vector<uint32_t>> &nb, int n) {
+    std::vector<uint32_t> rank(n + 1, 0);
+    std::vector<int> owner(n + 1, -1);   // task id currently holding the node
+    std::vector<int> level(n + 1, -1);
+
+    struct Task {
+        std::vector<uint32_t> nodes;
+        uint32_t lo;                     // first rank available to the task
+    };
+    std::vector<Task> stack;
+    Task root;
+    for (int v = 1; v <= n; ++v) root.nodes.push_back(v);
+    root.lo = 0;
+    stack.push_back(std::move(root));
+    int taskId = 0;
+
+    std::vector<uint32_t> queue;
+    auto bfs = [&](uint32_t start, int id) {
+        queue.clear();
+        queue.push_back(start);
+        level[start] = 0;
+        for (std::size_t head = 0; head < queue.size(); ++head) {
+            uint32_t u = queue[head];
+            for (uint32_t w : nb[u]) {
+                if (owner[w] != id || level[w] >= 0) continue;
+                level[w] = level[u] + 1;
+                queue.push_back(w);
+            }
+        }
+    };
+
+    while (!stack.empty()) {
+        Task task = std::move(stack.back());
+        stack.pop_back();
+        std::vector<uint32_t> &nodes = task.nodes;
+        if (nodes.size() <= 2) {
+            for (std::size_t k = 0; k < nodes.size(); ++k) rank[nodes[k]] = task.lo + k;
+            continue;
+        }
+
+        int id = taskId++;
+        for (uint32_t v : nodes) {
+            owner[v] = id;
+            level[v] = -1;
+        }
+
+        // Two sweeps to find a pseudo-peripheral start
+        bfs(nodes.front(), id);
+        uint32_t far = queue.back();
+        for (uint32_t v : queue) level[v] = -1;
+        bfs(far, id);
+
+        std::vector<uint32_t> left, sep, right;
+        if (queue.size() < nodes.size()) {
+            // Disconnected: this component vs the rest
+            for (uint32_t v : nodes) (level[v] >= 0 ? left : right).push_back(v);
+        } else {
+            std::vector<std::size_t> perLevel(level[queue.back()] + 1, 0);
+            for (uint32_t v : nodes) ++perLevel[level[v]];
+            int median = 0;
+            for (std::size_t seen = 0; median < static_cast<int>(perLevel.size()); ++median) {
+                seen += perLevel[median];
+                if (2 * seen >= nodes.size()) break;
+            }
+            for (uint32_t v : nodes) {
+                if (level[v] < median) left.push_back(v);
+                else if (level[v] == median) sep.push_back(v);
+                else right.push_back(v);
+            }
+        }
+
+        uint32_t top = task.lo + static_cast<uint32_t>(nodes.size());
+        for (std::size_t k = 0; k < sep.size(); ++k) {
+            rank[sep[k]] = top - static_cast<uint32_t>(sep.size()) + k;
+        }
+        uint32_t rightLo = task.lo + static_cast<uint32_t>(left.size());
+        std::vector<uint32_t>().swap(nodes);
+        if (!left.empty()) stack.push_back({std::move(left), task.lo});
+        if (!right.empty()) stack.push_back({std::move(right), rightLo});
+    }
+    return rank;
+}
+
+} // namespace
+
+// ---------------- PREPROCESSING ----------------
+
+void ContractionHierarchy::build(const GraphManager &graph) {
+    graph.freeze();
+    const CsrGraph &g = graph.forwardGraph();
+    n = graph.nodeCount();
+
+    // Undirected simple neighbourhoods
+    std::vector<std::vector<uint32_t>> nb(n + 1);
+    for (uint32_t u = 1; u <= g.nodeCount(); ++u) {
+        for (uint32_t i = g.begin(u); i < g.end(u); ++i) {
+            uint32_t v = g.targets[i];
+            if (v == u) continue;
+            nb[u].push_back(v);
+            nb[v].push_back(u);
+        }
+    }
+    for (auto &list : nb) {
+        std::sort(list.begin(), list.end());
+        list.erase(std::unique(list.begin(), list.end()), list.end());
+    }
+
+    // Eliminate nodes in nested-dissection order. The neighbours of a node
+    // at the moment it is eliminated become its upward arcs and are joined
+    // into a clique, which yields the chordal shortcut graph.
+    rank = dissectionOrder(nb, n);
+    std::vector<uint32_t> byRank(n);
+    for (int v = 1; v <= n; ++v) byRank[rank[v]] = v;
+
+    std::vector<std::vector<uint32_t>> up(n + 1);
+    std::vector<uint32_t> merged;
+    for (uint32_t v : byRank) {
+        up[v].swap(nb[v]);
+
+        const std::vector<uint32_t> &clique = up[v];
+        for (uint32_t w : clique) {
+            // nb[w] := (nb[w] \ {v}) U (clique \ {w}), both sorted
+            const std::vector<uint32_t> &cur = nb[w];
+            merged.clear();
+            std::size_t a = 0, b = 0;
+            while (a < cur.size() || b < clique.size()) {
+                uint32_t x;
+                if (b == clique.size() || (a < cur.size() && cur[a] < clique[b])) {
+                    x = cur[a++];
+                } else if (a == cur.size() || clique[b] < cur[a]) {
+                    x = clique[b++];
+                } else {
+                    x = cur[a++];
+                    ++b;
+                }
+                if (x != v && x != w) merged.push_back(x);
+            }
+            nb[w].assign(merged.begin(), merged.end());
+        }
+    }
+
+    arcBegin.assign(static_cast<std::size_t>(n) + 2, 0);
+    for (int v = 1; v <= n; ++v) arcBegin[v + 1] = arcBegin[v] + up[v].size();
+    arcHead.clear();
+    arcHead.reserve(arcBegin[n + 1]);
+    for (int v = 1; v <= n; ++v) {
+        arcHead.insert(arcHead.end(), up[v].begin(), up[v].end());
+        std::vector<uint32_t>().swap(up[v]);
+    }
+
+    builtTopology = graph.topologyVersion();
+    built = true;
+    customized = false;
+}
+
+int64_t ContractionHierarchy::findArc(uint32_t low, uint32_t high) const {
+    auto first = arcHead.begin() + arcBegin[low];
+    auto last = arcHead.begin() + arcBegin[low + 1];
+    auto it = std::lower_bound(first, last, high);
+    if (it == last || *it != high) return -1;
+    return it - arcHead.begin();
+}
+
+// ---------------- CUSTOMIZATION ----------------
+
+void ContractionHierarchy::customize(const GraphManager &graph) {
+    if (!isCurrent(graph)) return;
+
+    const double INF = std::numeric_limits<double>::infinity();
+    const CsrGraph &g = graph.forwardGraph();
+    std::size_t m = arcHead.size();
+    upCost.assign(m, INF);
+    downCost.assign(m, INF);
+    upMid.assign(m, -1);
+    downMid.assign(m, -1);
+
+    // Roads seed the arcs they coincide with
+    for (uint32_t u = 1; u <= g.nodeCount(); ++u) {
+        for (uint32_t i = g.begin(u); i < g.end(u); ++i) {
+            uint32_t v = g.targets[i];
+            if (v == u) continue;
+            double c = graph.edgeCost(i);
+            if (rank[u] < rank[v]) {
+                int64_t a = findArc(u, v);
+                if (c < upCost[a]) upCost[a] = c;
+            } else {
+                int64_t a = findArc(v, u);
+                if (c < downCost[a]) downCost[a] = c;
+            }
+        }
+    }
+
+    // Lower triangles bottom-up: once every node below x is processed the
+    // arcs leaving x are final and can relax the arc between each pair of
+    // its upper neighbours.
+    std::vector<uint32_t> byRank(n);
+    for (int v = 1; v <= n; ++v) byRank[rank[v]] = v;
+
+    for (uint32_t x : byRank) {
+        for (uint32_t a1 = arcBegin[x]; a1 < arcBegin[x + 1]; ++a1) {
+            uint32_t u = arcHead[a1];
+            for (uint32_t a2 = arcBegin[x]; a2 < arcBegin[x + 1]; ++a2) {
+                uint32_t v = arcHead[a2];
+                if (rank[u] >= rank[v]) continue;
+
+                int64_t a = findArc(u, v);
+                double viaUp = downCost[a1] + upCost[a2];   // u -> x -> v
+                if (viaUp < upCost[a]) {
+                    upCost[a] = viaUp;
+                    upMid[a] = static_cast<int32_t>(x);
+                }
+                double viaDown = downCost[a2] + upCost[a1]; // v -> x -> u
+                if (viaDown < downCost[a]) {
+                    downCost[a] = viaDown;
+                    downMid[a] = static_cast<int32_t>(x);
+                }
+            }
+        }
+    }
+
+    // Top-down pass over intermediate and upper triangles turns every arc
+    // cost into the true distance between its endpoints. Arcs beaten by a
+    // detour are never part of a shortest up-down path, so queries skip
+    // them (cost -> inf); their middle nodes stay valid for unpacking.
+    std::vector<double> exactUp(upCost), exactDown(downCost);
+    for (auto it = byRank.rbegin(); it != byRank.rend(); ++it) {
+        uint32_t x = *it;
+        for (uint32_t a1 = arcBegin[x]; a1 < arcBegin[x + 1]; ++a1) {
+            uint32_t u = arcHead[a1];
+            for (uint32_t a2 = arcBegin[x]; a2 < arcBegin[x + 1]; ++a2) {
+                uint32_t v = arcHead[a2];
+                if (rank[u] >= rank[v]) continue;
+
+                int64_t a = findArc(u, v);
+                // x -> u -> v and v -> u -> x improve arc (x, v)
+                exactUp[a2] = std::min(exactUp[a2], exactUp[a1] + exactUp[a]);
+                exactDown[a2] = std::min(exactDown[a2], exactDown[a] + exactDown[a1]);
+                // x -> v -> u and u -> v -> x improve arc (x, u)
+                exactUp[a1] = std::min(exactUp[a1], exactUp[a2] + exactDown[a]);
+                exactDown[a1] = std::min(exactDown[a1], exactUp[a] + exactDown[a2]);
+            }
+        }
+    }
+    auto compact = [&](const std::vector<double> &cost, const std::vector<double> &exact,
+                       QueryArcs &out) {
+        out.begin.assign(static_cast<std::size_t>(n) + 2, 0);
+        out.head.clear();
+        out.cost.clear();
+        for (int x = 1; x <= n; ++x) {
+            for (uint32_t a = arcBegin[x]; a < arcBegin[x + 1]; ++a) {
+                if (cost[a] == INF || exact[a] < cost[a]) continue;
+                out.head.push_back(arcHead[a]);
+                out.cost.push_back(cost[a]);
+            }
+            out.begin[x + 1] = static_cast<uint32_t>(out.head.size());
+        }
+    };
+    compact(upCost, exactUp, upQuery);
+    compact(downCost, exactDown, downQuery);
+
+    customizedMetric = graph.metricVersion();
+    customized = true;
+}
+
+// ---------------- QUERY ----------------
+
+std::vector<int> ContractionHierarchy::shortestPath(int src, int dest,
+                                                    SearchStats *stats) const {
+    const double INF = std::numeric_limits<double>::infinity();
+    if (stats) *stats = SearchStats{0, INF};
+    if (!built || !customized || src < 1 || src > n || dest < 1 || dest > n) return {};
+
+    thread_local QueryScratch s;
+    s.reset(n);
+
+    using State = std::pair<double, int>;
+    std::priority_queue<State, std::vector<State>, std::greater<State>> pqF, pqB;
+
+    s.touch(src);
+    s.touch(dest);
+    s.distF[src] = 0.0;
+    s.distB[dest] = 0.0;
+    pqF.push({0.0, src});
+    pqB.push({0.0, dest});
+
+    double best = INF;
+    int meet = -1;
+    int settled = 0;
+
+    // Both searches only climb the hierarchy; each stops once its queue
+    // cannot improve the best meeting point any more.
+    while (true) {
+        bool forwardLive = !pqF.empty() && pqF.top().first < best;
+        bool backwardLive = !pqB.empty() && pqB.top().first < best;
+        if (!forwardLive && !backwardLive) break;
+
+        bool forward = forwardLive && (!backwardLive || pqF.top().first <= pqB.top().first);
+        auto &pq = forward ? pqF : pqB;
+        auto &dist = forward ? s.distF : s.distB;
+        auto &other = forward ? s.distB : s.distF;
+        auto &parent = forward ? s.parentF : s.parentB;
+        const QueryArcs &arcs = forward ? upQuery : downQuery;
+        const QueryArcs &reverse = forward ? downQuery : upQuery;
+
+        auto [d, x] = pq.top();
+        pq.pop();
+        if (d > dist[x]) continue;
+        ++settled;
+
+        if (d + other[x] < best) {
+            best = d + other[x];
+            meet = x;
+        }
+
+        // Stall on demand: a higher node already reached more cheaply
+        // proves x is not on a shortest up-down path, so don't expand it
+        bool stalled = false;
+        for (uint32_t a = reverse.begin[x]; a < reverse.begin[x + 1] && !stalled; ++a) {
+            int y = static_cast<int>(reverse.head[a]);
+            s.touch(y);
+            stalled = dist[y] + reverse.cost[a] < d;
+        }
+        if (stalled) continue;
+
+        for (uint32_t a = arcs.begin[x]; a < arcs.begin[x + 1]; ++a) {
+            int y = static_cast<int>(arcs.head[a]);
+            s.touch(y);
+            double nd = d + arcs.cost[a];
+            if (nd < dist[y]) {
+                dist[y] = nd;
+                parent[y] = x;
+                pq.push({nd, y});
+            }
+        }
+    }
+
+    if (stats) *stats = SearchStats{settled, best};
+    if (meet == -1) return {};
+
+    // Upward chain src .. meet, then downward chain meet .. dest
+    std::vector<int> chain;
+    for (int v = meet; v != src; v = s.parentF[v]) chain.push_back(v);
+    std::reverse(chain.begin(), chain.end());
+
+    std::vector<int> path{src};
+    int prev = src;
+    for (int v : chain) {
+        unpackUp(prev, v, path);
+        prev = v;
+    }
+    for (int v = meet; v != dest; v = s.parentB[v]) {
+        unpackDown(s.parentB[v], v, path);
+    }
+    return path;
+}
+
+// Appends the road nodes of the arc low -> high (excluding low)
+void ContractionHierarchy::unpackUp(uint32_t low, uint32_t high,
+                                    std::vector<int> &path) const {
+    int64_t a = findArc(low, high);
+    int32_t w = upMid[a];
+    if (w < 0) {
+        path.push_back(static_cast<int>(high));
+        return;
+    }
+    unpackDown(w, low, path);   // low -> w
+    unpackUp(w, high, path);    // w -> high
+}
+
+// Appends the road nodes of the arc high -> low (excluding high)
+void ContractionHierarchy::unpackDown(uint32_t low, uint32_t high,
+                                      std::vector<int> &path) const {
+    int64_t a = findArc(low, high);
+    int32_t w = downMid[a];
+    if (w < 0) {
+        path.push_back(static_cast<int>(low));
+        return;
+    }
+    unpackDown(w, high, path);  // high -> w
+    unpackUp(w, low, path);     // w -> low
+}
+
+std::size_t ContractionHierarchy::memoryBytes() const {
+    auto queryBytes = [](const QueryArcs &q) {
+        return (q.begin.capacity() + q.head.capacity()) * sizeof(uint32_t) +
+               q.cost.capacity() * sizeof(double);
+    };
+    return queryBytes(upQuery) + queryBytes(downQuery) +
+           rank.capacity() * sizeof(uint32_t) +
+           arcBegin.capacity() * sizeof(uint32_t) +
+           arcHead.capacity() * sizeof(uint32_t) +
+           (upCost.capacity() + downCost.capacity()) * sizeof(double) +
+           (upMid.capacity() + downMid.capacity()) * sizeof(int32_t);
+}
@@ -0,0 +1,71 @@
+#ifndef CONTRACTION_HIERARCHY_H
+#define CONTRACTION_HIERARCHY_H
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "GraphManager.h"
+
+// Customizable contraction hierarchy.
+//
+// build() fixes a node order (nested dissection of the undirected road
+// topology) and the resulting shortcut structure; it depends only on
+// which roads exist. customize() then computes shortcut costs for the
+// current weights x congestion in one bottom-up pass over lower triangles,
+// so a congestion change costs a re-customization instead of a rebuild.
+//
+// Queries are two upward Dijkstra searches (with stall-on-demand) meeting
+// at the top of the hierarchy, over only the arcs that survive exact
+// customization; paths are unpacked through the middle node recorded for
+// each shortcut. Queries are safe to run concurrently, build/customize are not.
+class ContractionHierarchy {
+private:
+    int n = 0;
+    std::vector<uint32_t> rank;       // node -> position in elimination order
+
+    // Upward arcs: arcs of node x go to higher-ranked neighbours and live in
+    // [arcBegin[x], arcBegin[x + 1]), sorted by head id for lookup.
+    std::vector<uint32_t> arcBegin;
+    std::vector<uint32_t> arcHead;
+    std::vector<double> upCost;       // tail -> head (low -> high)
+    std::vector<double> downCost;     // head -> tail (high -> low)
+    std::vector<int32_t> upMid;       // middle node of the shortcut, -1 = road
+    std::vector<int32_t> downMid;
+
+    // Per-direction copies of the arcs a query can actually use: finite
+    // and not beaten by a detour through other arcs
+    struct QueryArcs {
+        std::vector<uint32_t> begin;
+        std::vector<uint32_t> head;
+        std::vector<double> cost;
+    };
+    QueryArcs upQuery, downQuery;
+
+    uint64_t builtTopology = 0;
+    uint64_t customizedMetric = 0;
+    bool built = false;
+    bool customized = false;
+
+    int64_t findArc(uint32_t low, uint32_t high) const;
+    void unpackUp(uint32_t low, uint32_t high, std::vector<int> &path) const;
+    void unpackDown(uint32_t low, uint32_t high, std::vector<int> &path) const;
+
+public:
+    void build(const GraphManager &graph);
+    void customize(const GraphManager &graph);
+
+    // Built for the graph's current road set (ignores congestion)
+    bool isCurrent(const GraphManager &graph) const {
+        return built && builtTopology == graph.topologyVersion();
+    }
+    // Shortcut costs reflect the graph's current congestion
+    bool isCustomized(const GraphManager &graph) const {
+        return isCurrent(graph) && customized &&
+               customizedMetric == graph.metricVersion();
+    }
+
+    std::vector<int> shortestPath(int src, int dest, SearchStats *stats = nullptr) const;
+
+    std::size_t arcCount() const { return arcHead.size(); }
+    std::size_t memoryBytes() const;
+};
+#endif // CONTRACTION_HIERARCHY_H
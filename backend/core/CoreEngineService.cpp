@@ -1,8 +1,12 @@
 #include "CoreEngineService.h"
+#include "SnapshotFile.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
 CoreEngineService::CoreEngineService()
     : graph(0),
       emergency(),
-      timeSeries(1440) // default: 1440 minutes (1 day)
+      timeSeries(7) // default: one week of per-minute history
 {}
 
 void CoreEngineService::loadCityGraph(const std::string &nodes,
@@ -10,16 +14,125 @@ void CoreEngineService::loadCityGraph(const std::string &nodes,
     graph.loadGraph(nodes, edges);
 }
 
+bool CoreEngineService::loadCityGraphFile(const std::string &graphFile, bool verify) {
+    return graph.loadBinaryGraph(graphFile, verify);
+}
+
 void CoreEngineService::addRoad(int u, int v, double weight, int id) {
     graph.addEdge(u, v, weight, id);
 }
 
+void CoreEngineService::freezeGraph() {
+    graph.prepareSearches();
+}
+
+void CoreEngineService::setNodeLocation(int id, double lat, double lon) {
+    graph.setNodeLocation(id, lat, lon);
+}
+
+void CoreEngineService::setSearchQueue(QueueKind kind) {
+    graph.setQueueKind(kind);
+}
+
 void CoreEngineService::reserveNodes(int n) {
     graph.reserveNodes(n);
 }
 
 std::vector<double> CoreEngineService::computeRoute(int src) {
-    return graph.dijkstra(src);
+    if (src < 1 || src > graph.nodeCount()) return graph.dijkstra(src);
+
+    graph.freeze();
+    {
+        std::shared_lock<std::shared_mutex> lk(watchLock);
+        auto it = watched.find(src);
+        if (it != watched.end() && it->second.isCurrent(graph)) return it->second.distances();
+    }
+    auto tree = routeCache.find(src, graph.topologyVersion(), graph.metricVersion());
+    if (!tree) {
+        auto fresh = std::make_shared<ShortestPathTree>();
+        fresh->source = src;
+        fresh->topology = graph.topologyVersion();
+        fresh->metric = graph.metricVersion();
+        fresh->dist = graph.dijkstra(src, &fresh->parent);
+        routeCache.insert(fresh);
+        tree = fresh;
+    }
+    return tree->dist;
+}
+
+// Cached tree of src at the current epochs, without computing one
+std::shared_ptr<const ShortestPathTree> CoreEngineService::cachedTree(int src) {
+    return routeCache.find(src, graph.topologyVersion(), graph.metricVersion());
+}
+
+RouteCacheStats CoreEngineService::routeCacheStats() const {
+    return routeCache.stats();
+}
+
+void CoreEngineService::clearRouteCache() {
+    routeCache.clear();
+}
+
+void CoreEngineService::setRouteCacheLimit(std::size_t bytes) {
+    routeCache.setCapacity(bytes);
+}
+
+ThreadPool &CoreEngineService::workers() {
+    std::lock_guard<std::mutex> lk(poolLock);
+    if (!pool) {
+        pool.reset(new ThreadPool(workerThreads));
+        poolScratch.assign(pool->size(), SearchScratch());
+    }
+    return *pool;
+}
+
+void CoreEngineService::setWorkerThreads(int threads) {
+    std::lock_guard<std::mutex> lk(poolLock);
+    workerThreads = threads;
+    pool.reset();
+    poolScratch.clear();
+}
+
+std::vector<double> CoreEngineService::computeDistanceMatrix(const std::vector<int> &sources,
+                                                             const std::vector<int> &targets) {
+    std::vector<double> matrix(sources.size() * targets.size());
+    if (matrix.empty()) return matrix;
+
+    graph.freeze();
+    ThreadPool &tp = workers();
+    tp.parallelFor(sources.size(), [&](std::size_t i, int worker) {
+        graph.distancesTo(sources[i], targets, poolScratch[worker],
+                          matrix.data() + i * targets.size());
+    });
+    return matrix;
+}
+
+std::vector<double> CoreEngineService::computeTripCosts(const std::vector<int> &sources,
+                                                       const std::vector<int> &dests) {
+    std::size_t trips = std::min(sources.size(), dests.size());
+    std::vector<double> costs(trips);
+    if (trips == 0) return costs;
+
+    graph.freeze();
+    ThreadPool &tp = workers();
+    tp.parallelFor(trips, [&](std::size_t i, int worker) {
+        if (auto tree = routeCache.peek(sources[i], graph.topologyVersion(), graph.metricVersion())) {
+            int d = dests[i];
+            costs[i] = d >= 1 && d <= graph.nodeCount()
+                           ? tree->dist[d]
+                           : std::numeric_limits<double>::infinity();
+            return;
+        }
+        std::vector<int> path;
+        SearchStats stats;
+        if (hierarchyQuery(sources[i], dests[i], path, &stats)) {
+            costs[i] = stats.cost;
+            return;
+        }
+        std::vector<int> target{dests[i]};
+        graph.distancesTo(sources[i], target, poolScratch[worker], &costs[i]);
+    });
+    return costs;
 }
 
 void CoreEngineService::addEmergencyRequest(int id,
@@ -29,6 +142,14 @@ void CoreEngineService::addEmergencyRequest(int id,
     emergency.addEmergency(id, sourceNode, type, priority);
 }
 
+bool CoreEngineService::cancelEmergency(int id) {
+    return emergency.cancel(id);
+}
+
+bool CoreEngineService::updateEmergencyPriority(int id, double priority) {
+    return emergency.updatePriority(id, priority);
+}
+
 bool CoreEngineService::hasPendingEmergency() const {
     return emergency.hasEmergency();
 }
@@ -37,22 +158,281 @@ int CoreEngineService::processNextEmergency(std::vector<double> &routeOut) {
     if (!emergency.hasEmergency()) return -1;
     EmergencyRequest req = emergency.getNextEmergency();
     // For demo: compute route from sourceNode
-    routeOut = graph.dijkstra(req.sourceNode);
+    routeOut = computeRoute(req.sourceNode);
     return req.id;
 }
 
+void CoreEngineService::addResponderUnit(int id, int node, const std::string &type) {
+    responders.addUnit(id, node, type);
+}
+
+bool CoreEngineService::setResponderAvailable(int id, bool available) {
+    return responders.setAvailable(id, available);
+}
+
+std::vector<DispatchAssignment> CoreEngineService::dispatchEmergencies() {
+    const double INF = std::numeric_limits<double>::infinity();
+    std::vector<EmergencyRequest> batch;
+    emergency.drain(emergency.size(), batch);
+
+    std::vector<DispatchAssignment> result;
+    result.reserve(batch.size());
+    for (const auto &req : batch) result.push_back({req.id, -1, req.sourceNode, INF, {}});
+    if (batch.empty()) return result;
+
+    graph.freeze();
+    int n = graph.nodeCount();
+
+    // Requests by unit type, each list in priority order
+    std::unordered_map<uint16_t, std::vector<std::size_t>> byType;
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        int node = batch[i].sourceNode;
+        if (node >= 1 && node <= n) byType[batch[i].type].push_back(i);
+    }
+
+    std::vector<double> dist;
+    std::vector<int> parent, root;
+    for (auto &group : byType) {
+        const std::string &type = emergency.typeName(group.first);
+
+        // Free units of this type by node, lowest id last-out first
+        std::unordered_map<int, std::vector<int>> freeAt;
+        for (const auto &u : responders.allUnits()) {
+            if (u.available && u.type == type && u.node >= 1 && u.node <= n)
+                freeAt[u.node].push_back(u.id);
+        }
+        if (freeAt.empty()) continue;
+
+        std::vector<int> seeds;
+        for (auto &kv : freeAt) {
+            seeds.push_back(kv.first);
+            std::sort(kv.second.begin(), kv.second.end(), std::greater<int>());
+        }
+        std::sort(seeds.begin(), seeds.end());
+        graph.nearestSources(seeds, {}, dist, parent, root);
+
+        // In priority order, each request takes the nearest unit still
+        // free. Labels only go stale in the cells of emptied unit nodes,
+        // so those are withdrawn when a request lands in one of them
+        std::vector<int> emptied;
+        for (std::size_t i : group.second) {
+            int node = batch[i].sourceNode;
+            if (dist[node] != INF && freeAt[root[node]].empty()) {
+                graph.withdrawSources(emptied, dist, parent, root);
+                emptied.clear();
+            }
+            if (dist[node] == INF) continue;          // no unit can get there
+
+            std::vector<int> &here = freeAt[root[node]];
+            int unit = here.back();
+            here.pop_back();
+            if (here.empty()) emptied.push_back(root[node]);
+            responders.setAvailable(unit, false);
+
+            DispatchAssignment &a = result[i];
+            a.unitId = unit;
+            a.cost = dist[node];
+            for (int v = node; v != root[node]; v = parent[v]) a.route.push_back(v);
+            a.route.push_back(root[node]);
+            std::reverse(a.route.begin(), a.route.end());
+        }
+    }
+
+    // Nobody could take these: back in the queue for the next dispatch,
+    // except incidents off the graph, which no unit will ever reach
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        int node = batch[i].sourceNode;
+        if (result[i].unitId < 0 && node >= 1 && node <= n) emergency.addEmergency(batch[i]);
+    }
+    return result;
+}
+
 void CoreEngineService::updateTraffic(int timeSlot, int delta) {
-    timeSeries.pointUpdate(timeSlot, delta);
+    timeSeries.add(SeriesKind::City, 0, timeSlot, delta);
+}
+
+int64_t CoreEngineService::getTrafficRange(int64_t start, int64_t end) const {
+    int64_t city = timeSeries.findSeries(SeriesKind::City, 0);
+    return city < 0 ? 0 : timeSeries.rangeSum(static_cast<uint32_t>(city), start, end);
+}
+
+SeriesAggregate CoreEngineService::getTrafficStats(int64_t start, int64_t end) const {
+    int64_t city = timeSeries.findSeries(SeriesKind::City, 0);
+    if (city < 0) return SeriesAggregate();
+    return timeSeries.aggregate(static_cast<uint32_t>(city), start, end);
+}
+
+bool CoreEngineService::recordTraffic(SeriesKind kind, int id, int64_t minute, int64_t delta) {
+    return timeSeries.add(kind, id, minute, delta);
+}
+
+int64_t CoreEngineService::getTrafficRange(SeriesKind kind, const std::vector<int> &ids,
+                                           int64_t start, int64_t end) const {
+    std::vector<uint32_t> series;
+    series.reserve(ids.size());
+    for (int id : ids) {
+        int64_t s = timeSeries.findSeries(kind, id);
+        if (s >= 0) series.push_back(static_cast<uint32_t>(s));
+    }
+    return timeSeries.rangeSum(series, start, end);
 }
 
-int CoreEngineService::getTrafficRange(int start, int end) const {
-    return timeSeries.rangeQuery(start, end);
+SeriesAggregate CoreEngineService::getTrafficStats(SeriesKind kind, const std::vector<int> &ids,
+                                                   int64_t start, int64_t end) const {
+    std::vector<uint32_t> series;
+    series.reserve(ids.size());
+    for (int id : ids) {
+        int64_t s = timeSeries.findSeries(kind, id);
+        if (s >= 0) series.push_back(static_cast<uint32_t>(s));
+    }
+    return timeSeries.aggregate(series, start, end);
 }
 
 void CoreEngineService::applyCongestionToEdge(int u, int v, double multiplier) {
+    std::unique_lock<std::shared_mutex> lk(watchLock);
     graph.setCongestion(u, v, multiplier);
+
+    repairWork = 0;
+    if (watched.empty()) return;
+    graph.freeze();
+    for (auto &kv : watched) {
+        DynamicShortestPathTree &tree = kv.second;
+        if (tree.isCurrent(graph)) continue;
+        repairWork += tree.repairEdge(graph, u, v);
+    }
+}
+
+void CoreEngineService::saveState(SnapshotWriter &out) const {
+    graph.saveCongestion(out);
+    emergency.saveState(out);
+    timeSeries.saveState(out);
+}
+
+bool CoreEngineService::readState(SnapshotReader &in, EngineState &state) const {
+    return graph.readCongestion(in, state.congestion) && state.emergency.loadState(in) &&
+           state.series.loadState(in);
+}
+
+void CoreEngineService::replaceState(EngineState &&state) {
+    std::unique_lock<std::shared_mutex> lk(watchLock);
+    graph.replaceCongestion(std::move(state.congestion));
+    emergency = std::move(state.emergency);
+    timeSeries = std::move(state.series);
+
+    // New metric epoch: cached trees, the hierarchy's customization and
+    // the travel profiles go stale on their own; watched trees start over
+    repairWork = 0;
+    if (!watched.empty()) graph.freeze();
+    for (auto &kv : watched) kv.second.reset(graph, kv.first);
+}
+
+bool CoreEngineService::loadState(SnapshotReader &in) {
+    EngineState state;
+    if (!readState(in, state)) return false;
+    replaceState(std::move(state));
+    return true;
+}
+
+void CoreEngineService::watchSource(int src) {
+    std::unique_lock<std::shared_mutex> lk(watchLock);
+    if (src < 1 || src > graph.nodeCount() || watched.count(src)) return;
+    watched[src].reset(graph, src);
+}
+
+void CoreEngineService::unwatchSource(int src) {
+    std::unique_lock<std::shared_mutex> lk(watchLock);
+    watched.erase(src);
+}
+
+std::vector<int> CoreEngineService::watchedSources() const {
+    std::shared_lock<std::shared_mutex> lk(watchLock);
+    std::vector<int> sources;
+    for (const auto &kv : watched) sources.push_back(kv.first);
+    std::sort(sources.begin(), sources.end());
+    return sources;
+}
+
+std::size_t CoreEngineService::lastRepairWork() const {
+    std::shared_lock<std::shared_mutex> lk(watchLock);
+    return repairWork;
+}
+
+void CoreEngineService::buildHierarchy() {
+    std::unique_lock<std::shared_mutex> lk(hierarchyLock);
+    hierarchy.build(graph);
+    hierarchy.customize(graph);
+}
+
+// Answers from the hierarchy if it matches the current roads, bringing its
+// shortcut costs up to date with congestion first. False means stale.
+bool CoreEngineService::hierarchyQuery(int src, int dest,
+                                       std::vector<int> &path,
+                                       SearchStats *stats) {
+    std::shared_lock<std::shared_mutex> lk(hierarchyLock);
+    if (!hierarchy.isCurrent(graph)) return false;
+
+    if (!hierarchy.isCustomized(graph)) {
+        lk.unlock();
+        {
+            std::unique_lock<std::shared_mutex> wlk(hierarchyLock);
+            if (!hierarchy.isCustomized(graph)) hierarchy.customize(graph);
+        }
+        lk.lock();
+        if (!hierarchy.isCustomized(graph)) return false;
+    }
+
+    path = hierarchy.shortestPath(src, dest, stats);
+    return true;
 }
 
 std::vector<int> CoreEngineService::computePath(int src, int dest) {
-    return graph.shortestPath(src, dest);
+    if (dest < 1 || dest > graph.nodeCount()) return {};
+    graph.freeze();
+    {
+        std::shared_lock<std::shared_mutex> lk(watchLock);
+        auto it = watched.find(src);
+        if (it != watched.end() && it->second.isCurrent(graph)) return it->second.pathTo(dest);
+    }
+    if (auto tree = cachedTree(src)) return tree->pathTo(dest);
+
+    std::vector<int> path;
+    if (hierarchyQuery(src, dest, path, nullptr)) return path;
+
+    PathAlgorithm algo = graph.hasCoordinates() ? PathAlgorithm::BidirectionalAStar
+                                                : PathAlgorithm::Dijkstra;
+    return graph.shortestPath(src, dest, algo);
+}
+
+void CoreEngineService::buildTravelProfiles(double capacity) {
+    std::unique_lock<std::shared_mutex> lk(profileLock);
+    profileCapacity = capacity;
+    travelProfiles.build(graph, timeSeries, capacity);
+}
+
+std::vector<int> CoreEngineService::computePath(int src, int dest, int departSlot,
+                                                SearchStats *stats) {
+    graph.freeze();
+    std::shared_lock<std::shared_mutex> lk(profileLock);
+    if (!travelProfiles.isCurrent(graph)) {
+        lk.unlock();
+        {
+            std::unique_lock<std::shared_mutex> wlk(profileLock);
+            if (!travelProfiles.isCurrent(graph)) {
+                travelProfiles.build(graph, timeSeries, profileCapacity);
+            }
+        }
+        lk.lock();
+    }
+    return travelProfiles.shortestPath(graph, src, dest, departSlot, stats);
+}
+
+std::vector<int> CoreEngineService::computePath(int src, int dest,
+                                                PathAlgorithm algo,
+                                                SearchStats *stats) {
+    if (algo == PathAlgorithm::Hierarchy) {
+        std::vector<int> path;
+        if (hierarchyQuery(src, dest, path, stats)) return path;
+        algo = PathAlgorithm::Dijkstra;
+    }
+    return graph.shortestPath(src, dest, algo, stats);
 }
@@ -3,31 +3,180 @@
 
 #include "GraphManager.h"
 #include "EmergencyManager.h"
+#include "ResponderRegistry.h"
 #include "TimeSeriesManager.h"
+#include "TravelTimeProfiles.h"
+#include "ContractionHierarchy.h"
+#include "ThreadPool.h"
+#include "RouteCache.h"
+#include "DynamicTree.h"
+#include <memory>
 #include <vector>
 #include <string>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+// One request of a dispatch batch. unitId is -1 (cost inf, no route) when
+// no available unit of the request's type can reach the incident.
+struct DispatchAssignment {
+    int requestId;
+    int unitId;
+    int incidentNode;
+    double cost;
+    std::vector<int> route;     // unit's node .. incidentNode
+};
+
+// Engine sections of a snapshot, read and checked by
+// CoreEngineService::readState but not yet in place
+struct EngineState {
+    CongestionState congestion;
+    EmergencyManager emergency;
+    TimeSeriesManager series;
+};
 
 class CoreEngineService {
 private:
     GraphManager graph;
     EmergencyManager emergency;
+    ResponderRegistry responders;
     TimeSeriesManager timeSeries;
+    ContractionHierarchy hierarchy;
+    // Guards re-customization against concurrent hierarchy queries
+    std::shared_mutex hierarchyLock;
+
+    bool hierarchyQuery(int src, int dest, std::vector<int> &path, SearchStats *stats);
+
+    // Per-road travel-time curves from the traffic history
+    TravelTimeProfiles travelProfiles;
+    std::shared_mutex profileLock;
+    double profileCapacity = 30.0;
+
+    // Shortest-path trees of recent sources, tagged with the graph epochs
+    RouteCache routeCache;
+    std::shared_ptr<const ShortestPathTree> cachedTree(int src);
+
+    // Trees of watched sources, repaired on every congestion change
+    std::unordered_map<int, DynamicShortestPathTree> watched;
+    mutable std::shared_mutex watchLock;
+    std::size_t repairWork = 0;
+
+    // Workers and their search buffers for many-to-many queries
+    std::unique_ptr<ThreadPool> pool;
+    std::vector<SearchScratch> poolScratch;
+    int workerThreads = 0;
+    std::mutex poolLock;
+    ThreadPool &workers();
 
 public:
     CoreEngineService();
     void reserveNodes(int n);
+    // Preprocess the loaded roads into a contraction hierarchy. Congestion
+    // changes re-customize it; adding roads makes it stale until rebuilt.
+    void buildHierarchy();
+
+    // A cached shortest-path tree of src when there is one; else the
+    // contraction hierarchy when it is current; otherwise bidirectional A*
+    // when every node has coordinates, Dijkstra if not
     std::vector<int> computePath(int src, int dest);
+    std::vector<int> computePath(int src, int dest, PathAlgorithm algo,
+                                 SearchStats *stats = nullptr);
+    // Fastest path when leaving at minute departSlot (of the traffic
+    // history's clock), over time-dependent road times; stats->cost is the
+    // travel time. Profiles are built on first use and again after roads or
+    // congestion change; call buildTravelProfiles() to pick up new history.
+    std::vector<int> computePath(int src, int dest, int departSlot,
+                                 SearchStats *stats = nullptr);
+    // capacity: vehicles per minute at which a road is 15% slower
+    void buildTravelProfiles(double capacity = 30.0);
+    const TravelTimeProfiles &travelTimeProfiles() const { return travelProfiles; }
 
     void loadCityGraph(const std::string &nodesFile, const std::string &edgesFile);
+    // Binary graph written by GraphConvert; false (and a message) on error
+    bool loadCityGraphFile(const std::string &graphFile, bool verify = true);
     void addRoad(int u, int v, double weight, int id = 0);
+    // Packs the roads and builds the search caches, so concurrent queries
+    // afterwards only read the graph
+    void freezeGraph();
+    // The road graph, for read-only searches by other modules
+    const GraphManager &roadGraph() const { return graph; }
+    void setNodeLocation(int id, double lat, double lon);
+    // Priority queue behind Dijkstra searches (default: binary heap)
+    void setSearchQueue(QueueKind kind);
+    // Distances from src; served from (and stored in) the route cache
     std::vector<double> computeRoute(int src);
+    RouteCacheStats routeCacheStats() const;
+    void clearRouteCache();
+
+    // Watched sources (e.g. ambulance depots) keep a shortest-path tree
+    // that applyCongestionToEdge repairs in place; computeRoute and
+    // computePath from them never recompute
+    void watchSource(int src);
+    void unwatchSource(int src);
+    std::vector<int> watchedSources() const;
+    // Nodes examined by the repairs of the last congestion change
+    std::size_t lastRepairWork() const;
+    void setRouteCacheLimit(std::size_t bytes);
+
+    // Travel costs from every source to every target, row-major:
+    // result[i * targets.size() + j] = cost(sources[i] -> targets[j]).
+    // One early-terminating search per source, spread over the pool.
+    std::vector<double> computeDistanceMatrix(const std::vector<int> &sources,
+                                              const std::vector<int> &targets);
+    // Cost of each trip sources[i] -> dests[i] (infinity if unreachable),
+    // answered in parallel against the frozen graph. Uses a cached tree of
+    // the source (without counting cache hits or misses), else the hierarchy when it is current, else an
+    // early-terminating Dijkstra.
+    std::vector<double> computeTripCosts(const std::vector<int> &sources,
+                                         const std::vector<int> &dests);
+    // Pool size for parallel queries (<= 0: hardware concurrency)
+    void setWorkerThreads(int threads);
 
     void addEmergencyRequest(int id, int sourceNode, const std::string &type, double priority);
+    // False if the request is not (or no longer) queued
+    bool cancelEmergency(int id);
+    bool updateEmergencyPriority(int id, double priority);
     bool hasPendingEmergency() const;
     int processNextEmergency(std::vector<double> &routeOut);
 
+    void addResponderUnit(int id, int node, const std::string &type);
+    bool setResponderAvailable(int id, bool available);
+    const ResponderRegistry &responderUnits() const { return responders; }
+    // Drains the emergency queue and sends the nearest available unit of
+    // the matching type to each request, most urgent first; assigned
+    // units become unavailable. One multi-source search per unit type
+    // labels every node with its nearest free unit; requests then take
+    // units in priority order, and a unit node that runs out of units is
+    // withdrawn from the labels before a later request needs them.
+    // Requests left without a unit (unitId -1) go back into the queue
+    // with their id and priority, except those whose node is not in the
+    // graph, which are reported once and dropped. Results are in dispatch
+    // (priority) order.
+    std::vector<DispatchAssignment> dispatchEmergencies();
+
+    // City-wide counter, minute timeSlot (day 0 = minutes 0..1439)
     void updateTraffic(int timeSlot, int delta);
-    int getTrafficRange(int start, int end) const;
+    int64_t getTrafficRange(int64_t start, int64_t end) const;
+    // Peak / minimum / mean over the minutes that have data
+    SeriesAggregate getTrafficStats(int64_t start, int64_t end) const;
+    // Per-road / intersection / parking-zone counters; the range query sums
+    // all listed ids over minutes [start, end]
+    bool recordTraffic(SeriesKind kind, int id, int64_t minute, int64_t delta);
+    int64_t getTrafficRange(SeriesKind kind, const std::vector<int> &ids,
+                            int64_t start, int64_t end) const;
+    SeriesAggregate getTrafficStats(SeriesKind kind, const std::vector<int> &ids,
+                                    int64_t start, int64_t end) const;
     void applyCongestionToEdge(int u, int v, double multiplier);
+
+    // Live state as snapshot sections (SnapshotFile.h): road congestion,
+    // the emergency queue and the traffic history. readState checks all
+    // three against this road graph without changing anything;
+    // replaceState then swaps them in together, and caches and watched
+    // trees follow the restored congestion. loadState does both.
+    // Replacing is mutating, like applyCongestionToEdge.
+    void saveState(SnapshotWriter &out) const;
+    bool readState(SnapshotReader &in, EngineState &state) const;
+    void replaceState(EngineState &&state);
+    bool loadState(SnapshotReader &in);
 };
 #endif
@@ -0,0 +1,94 @@
+// ===================== CsrGraph.cpp =====================
+#include "CsrGraph.h"
+#include <utility>
+
+CsrGraph::CsrGraph(const CsrGraph &other)
+    : offsets(other.offsets), targets(other.targets), weights(other.weights),
+      ids(other.ids), ownOffsets(other.ownOffsets), ownTargets(other.ownTargets),
+      ownWeights(other.ownWeights), ownIds(other.ownIds), backing(other.backing) {
+    if (!backing) bindOwned();
+}
+
+CsrGraph::CsrGraph(CsrGraph &&other) noexcept
+    : offsets(other.offsets), targets(other.targets), weights(other.weights),
+      ids(other.ids), ownOffsets(std::move(other.ownOffsets)),
+      ownTargets(std::move(other.ownTargets)), ownWeights(std::move(other.ownWeights)),
+      ownIds(std::move(other.ownIds)), backing(std::move(other.backing)) {
+    if (!backing) bindOwned();
+    other.clear();
+}
+
+CsrGraph &CsrGraph::operator=(CsrGraph other) noexcept {
+    offsets = other.offsets;
+    targets = other.targets;
+    weights = other.weights;
+    ids = other.ids;
+    ownOffsets.swap(other.ownOffsets);
+    ownTargets.swap(other.ownTargets);
+    ownWeights.swap(other.ownWeights);
+    ownIds.swap(other.ownIds);
+    backing.swap(other.backing);
+    if (!backing) bindOwned();
+    return *this;
+}
+
+void CsrGraph::bindOwned() {
+    offsets = ArrayView<uint32_t>(ownOffsets.data(), ownOffsets.size());
+    targets = ArrayView<uint32_t>(ownTargets.data(), ownTargets.size());
+    weights = ArrayView<float>(ownWeights.data(), ownWeights.size());
+    ids = ArrayView<int32_t>(ownIds.data(), ownIds.size());
+}
+
+void CsrGraph::build(uint32_t nodes, const std::vector<Edge> &edges) {
+    backing.reset();
+    ownOffsets.assign(static_cast<std::size_t>(nodes) + 2, 0);
+
+    // Count out-degree of every node, shifted by one so the prefix sum
+    // lands directly on the start offsets.
+    for (const auto &e : edges) {
+        ++ownOffsets[e.from + 1];
+    }
+    for (std::size_t i = 1; i < ownOffsets.size(); ++i) {
+        ownOffsets[i] += ownOffsets[i - 1];
+    }
+
+    ownTargets.assign(edges.size(), 0);
+    ownWeights.assign(edges.size(), 0.0f);
+    ownIds.assign(edges.size(), 0);
+
+    std::vector<uint32_t> cursor(ownOffsets.begin(), ownOffsets.end() - 1);
+    for (const auto &e : edges) {
+        uint32_t pos = cursor[e.from]++;
+        ownTargets[pos] = e.to;
+        ownWeights[pos] = e.weight;
+        ownIds[pos] = e.id;
+    }
+    bindOwned();
+}
+
+void CsrGraph::attach(uint32_t nodes, uint32_t edges, const uint32_t *offsetData,
+                      const uint32_t *targetData, const float *weightData,
+                      const int32_t *idData, std::shared_ptr<const void> owner) {
+    clear();
+    offsets = ArrayView<uint32_t>(offsetData, static_cast<std::size_t>(nodes) + 2);
+    targets = ArrayView<uint32_t>(targetData, edges);
+    weights = ArrayView<float>(weightData, edges);
+    ids = ArrayView<int32_t>(idData, edges);
+    backing = std::move(owner);
+}
+
+void CsrGraph::clear() {
+    std::vector<uint32_t>().swap(ownOffsets);
+    std::vector<uint32_t>().swap(ownTargets);
+    std::vector<float>().swap(ownWeights);
+    std::vector<int32_t>().swap(ownIds);
+    backing.reset();
+    bindOwned();
+}
+
+std::size_t CsrGraph::memoryBytes() const {
+    return ownOffsets.capacity() * sizeof(uint32_t) +
+           ownTargets.capacity() * sizeof(uint32_t) +
+           ownWeights.capacity() * sizeof(float) +
+           ownIds.capacity() * sizeof(int32_t);
+}
@@ -0,0 +1,85 @@
+#ifndef CSR_GRAPH_H
+#define CSR_GRAPH_H
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// One directed road as handed to GraphManager::addEdge (16 bytes, no padding)
+struct Edge {
+    uint32_t from;
+    uint32_t to;
+    float weight;
+    int32_t id;
+};
+
+// Read-only window onto a contiguous array owned elsewhere
+template <class T>
+class ArrayView {
+private:
+    const T *ptr = nullptr;
+    std::size_t len = 0;
+
+public:
+    ArrayView() = default;
+    ArrayView(const T *data, std::size_t size) : ptr(data), len(size) {}
+
+    const T &operator[](std::size_t i) const { return ptr[i]; }
+    const T *data() const { return ptr; }
+    const T *begin() const { return ptr; }
+    const T *end() const { return ptr + len; }
+    std::size_t size() const { return len; }
+    bool empty() const { return len == 0; }
+};
+
+// Frozen compressed-sparse-row adjacency.
+// The out-edges of node u live in [offsets[u], offsets[u + 1]) of the
+// targets / weights / ids arrays. Node ids are 1-based like the rest of
+// the engine, so offsets has nodeCount + 2 entries (slot 0 stays empty).
+//
+// The arrays are views: either onto vectors this graph owns (build) or
+// onto memory owned by someone else, e.g. a mapped graph file (attach),
+// which `backing` keeps alive.
+struct CsrGraph {
+    ArrayView<uint32_t> offsets;
+    ArrayView<uint32_t> targets;
+    ArrayView<float> weights;
+    ArrayView<int32_t> ids;
+
+    CsrGraph() = default;
+    CsrGraph(const CsrGraph &other);
+    CsrGraph(CsrGraph &&other) noexcept;
+    CsrGraph &operator=(CsrGraph other) noexcept;
+
+    // Build from an unordered edge list with a counting sort; keeps the
+    // insertion order of parallel edges.
+    void build(uint32_t nodes, const std::vector<Edge> &edges);
+    // Use external arrays (nodes + 2 offsets, edges entries each) without
+    // copying them
+    void attach(uint32_t nodes, uint32_t edges, const uint32_t *offsetData,
+                const uint32_t *targetData, const float *weightData,
+                const int32_t *idData, std::shared_ptr<const void> backing);
+    void clear();
+    bool isAttached() const { return backing != nullptr; }
+
+    uint32_t nodeCount() const {
+        return offsets.size() < 2 ? 0 : static_cast<uint32_t>(offsets.size() - 2);
+    }
+    uint32_t edgeCount() const { return static_cast<uint32_t>(targets.size()); }
+    uint32_t begin(uint32_t u) const { return offsets[u]; }
+    uint32_t end(uint32_t u) const { return offsets[u + 1]; }
+
+    // Bytes of heap held by the arrays (capacity, not size); attached
+    // arrays live in shared pages and are not counted
+    std::size_t memoryBytes() const;
+
+private:
+    std::vector<uint32_t> ownOffsets;
+    std::vector<uint32_t> ownTargets;
+    std::vector<float> ownWeights;
+    std::vector<int32_t> ownIds;
+    std::shared_ptr<const void> backing;
+
+    void bindOwned();
+};
+#endif // CSR_GRAPH_H
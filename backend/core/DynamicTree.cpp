@@ -0,0 +1,185 @@
+// ===================== DynamicTree.cpp =====================
+#include "DynamicTree.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+
+namespace {
+using State = std::pair<double, int>;
+using MinQueue = std::priority_queue<State, std::vector<State>, std::greater<State>>;
+}
+
+void DynamicShortestPathTree::reset(const GraphManager &graph, int source) {
+    graph.freeze();
+    const CsrGraph &csr = graph.forwardGraph();
+    const double INF = std::numeric_limits<double>::infinity();
+    int n = graph.nodeCount();
+
+    src = source;
+    topology = graph.topologyVersion();
+    metric = graph.metricVersion();
+    dist.assign(n + 1, INF);
+    parent.assign(n + 1, -1);
+    parentEdge.assign(n + 1, -1);
+    inSubtree.assign(n + 1, 0);
+    if (src < 1 || src > n) return;
+
+    MinQueue pq;
+    dist[src] = 0.0;
+    parent[src] = src;
+    pq.push({0.0, src});
+    while (!pq.empty()) {
+        auto [d, u] = pq.top();
+        pq.pop();
+        if (d > dist[u]) continue;
+        for (uint32_t i = csr.begin(u); i < csr.end(u); ++i) {
+            uint32_t to = csr.targets[i];
+            double nd = d + graph.edgeCost(i);
+            if (nd < dist[to]) {
+                dist[to] = nd;
+                parent[to] = u;
+                parentEdge[to] = i;
+                pq.push({nd, static_cast<int>(to)});
+            }
+        }
+    }
+}
+
+// ---------------- REPAIR ----------------
+
+std::size_t DynamicShortestPathTree::repairEdge(const GraphManager &graph, int u, int v) {
+    graph.freeze();
+    // Only a tree one congestion change behind knows what changed; after
+    // new roads or changes it never saw, recompute
+    if (topology != graph.topologyVersion() || metric + 1 != graph.metricVersion()) {
+        reset(graph, src);
+        return static_cast<std::size_t>(graph.nodeCount());
+    }
+    metric = graph.metricVersion();
+
+    const CsrGraph &csr = graph.forwardGraph();
+    if (u < 1 || u > graph.nodeCount() || dist[u] == std::numeric_limits<double>::infinity())
+        return 0;
+
+    std::size_t work = 0;
+    for (uint32_t i = csr.begin(u); i < csr.end(u); ++i) {
+        if (csr.targets[i] != static_cast<uint32_t>(v)) continue;
+        double through = dist[u] + graph.edgeCost(i);
+        if (through < dist[v]) {
+            work += lowered(graph, u, i);
+        } else if (parentEdge[v] == static_cast<int64_t>(i) && through > dist[v]) {
+            work += raised(graph, i);
+        }
+    }
+    return work;
+}
+
+// Road `edge` now offers a shorter way into its head: push the gain out
+std::size_t DynamicShortestPathTree::lowered(const GraphManager &graph, int u, uint32_t edge) {
+    const CsrGraph &csr = graph.forwardGraph();
+    int v = static_cast<int>(csr.targets[edge]);
+
+    MinQueue pq;
+    dist[v] = dist[u] + graph.edgeCost(edge);
+    parent[v] = u;
+    parentEdge[v] = edge;
+    pq.push({dist[v], v});
+
+    std::size_t work = 0;
+    while (!pq.empty()) {
+        auto [d, x] = pq.top();
+        pq.pop();
+        if (d > dist[x]) continue;
+        ++work;
+        for (uint32_t i = csr.begin(x); i < csr.end(x); ++i) {
+            uint32_t to = csr.targets[i];
+            double nd = d + graph.edgeCost(i);
+            if (nd < dist[to]) {
+                dist[to] = nd;
+                parent[to] = x;
+                parentEdge[to] = i;
+                pq.push({nd, static_cast<int>(to)});
+            }
+        }
+    }
+    return work;
+}
+
+// Tree road `edge` got dearer: re-settle the subtree below its head
+std::size_t DynamicShortestPathTree::raised(const GraphManager &graph, uint32_t edge) {
+    const CsrGraph &csr = graph.forwardGraph();
+    const CsrGraph &rev = graph.reverseGraph();
+    const double INF = std::numeric_limits<double>::infinity();
+    int v = static_cast<int>(csr.targets[edge]);
+
+    // Subtree of v: children of x are heads of x's out-roads whose tree
+    // edge is that very road
+    subtree.clear();
+    subtree.push_back(v);
+    inSubtree[v] = 1;
+    for (std::size_t k = 0; k < subtree.size(); ++k) {
+        int x = subtree[k];
+        for (uint32_t i = csr.begin(x); i < csr.end(x); ++i) {
+            int to = static_cast<int>(csr.targets[i]);
+            if (!inSubtree[to] && parentEdge[to] == static_cast<int64_t>(i)) {
+                inSubtree[to] = 1;
+                subtree.push_back(to);
+            }
+        }
+    }
+
+    // Seed every subtree node from its cheapest in-road outside the subtree
+    MinQueue pq;
+    for (int x : subtree) {
+        dist[x] = INF;
+        parent[x] = -1;
+        parentEdge[x] = -1;
+    }
+    for (int x : subtree) {
+        for (uint32_t r = rev.begin(x); r < rev.end(x); ++r) {
+            int from = static_cast<int>(rev.targets[r]);
+            if (inSubtree[from] || dist[from] == INF) continue;
+            uint32_t i = static_cast<uint32_t>(rev.ids[r]);
+            double nd = dist[from] + graph.edgeCost(i);
+            if (nd < dist[x]) {
+                dist[x] = nd;
+                parent[x] = from;
+                parentEdge[x] = i;
+            }
+        }
+        if (dist[x] < INF) pq.push({dist[x], x});
+    }
+
+    // Settle them; nodes outside the subtree keep their distances
+    std::size_t work = subtree.size();
+    while (!pq.empty()) {
+        auto [d, x] = pq.top();
+        pq.pop();
+        if (d > dist[x]) continue;
+        for (uint32_t i = csr.begin(x); i < csr.end(x); ++i) {
+            uint32_t to = csr.targets[i];
+            if (!inSubtree[to]) continue;
+            double nd = d + graph.edgeCost(i);
+            if (nd < dist[to]) {
+                dist[to] = nd;
+                parent[to] = x;
+                parentEdge[to] = i;
+                pq.push({nd, static_cast<int>(to)});
+            }
+        }
+    }
+
+    for (int x : subtree) inSubtree[x] = 0;
+    return work;
+}
+
+std::vector<int> DynamicShortestPathTree::pathTo(int dest) const {
+    if (dest < 1 || dest >= static_cast<int>(parent.size()) || parent[dest] == -1) return {};
+
+    std::vector<int> path;
+    for (int x = dest; x != src; x = parent[x]) path.push_back(x);
+    path.push_back(src);
+    std::reverse(path.begin(), path.end());
+    return path;
+}
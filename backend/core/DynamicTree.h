@@ -0,0 +1,51 @@
+#ifndef DYNAMIC_TREE_H
+#define DYNAMIC_TREE_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "GraphManager.h"
+
+// Shortest-path tree of one source that follows congestion changes by
+// repair instead of recomputation (Ramalingam-Reps style):
+//  - a road got cheaper: relax it and run Dijkstra outward from its head,
+//    touching only nodes whose distance drops;
+//  - a tree road got dearer: only the subtree hanging below it can change.
+//    Its nodes are re-seeded from their best in-edge outside the subtree
+//    and settled by a Dijkstra confined to it.
+// Roads that are neither improved nor on the tree cost nothing.
+class DynamicShortestPathTree {
+private:
+    int src = 0;
+    uint64_t topology = 0;
+    uint64_t metric = 0;
+    std::vector<double> dist;
+    std::vector<int> parent;          // previous node, src -> src, -1 unreached
+    std::vector<int64_t> parentEdge;  // forward CSR edge into the node, -1 none
+
+    // Scratch reused between repairs
+    std::vector<char> inSubtree;
+    std::vector<int> subtree;
+
+    std::size_t lowered(const GraphManager &graph, int u, uint32_t edge);
+    std::size_t raised(const GraphManager &graph, uint32_t edge);
+
+public:
+    // Full Dijkstra from source on the graph as it is now
+    void reset(const GraphManager &graph, int source);
+
+    // Brings the tree up to date after the cost of the road(s) u -> v
+    // changed in graph, which must be the only change since the tree was
+    // last current; otherwise it is recomputed. Returns the number of nodes
+    // examined, the repair's unit of work (a recompute counts every node).
+    std::size_t repairEdge(const GraphManager &graph, int u, int v);
+
+    // Computed for the graph's current roads and congestion
+    bool isCurrent(const GraphManager &graph) const {
+        return topology == graph.topologyVersion() && metric == graph.metricVersion();
+    }
+
+    int source() const { return src; }
+    const std::vector<double> &distances() const { return dist; }
+    std::vector<int> pathTo(int dest) const;
+};
+#endif // DYNAMIC_TREE_H
@@ -1,29 +1,241 @@
 #include "EmergencyManager.h"
+#include "SnapshotFile.h"
 #include <stdexcept>
-void EmergencyManager::addEmergency(int id,
+
+// ---------------- HEAP ----------------
+
+void EmergencyManager::place(std::size_t i, const HeapEntry &e) {
+    heap[i] = e;
+    heapPos[e.slot] = static_cast<uint32_t>(i);
+}
+
+void EmergencyManager::siftUp(std::size_t i) {
+    HeapEntry e = heap[i];
+    while (i > 0) {
+        std::size_t up = (i - 1) / 4;
+        if (!before(e, heap[up])) break;
+        place(i, heap[up]);
+        i = up;
+    }
+    place(i, e);
+}
+
+void EmergencyManager::siftDown(std::size_t i) {
+    HeapEntry e = heap[i];
+    std::size_t size = heap.size();
+    for (;;) {
+        std::size_t first = 4 * i + 1;
+        if (first >= size) break;
+        std::size_t best = first;
+        std::size_t stop = first + 4 < size ? first + 4 : size;
+        for (std::size_t c = first + 1; c < stop; ++c) {
+            if (before(heap[c], heap[best])) best = c;
+        }
+        if (!before(heap[best], e)) break;
+        place(i, heap[best]);
+        i = best;
+    }
+    place(i, e);
+}
+
+// Drops heap[i] and frees its slot
+void EmergencyManager::removeAt(std::size_t i) {
+    uint32_t slot = heap[i].slot;
+    slotOf.erase(heap[i].id);
+    freeSlots.push_back(slot);
+
+    HeapEntry tail = heap.back();
+    heap.pop_back();
+    if (i == heap.size()) return;
+    place(i, tail);
+    siftDown(i);
+    siftUp(heapPos[tail.slot]);
+}
+
+// ---------------- REQUESTS ----------------
+
+bool EmergencyManager::addEmergency(int id,
                                     int sourceNode,
                                     const std::string &type,
                                     double priority) {
-    EmergencyRequest req;
-    req.id = id;
-    req.sourceNode = sourceNode;
-    req.type = type;
-    req.priority = priority;
+    return addEmergency({id, sourceNode, internType(type), priority});
+}
+
+bool EmergencyManager::addEmergency(const EmergencyRequest &request) {
+    int id = request.id;
+    auto it = slotOf.find(id);
+    if (it != slotOf.end()) {
+        EmergencyRequest &req = slots[it->second];
+        req.sourceNode = request.sourceNode;
+        req.type = request.type;
+        updatePriority(id, request.priority);
+        return false;
+    }
+
+    uint32_t slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(slots.size());
+        slots.emplace_back();
+        heapPos.push_back(0);
+    }
+    slots[slot] = request;
+    slotOf[id] = slot;
+
+    heap.push_back({request.priority, id, slot});
+    siftUp(heap.size() - 1);
+    return true;
+}
+
+bool EmergencyManager::cancel(int id) {
+    auto it = slotOf.find(id);
+    if (it == slotOf.end()) return false;
+    removeAt(heapPos[it->second]);
+    return true;
+}
+
+bool EmergencyManager::updatePriority(int id, double priority) {
+    auto it = slotOf.find(id);
+    if (it == slotOf.end()) return false;
 
-    pq.push(req);
+    uint32_t slot = it->second;
+    std::size_t i = heapPos[slot];
+    slots[slot].priority = priority;
+    heap[i].priority = priority;
+    siftUp(i);
+    siftDown(heapPos[slot]);
+    return true;
 }
+
 bool EmergencyManager::hasEmergency() const {
-    return !pq.empty();
+    return !heap.empty();
 }
 
-EmergencyRequest EmergencyManager::peekEmergency() const {
-    if (pq.empty()) throw std::runtime_error("No emergencies to peek.");
-    return pq.top();
+const EmergencyRequest &EmergencyManager::peekEmergency() const {
+    if (heap.empty()) throw std::runtime_error("No emergencies to peek.");
+    return slots[heap[0].slot];
 }
 
 EmergencyRequest EmergencyManager::getNextEmergency() {
-    if (pq.empty()) throw std::runtime_error("No emergencies available.");
-    EmergencyRequest top = pq.top();
-    pq.pop();
+    if (heap.empty()) throw std::runtime_error("No emergencies available.");
+    EmergencyRequest top = slots[heap[0].slot];
+    removeAt(0);
     return top;
 }
+
+std::size_t EmergencyManager::drain(std::size_t k, std::vector<EmergencyRequest> &out) {
+    std::size_t moved = 0;
+    for (; moved < k && !heap.empty(); ++moved) {
+        out.push_back(slots[heap[0].slot]);
+        removeAt(0);
+    }
+    return moved;
+}
+
+// ---------------- TYPES ----------------
+
+uint16_t EmergencyManager::internType(const std::string &name) {
+    auto it = typeIds.find(name);
+    if (it != typeIds.end()) return it->second;
+    if (typeNames.size() > UINT16_MAX) throw std::runtime_error("Too many emergency types.");
+    uint16_t t = static_cast<uint16_t>(typeNames.size());
+    typeNames.push_back(name);
+    typeIds.emplace(name, t);
+    return t;
+}
+
+int EmergencyManager::findType(const std::string &name) const {
+    auto it = typeIds.find(name);
+    return it == typeIds.end() ? -1 : it->second;
+}
+
+// ---------------- SNAPSHOT ----------------
+
+namespace {
+constexpr uint32_t EMERGENCY_VERSION = 2;   // 2: slots as columns
+}
+
+void EmergencyManager::saveState(SnapshotWriter &out) const {
+    out.beginSection(SNAPSHOT_EMERGENCIES, EMERGENCY_VERSION);
+    out.putArray(heap);
+    // Slots field by field: EmergencyRequest's padding must not reach
+    // the file
+    std::vector<int> id(slots.size()), node(slots.size());
+    std::vector<uint16_t> type(slots.size());
+    std::vector<double> priority(slots.size());
+    for (std::size_t i = 0; i < slots.size(); ++i) {
+        id[i] = slots[i].id;
+        node[i] = slots[i].sourceNode;
+        type[i] = slots[i].type;
+        priority[i] = slots[i].priority;
+    }
+    out.putArray(id);
+    out.putArray(node);
+    out.putArray(type);
+    out.putArray(priority);
+    out.putArray(heapPos);
+    out.putArray(freeSlots);
+    out.putStrings(typeNames);
+    out.endSection();
+}
+
+bool EmergencyManager::loadState(SnapshotReader &in) {
+    uint32_t version = 0;
+    std::vector<HeapEntry> h;
+    std::vector<int> id, node;
+    std::vector<uint16_t> type;
+    std::vector<double> priority;
+    std::vector<uint32_t> pos, spare;
+    std::vector<std::string> names;
+    if (!in.enter(SNAPSHOT_EMERGENCIES, EMERGENCY_VERSION, version)) return false;
+    if (version < 2) return in.fail("emergency queue section is from an older build");
+    if (!in.getArray(h) || !in.getArray(id) || !in.getArray(node) || !in.getArray(type) ||
+        !in.getArray(priority) || !in.getArray(pos) || !in.getArray(spare) || !in.getStrings(names)) {
+        return false;
+    }
+    if (node.size() != id.size() || type.size() != id.size() || priority.size() != id.size() ||
+        pos.size() != id.size() || names.size() > UINT16_MAX + 1u) {
+        return in.fail("emergency queue arrays do not match");
+    }
+    std::vector<EmergencyRequest> s(id.size());
+    for (std::size_t i = 0; i < s.size(); ++i) s[i] = {id[i], node[i], type[i], priority[i]};
+    // Every slot is either queued once or free once, each id is queued
+    // once, and the heap is in order; otherwise later pushes and pops
+    // would overwrite or lose requests
+    if (h.size() + spare.size() != s.size()) {
+        return in.fail("emergency slots are not all queued or free");
+    }
+    std::vector<char> used(s.size(), 0);
+    std::unordered_map<int, uint32_t> ids;
+    ids.reserve(h.size());
+    for (std::size_t i = 0; i < h.size(); ++i) {
+        uint32_t slot = h[i].slot;
+        if (slot >= s.size() || used[slot] || pos[slot] != i || s[slot].id != h[i].id ||
+            s[slot].priority != h[i].priority || s[slot].type >= names.size()) {
+            return in.fail("emergency queue entry " + std::to_string(i) + " is inconsistent");
+        }
+        if (i > 0 && before(h[i], h[(i - 1) / 4])) {
+            return in.fail("emergency queue is out of heap order at entry " + std::to_string(i));
+        }
+        if (!ids.emplace(h[i].id, slot).second) {
+            return in.fail("emergency " + std::to_string(h[i].id) + " is queued twice");
+        }
+        used[slot] = 1;
+    }
+    for (uint32_t slot : spare) {
+        if (slot >= s.size() || used[slot]) return in.fail("free emergency slot out of range or in use");
+        used[slot] = 1;
+    }
+
+    heap.swap(h);
+    slots.swap(s);
+    heapPos.swap(pos);
+    freeSlots.swap(spare);
+    slotOf.swap(ids);
+    typeNames.swap(names);
+    typeIds.clear();
+    for (std::size_t t = 0; t < typeNames.size(); ++t) typeIds[typeNames[t]] = static_cast<uint16_t>(t);
+    return true;
+}
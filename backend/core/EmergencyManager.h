@@ -1,39 +1,81 @@
 #ifndef EMERGENCY_MANAGER_H
 #define EMERGENCY_MANAGER_H
-#include <queue>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <unordered_map>
 #include <vector>
-#include <functional>
 
-struct EmergencyRequest {
-    int id;                 
-    int sourceNode;         
-    std::string type;       
-    double priority;       
-};
+class SnapshotWriter;
+class SnapshotReader;
 
-struct EmergencyCompare {
-    bool operator()(const EmergencyRequest &a,
-                    const EmergencyRequest &b) const {
-        if (a.priority == b.priority)
-            return a.id > b.id; 
-        return a.priority > b.priority;    
-    }
+// Lower priority value = more urgent; equal priorities go by lower id.
+// type is an interned id, see EmergencyManager::typeName().
+struct EmergencyRequest {
+    int id;
+    int sourceNode;
+    uint16_t type;
+    double priority;
 };
 
+// Queue of pending emergencies: an indexed 4-ary heap keyed by request id,
+// so a queued request can be cancelled or re-prioritized in O(log n).
+// Requests are stored once, in slots; the heap holds their keys.
 class EmergencyManager {
 private:
-    std::priority_queue<
-        EmergencyRequest,
-        std::vector<EmergencyRequest>,
-        EmergencyCompare
-    > pq;
+    struct HeapEntry {
+        double priority;
+        int id;
+        uint32_t slot;
+    };
+
+    std::vector<HeapEntry> heap;
+    std::vector<EmergencyRequest> slots;
+    std::vector<uint32_t> heapPos;          // slot -> position in heap
+    std::vector<uint32_t> freeSlots;
+    std::unordered_map<int, uint32_t> slotOf; // request id -> slot
+
+    std::vector<std::string> typeNames;
+    std::unordered_map<std::string, uint16_t> typeIds;
+
+    static bool before(const HeapEntry &a, const HeapEntry &b) {
+        if (a.priority == b.priority) return a.id < b.id;
+        return a.priority < b.priority;
+    }
+    void place(std::size_t i, const HeapEntry &e);
+    void siftUp(std::size_t i);
+    void siftDown(std::size_t i);
+    void removeAt(std::size_t i);
 
 public:
     EmergencyManager() = default;
-    void addEmergency(int id, int sourceNode, const std::string &type, double priority);
+
+    // Queues a request; an id that is already queued is updated in place
+    // (node, type, priority). Returns true for a new request.
+    bool addEmergency(int id, int sourceNode, const std::string &type, double priority);
+    // Same, for a request taken off this queue (type already interned)
+    bool addEmergency(const EmergencyRequest &request);
+    bool cancel(int id);
+    bool updatePriority(int id, double priority);
+    bool contains(int id) const { return slotOf.count(id) != 0; }
+
     bool hasEmergency() const;
-    EmergencyRequest peekEmergency() const;
+    std::size_t size() const { return heap.size(); }
+    const EmergencyRequest &peekEmergency() const;
     EmergencyRequest getNextEmergency();
+    // Pops up to k most urgent requests, in order, onto the end of out;
+    // returns how many were moved
+    std::size_t drain(std::size_t k, std::vector<EmergencyRequest> &out);
+
+    // ----------- TYPES -----------
+    uint16_t internType(const std::string &name);
+    // -1 if the name was never queued
+    int findType(const std::string &name) const;
+    const std::string &typeName(uint16_t type) const { return typeNames[type]; }
+
+    // ----------- SNAPSHOT -----------
+    // The queue as is (heap order and slots); loading replaces it
+    void saveState(SnapshotWriter &out) const;
+    bool loadState(SnapshotReader &in);
 };
 #endif // EMERGENCY_MANAGER_H
@@ -0,0 +1,244 @@
+// ===================== GraphFile.cpp =====================
+#include "GraphFile.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char MAGIC[8] = {'C', 'I', 'T', 'Y', 'G', 'R', 'P', 'H'};
+const uint32_t ENDIAN_MARK = 0x01020304;
+
+uint64_t alignUp(uint64_t at) { return (at + 63) & ~static_cast<uint64_t>(63); }
+
+// FNV-1a over 8-byte words (sections are padded to 64 bytes, so the body
+// is a whole number of words)
+uint64_t checksumOf(const unsigned char *data, std::size_t bytes) {
+    uint64_t h = 1469598103934665603ULL;
+    std::size_t words = bytes / 8;
+    for (std::size_t i = 0; i < words; ++i) {
+        uint64_t w;
+        std::memcpy(&w, data + i * 8, 8);
+        h = (h ^ w) * 1099511628211ULL;
+    }
+    for (std::size_t i = words * 8; i < bytes; ++i) {
+        h = (h ^ data[i]) * 1099511628211ULL;
+    }
+    return h;
+}
+
+} // namespace
+
+// ---------------- MAPPING ----------------
+
+std::shared_ptr<MappedFile> MappedFile::open(const std::string &path, bool populate) {
+    std::shared_ptr<MappedFile> file(new MappedFile());
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return nullptr;
+    }
+    int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    if (populate) flags |= MAP_POPULATE;
+#endif
+    void *p = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, flags, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return nullptr;
+    file->base = static_cast<const unsigned char *>(p);
+    file->length = static_cast<std::size_t>(st.st_size);
+    file->mapped = true;
+#else
+    (void)populate;              // read in whole anyway
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) return nullptr;
+    std::streamsize size = in.tellg();
+    if (size <= 0) return nullptr;
+    file->buffer.resize(static_cast<std::size_t>(size));
+    in.seekg(0);
+    if (!in.read(reinterpret_cast<char *>(file->buffer.data()), size)) return nullptr;
+    file->base = file->buffer.data();
+    file->length = file->buffer.size();
+#endif
+    return file;
+}
+
+MappedFile::~MappedFile() {
+#ifndef _WIN32
+    if (mapped) munmap(const_cast<unsigned char *>(base), length);
+#endif
+}
+
+// ---------------- READ ----------------
+
+bool openGraphFile(const std::string &path, GraphFileView &view,
+                   std::string &error, bool verify) {
+    std::shared_ptr<MappedFile> file = MappedFile::open(path);
+    if (!file) {
+        error = "cannot open " + path;
+        return false;
+    }
+    if (file->size() < sizeof(GraphFileHeader)) {
+        error = "file too short for a header";
+        return false;
+    }
+
+    GraphFileHeader h;
+    std::memcpy(&h, file->data(), sizeof h);
+    if (std::memcmp(h.magic, MAGIC, sizeof MAGIC) != 0) {
+        error = "not a CitySense graph file";
+        return false;
+    }
+    if (h.byteOrder != ENDIAN_MARK) {
+        error = "graph file was written with the other byte order";
+        return false;
+    }
+    if (h.version != GRAPH_FILE_VERSION) {
+        error = "unsupported graph file version " + std::to_string(h.version);
+        return false;
+    }
+    if (h.fileBytes != file->size()) {
+        error = "file size does not match the header (truncated?)";
+        return false;
+    }
+
+    // Every section must be aligned and inside the file
+    uint64_t nodeSlots = static_cast<uint64_t>(h.nodes) + 2;
+    auto fits = [&](uint64_t at, uint64_t bytes) {
+        return at % 64 == 0 && at >= sizeof(GraphFileHeader) && at <= h.fileBytes &&
+               bytes <= h.fileBytes - at;
+    };
+    bool coords = (h.flags & GRAPH_FILE_COORDINATES) != 0;
+    if (!fits(h.offsetsAt, nodeSlots * 4) || !fits(h.targetsAt, h.edges * 4ULL) ||
+        !fits(h.weightsAt, h.edges * 4ULL) || !fits(h.idsAt, h.edges * 4ULL) ||
+        (coords && (!fits(h.latAt, (h.nodes + 1ULL) * 4) || !fits(h.lonAt, (h.nodes + 1ULL) * 4)))) {
+        error = "section outside the file";
+        return false;
+    }
+
+    const unsigned char *base = file->data();
+    if (verify &&
+        checksumOf(base + sizeof(GraphFileHeader), file->size() - sizeof(GraphFileHeader)) != h.checksum) {
+        error = "checksum mismatch";
+        return false;
+    }
+
+    // Searches index by these without checks, so the arrays are checked
+    // once here, whether or not the checksum was
+    const uint32_t *offsets = reinterpret_cast<const uint32_t *>(base + h.offsetsAt);
+    if (offsets[nodeSlots - 1] != h.edges) {
+        error = "offsets do not end at the edge count";
+        return false;
+    }
+    for (uint64_t u = 1; u < nodeSlots; ++u) {
+        if (offsets[u] < offsets[u - 1]) {
+            error = "offsets decrease at node " + std::to_string(u);
+            return false;
+        }
+    }
+    const uint32_t *targets = reinterpret_cast<const uint32_t *>(base + h.targetsAt);
+    const float *weights = reinterpret_cast<const float *>(base + h.weightsAt);
+    for (uint64_t i = 0; i < h.edges; ++i) {
+        if (targets[i] < 1 || targets[i] > h.nodes) {
+            error = "edge " + std::to_string(i) + " leads to a node outside the graph";
+            return false;
+        }
+        if (!(weights[i] >= 0.0f) || std::isinf(weights[i])) {
+            error = "edge " + std::to_string(i) + " has a negative or non-finite weight";
+            return false;
+        }
+    }
+
+    view.header = h;
+    view.lat = coords ? reinterpret_cast<const float *>(base + h.latAt) : nullptr;
+    view.lon = coords ? reinterpret_cast<const float *>(base + h.lonAt) : nullptr;
+    view.csr.attach(h.nodes, h.edges, offsets, targets, weights,
+                    reinterpret_cast<const int32_t *>(base + h.idsAt), file);
+    return true;
+}
+
+// ---------------- WRITE ----------------
+
+bool writeGraphFile(const std::string &path, const CsrGraph &csr,
+                    const std::vector<float> &lat, const std::vector<float> &lon,
+                    std::string &error) {
+    uint32_t nodes = csr.nodeCount();
+    uint32_t edges = csr.edgeCount();
+    bool coords = !lat.empty() && lat.size() == nodes + 1ULL && lon.size() == nodes + 1ULL;
+
+    GraphFileHeader h;
+    std::memset(&h, 0, sizeof h);
+    std::memcpy(h.magic, MAGIC, sizeof MAGIC);
+    h.version = GRAPH_FILE_VERSION;
+    h.byteOrder = ENDIAN_MARK;
+    h.flags = coords ? GRAPH_FILE_COORDINATES : 0;
+    h.nodes = nodes;
+    h.edges = edges;
+
+    uint64_t at = alignUp(sizeof h);
+    auto section = [&](uint64_t bytes) {
+        uint64_t start = at;
+        at = alignUp(at + bytes);
+        return start;
+    };
+    h.offsetsAt = section((nodes + 2ULL) * 4);
+    h.targetsAt = section(edges * 4ULL);
+    h.weightsAt = section(edges * 4ULL);
+    h.idsAt = section(edges * 4ULL);
+    if (coords) {
+        h.latAt = section((nodes + 1ULL) * 4);
+        h.lonAt = section((nodes + 1ULL) * 4);
+    }
+    h.fileBytes = at;
+
+    // Assemble the body in memory: the checksum goes in the header
+    std::vector<unsigned char> body(h.fileBytes - sizeof h, 0);
+    auto put = [&](uint64_t offset, const void *src, std::size_t bytes) {
+        if (bytes) std::memcpy(body.data() + (offset - sizeof h), src, bytes);
+    };
+    put(h.offsetsAt, csr.offsets.data(), csr.offsets.size() * 4);
+    put(h.targetsAt, csr.targets.data(), edges * 4ULL);
+    put(h.weightsAt, csr.weights.data(), edges * 4ULL);
+    put(h.idsAt, csr.ids.data(), edges * 4ULL);
+    if (coords) {
+        put(h.latAt, lat.data(), lat.size() * 4);
+        put(h.lonAt, lon.data(), lon.size() * 4);
+    }
+    h.checksum = checksumOf(body.data(), body.size());
+
+    // Write beside the target and rename, so readers never map a half file
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            error = "cannot write " + tmp;
+            return false;
+        }
+        out.write(reinterpret_cast<const char *>(&h), sizeof h);
+        out.write(reinterpret_cast<const char *>(body.data()),
+                  static_cast<std::streamsize>(body.size()));
+        if (!out) {
+            error = "write failed for " + tmp;
+            return false;
+        }
+    }
+#ifdef _WIN32
+    std::remove(path.c_str());       // rename does not replace there
+#endif
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        error = "cannot rename " + tmp + " to " + path;
+        return false;
+    }
+    return true;
+}
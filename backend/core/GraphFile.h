@@ -0,0 +1,82 @@
+#ifndef GRAPH_FILE_H
+#define GRAPH_FILE_H
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "CsrGraph.h"
+
+// Binary road graph, laid out so the arrays can be used straight from a
+// read-only mapping:
+//
+//   GraphFileHeader (128 bytes)
+//   offsets  uint32 x (nodes + 2)
+//   targets  uint32 x edges
+//   weights  float  x edges
+//   ids      int32  x edges
+//   lat, lon float  x (nodes + 1)      only with GRAPH_FILE_COORDINATES
+//
+// Every section starts on a 64-byte boundary; the header records where.
+// Values are in host byte order, byteOrder tells a mismatched reader.
+// checksum covers every byte after the header.
+constexpr uint32_t GRAPH_FILE_VERSION = 1;
+constexpr uint32_t GRAPH_FILE_COORDINATES = 1u << 0;
+
+struct GraphFileHeader {
+    char magic[8];                 // "CITYGRPH"
+    uint32_t version;
+    uint32_t byteOrder;            // 0x01020304 as written
+    uint32_t flags;
+    uint32_t nodes;
+    uint32_t edges;
+    uint32_t reserved0;
+    uint64_t offsetsAt;            // byte positions of the sections
+    uint64_t targetsAt;
+    uint64_t weightsAt;
+    uint64_t idsAt;
+    uint64_t latAt;
+    uint64_t lonAt;
+    uint64_t fileBytes;
+    uint64_t checksum;
+    uint8_t reserved[32];
+};
+static_assert(sizeof(GraphFileHeader) == 128, "graph file header must stay 128 bytes");
+
+// Whole file mapped read-only (read into memory where mmap is unavailable)
+class MappedFile {
+private:
+    const unsigned char *base = nullptr;
+    std::size_t length = 0;
+    bool mapped = false;
+    std::vector<unsigned char> buffer;
+
+public:
+    // populate: fault every page in up front (one pass over the file)
+    // instead of on first touch
+    static std::shared_ptr<MappedFile> open(const std::string &path, bool populate = false);
+    ~MappedFile();
+
+    const unsigned char *data() const { return base; }
+    std::size_t size() const { return length; }
+};
+
+// A validated graph file. csr is attached to the mapping; lat / lon point
+// into it too (nullptr without coordinates).
+struct GraphFileView {
+    GraphFileHeader header{};
+    CsrGraph csr;
+    const float *lat = nullptr;
+    const float *lon = nullptr;
+};
+
+// Checks magic, version, byte order, section bounds and (when verify) the
+// checksum. On failure returns false with a reason in error.
+bool openGraphFile(const std::string &path, GraphFileView &view,
+                   std::string &error, bool verify = true);
+
+// lat / lon: nodes + 1 entries each, or empty to omit coordinates
+bool writeGraphFile(const std::string &path, const CsrGraph &csr,
+                    const std::vector<float> &lat, const std::vector<float> &lon,
+                    std::string &error);
+#endif // GRAPH_FILE_H
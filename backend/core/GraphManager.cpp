@@ -1,11 +1,13 @@
 // ===================== GraphManager.cpp =====================
 #include "GraphManager.h"
+#include "GraphFile.h"
+#include "LineReader.h"
+#include "SnapshotFile.h"
 #include <queue>
-#include <fstream>
-#include <sstream>
 #include <limits>
 #include <iostream>
 #include <algorithm>
+#include <cmath>
 
 GraphManager::GraphManager(int nodes) {
     reserveNodes(nodes);
@@ -13,73 +15,329 @@ GraphManager::GraphManager(int nodes) {
 
 void GraphManager::reserveNodes(int nodes) {
     n = std::max(0, nodes);
-    adj.assign(n + 1, {});
-    adjMatrix.assign(n + 1, std::vector<double>(n + 1,
-                      std::numeric_limits<double>::infinity()));
-    for (int i = 1; i <= n; ++i) {
-        adjMatrix[i][i] = 0.0;
-    }
+    pending.clear();
+    csr.clear();
+    reverseCsr.clear();
+    edgeCongestion.clear();
+    frozen = false;
+    lat.clear();
+    lon.clear();
+    heuristicScale = -1.0;
+    coordinatesComplete = -1;
+    ++topologyEpoch;
 }
 
 void GraphManager::addEdge(int u, int v, double w, int id) {
     if (u <= 0 || v <= 0) return;
-    int maxNode = std::max(u, v);
-    if (maxNode > n) {
-        // Expand graph if needed
-        reserveNodes(maxNode);
+    thaw();
+
+    // Grow the node range without dropping roads added so far
+    if (std::max(u, v) > n) {
+        n = std::max(u, v);
+        coordinatesComplete = -1;
     }
+    heuristicScale = -1.0;
+    ++topologyEpoch;
+
+    pending.push_back({static_cast<uint32_t>(u), static_cast<uint32_t>(v),
+                       static_cast<float>(w), static_cast<int32_t>(id)});
+}
 
-    adj[u].push_back({v, w, id});
+void GraphManager::thaw() {
+    if (!frozen) return;
 
-    if (u >= 0 && u < (int)adjMatrix.size() &&
-        v >= 0 && v < (int)adjMatrix.size()) {
-        adjMatrix[u][v] = std::min(adjMatrix[u][v], w);
+    pending.clear();
+    pending.reserve(csr.edgeCount());
+    for (uint32_t u = 1; u <= csr.nodeCount(); ++u) {
+        for (uint32_t i = csr.begin(u); i < csr.end(u); ++i) {
+            pending.push_back({u, csr.targets[i], csr.weights[i], csr.ids[i]});
+        }
     }
+    csr.clear();
+    reverseCsr.clear();
+    edgeCongestion.clear();
+    frozen = false;
+    heuristicScale = -1.0;
+    coordinatesComplete = -1;
 }
 
-void GraphManager::loadGraph(const std::string &nodeFile, const std::string &edgeFile) {
-    // Determine number of nodes from node file (assuming each line has an ID)
-    std::ifstream nf(nodeFile);
-    int maxId = 0;
-    if (nf) {
-        std::string line;
-        while (std::getline(nf, line)) {
-            if (line.empty()) continue;
-            std::istringstream iss(line);
-            int id;
-            if (iss >> id) {
-                maxId = std::max(maxId, id);
+void GraphManager::freeze() const {
+    if (frozen) return;
+
+    csr.build(static_cast<uint32_t>(n), pending);
+    std::vector<Edge>().swap(pending);
+    frozen = true;
+    indexFrozen();
+}
+
+// Derived per-edge data for a freshly frozen csr
+void GraphManager::indexFrozen() const {
+    minEdgeWeight = maxEdgeWeight = 0.0;
+    if (!csr.weights.empty()) {
+        auto range = std::minmax_element(csr.weights.begin(), csr.weights.end());
+        minEdgeWeight = *range.first;
+        maxEdgeWeight = *range.second;
+    }
+
+    edgeCongestion.clear();
+    if (congestionMultiplier.empty()) return;
+    edgeCongestion.assign(csr.edgeCount(), 1.0f);
+    for (const auto &kv : congestionMultiplier) {
+        long long u = kv.first >> 32;
+        uint32_t v = static_cast<uint32_t>(kv.first & 0xffffffffLL);
+        if (u < 1 || u > n) continue;
+        for (uint32_t i = csr.begin(u); i < csr.end(u); ++i) {
+            if (csr.targets[i] == v) edgeCongestion[i] = static_cast<float>(kv.second);
+        }
+    }
+}
+
+std::size_t GraphManager::edgeCount() const {
+    return frozen ? csr.edgeCount() : pending.size();
+}
+
+std::size_t GraphManager::memoryBytes() const {
+    return csr.memoryBytes() + reverseCsr.memoryBytes() +
+           pending.capacity() * sizeof(Edge) +
+           edgeCongestion.capacity() * sizeof(float) +
+           (lat.capacity() + lon.capacity()) * sizeof(float) +
+           unitXyz.capacity() * sizeof(double);
+}
+
+void GraphManager::prepareSearches() const {
+    freeze();
+    reverseGraph();
+    heuristicFactor();
+}
+
+const CsrGraph &GraphManager::reverseGraph() const {
+    freeze();
+    std::lock_guard<std::mutex> lk(lazyLock);
+    if (reverseCsr.offsets.empty()) {
+        std::vector<Edge> incoming;
+        incoming.reserve(csr.edgeCount());
+        for (uint32_t u = 1; u <= csr.nodeCount(); ++u) {
+            for (uint32_t i = csr.begin(u); i < csr.end(u); ++i) {
+                incoming.push_back({csr.targets[i], u, csr.weights[i],
+                                    static_cast<int32_t>(i)});
+            }
+        }
+        reverseCsr.build(static_cast<uint32_t>(n), incoming);
+    }
+    return reverseCsr;
+}
+
+// ---------------- COORDINATES ----------------
+
+void GraphManager::setNodeLocation(int id, double latitude, double longitude) {
+    if (id <= 0) return;
+    if (id >= static_cast<int>(lat.size())) {
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+        lat.resize(id + 1, nan);
+        lon.resize(id + 1, nan);
+    }
+    lat[id] = static_cast<float>(latitude);
+    lon[id] = static_cast<float>(longitude);
+    heuristicScale = -1.0;
+    coordinatesComplete = -1;
+}
+
+bool GraphManager::nodeLocation(int id, double &latitude, double &longitude) const {
+    if (id <= 0 || id >= static_cast<int>(lat.size()) || std::isnan(lat[id]) || std::isnan(lon[id])) {
+        return false;
+    }
+    latitude = lat[id];
+    longitude = lon[id];
+    return true;
+}
+
+bool GraphManager::hasCoordinates() const {
+    std::lock_guard<std::mutex> lk(lazyLock);
+    return coordinatesKnown();
+}
+
+bool GraphManager::coordinatesKnown() const {
+    if (coordinatesComplete < 0) {
+        coordinatesComplete = n > 0 && static_cast<int>(lat.size()) > n;
+        for (int i = 1; coordinatesComplete && i <= n; ++i) {
+            if (std::isnan(lat[i]) || std::isnan(lon[i])) coordinatesComplete = 0;
+        }
+    }
+    return coordinatesComplete == 1;
+}
+
+// Straight-line (chord) distance in km between two located nodes. It is
+// a metric, so scaled by heuristicFactor() it is a consistent potential,
+// and it needs no trigonometry once the unit vectors are cached.
+double GraphManager::geoDistance(int u, int v) const {
+    const double R = 6371.0;
+    double dx = unitXyz[3 * u] - unitXyz[3 * v];
+    double dy = unitXyz[3 * u + 1] - unitXyz[3 * v + 1];
+    double dz = unitXyz[3 * u + 2] - unitXyz[3 * v + 2];
+    return R * std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+// Multiplier turning straight-line km into a lower bound on road cost.
+// Taken as the smallest weight / distance ratio over all roads, so it is
+// admissible for any graph whose coordinates are merely approximate.
+// Congestion >= 1 only makes roads dearer and keeps it admissible; a
+// multiplier below 1 scales it down accordingly.
+double GraphManager::heuristicFactor() const {
+    std::lock_guard<std::mutex> lk(lazyLock);
+    if (heuristicScale < 0.0) {
+        heuristicScale = 0.0;
+        unitXyz.clear();
+        if (coordinatesKnown()) {
+            const double toRad = 3.14159265358979323846 / 180.0;
+            unitXyz.assign(3 * static_cast<std::size_t>(n + 1), 0.0);
+            for (int i = 1; i <= n; ++i) {
+                double phi = lat[i] * toRad, lambda = lon[i] * toRad;
+                unitXyz[3 * i] = std::cos(phi) * std::cos(lambda);
+                unitXyz[3 * i + 1] = std::cos(phi) * std::sin(lambda);
+                unitXyz[3 * i + 2] = std::sin(phi);
             }
+
+            double scale = std::numeric_limits<double>::infinity();
+            for (uint32_t u = 1; u <= csr.nodeCount(); ++u) {
+                for (uint32_t i = csr.begin(u); i < csr.end(u); ++i) {
+                    double g = geoDistance(u, csr.targets[i]);
+                    if (g > 0.0) scale = std::min(scale, csr.weights[i] / g);
+                }
+            }
+            // Shave a little off for rounding in the trigonometry
+            if (std::isfinite(scale)) heuristicScale = scale * (1.0 - 1e-6);
+        }
+    }
+    return heuristicScale * std::min(1.0, minCongestion);
+}
+
+std::size_t GraphManager::loadGraph(const std::string &nodeFile, const std::string &edgeFile) {
+    std::string_view line;
+
+    // Determine number of nodes from node file (each line has an ID,
+    // optionally followed by latitude and longitude)
+    LineReader nf(nodeFile);
+    ParseReport nodes(nodeFile);
+    int maxId = 0;
+    struct NodeLocation { int id; double lat, lon; };
+    std::vector<NodeLocation> locations;
+    while (nf.next(line)) {
+        FieldCursor f(line);
+        if (f.atEnd() || line[0] == '#') continue;
+
+        int id;
+        double la, lo;
+        if (!f.nextInt(id) || id <= 0) {
+            nodes.reject(nf.lineNumber(), "expected a positive node id");
+            continue;
+        }
+        if (f.atEnd()) {
+            maxId = std::max(maxId, id);
+        } else if (f.nextDouble(la) && f.nextDouble(lo) && f.atEnd()) {
+            maxId = std::max(maxId, id);
+            locations.push_back({id, la, lo});
+        } else {
+            nodes.reject(nf.lineNumber(), "expected 'id [lat lon]'");
+            continue;
         }
+        ++nodes.records;
     }
+    nodes.finish();
 
     if (maxId > 0) {
         reserveNodes(maxId);
     }
+    for (const auto &loc : locations) {
+        setNodeLocation(loc.id, loc.lat, loc.lon);
+    }
 
-    std::ifstream ef(edgeFile);
-    if (!ef) {
+    LineReader ef(edgeFile);
+    if (!ef.isOpen()) {
         std::cerr << "Failed to open edge file: " << edgeFile << "\n";
-        return;
+        return nodes.malformed;
     }
 
-    std::string line;
-    while (std::getline(ef, line)) {
-        if (line.empty()) continue;
-        std::istringstream iss(line);
+    ParseReport edges(edgeFile);
+    while (ef.next(line)) {
+        FieldCursor f(line);
+        if (f.atEnd() || line[0] == '#') continue;
 
         int u, v, id = 0;
         double w;
-        if (!(iss >> u >> v >> w)) continue;
-        if (!(iss >> id)) id = 0;
+        if (!f.nextInt(u) || !f.nextInt(v) || !f.nextDouble(w) ||
+            (!f.atEnd() && !f.nextInt(id)) || !f.atEnd()) {
+            edges.reject(ef.lineNumber(), "expected 'u v w [id]'");
+            continue;
+        }
+        if (u <= 0 || v <= 0) {
+            edges.reject(ef.lineNumber(), "node ids must be positive");
+            continue;
+        }
 
         addEdge(u, v, w, id);
+        ++edges.records;
     }
+    edges.finish();
+    return nodes.malformed + edges.malformed;
+}
+
+// ---------------- BINARY GRAPH FILE ----------------
+
+bool GraphManager::loadBinaryGraph(const std::string &file, bool verify) {
+    GraphFileView view;
+    std::string error;
+    if (!openGraphFile(file, view, error, verify)) {
+        std::cerr << "Failed to load graph file: " << file << " (" << error << ")\n";
+        return false;
+    }
+
+    reserveNodes(static_cast<int>(view.header.nodes));
+    csr = std::move(view.csr);
+    frozen = true;
+    indexFrozen();
+
+    if (view.lat) {
+        lat.assign(view.lat, view.lat + n + 1);
+        lon.assign(view.lon, view.lon + n + 1);
+    }
+    return true;
+}
+
+bool GraphManager::saveBinaryGraph(const std::string &file) const {
+    freeze();
+    std::vector<float> la, lo;
+    if (!lat.empty()) {
+        // Unknown locations stay NaN, as in memory
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+        la.assign(n + 1, nan);
+        lo.assign(n + 1, nan);
+        int known = std::min(n + 1, static_cast<int>(lat.size()));
+        std::copy(lat.begin(), lat.begin() + known, la.begin());
+        std::copy(lon.begin(), lon.begin() + known, lo.begin());
+    }
+
+    std::string error;
+    if (!writeGraphFile(file, csr, la, lo, error)) {
+        std::cerr << "Failed to save graph file: " << file << " (" << error << ")\n";
+        return false;
+    }
+    return true;
 }
 
 void GraphManager::setCongestion(int u, int v, double mult) {
     if (mult <= 0.0) mult = 1.0;
     congestionMultiplier[key(u, v)] = mult;
+    minCongestion = std::min(minCongestion, mult);
+    maxCongestion = std::max(maxCongestion, mult);
+    ++metricEpoch;
+
+    // Keep the packed multipliers in step so the graph stays frozen
+    if (!frozen || u < 1 || u > n) return;
+    if (edgeCongestion.empty()) edgeCongestion.assign(csr.edgeCount(), 1.0f);
+    for (uint32_t i = csr.begin(u); i < csr.end(u); ++i) {
+        if (csr.targets[i] == static_cast<uint32_t>(v))
+            edgeCongestion[i] = static_cast<float>(mult);
+    }
 }
 
 double GraphManager::getCongestion(int u, int v) const {
@@ -88,63 +346,375 @@ double GraphManager::getCongestion(int u, int v) const {
     return it->second;
 }
 
-std::vector<double> GraphManager::dijkstra(int src) const {
+// ---------------- SNAPSHOT ----------------
+
+namespace {
+constexpr uint32_t CONGESTION_VERSION = 1;
+}
+
+void GraphManager::saveCongestion(SnapshotWriter &out) const {
+    std::vector<std::pair<long long, double>> entries(congestionMultiplier.begin(),
+                                                      congestionMultiplier.end());
+    std::sort(entries.begin(), entries.end());
+    std::vector<long long> keys(entries.size());
+    std::vector<double> values(entries.size());
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        keys[i] = entries[i].first;
+        values[i] = entries[i].second;
+    }
+
+    out.beginSection(SNAPSHOT_CONGESTION, CONGESTION_VERSION);
+    out.put<int64_t>(n);
+    out.put<uint64_t>(edgeCount());
+    out.put(minCongestion);
+    out.put(maxCongestion);
+    out.putArray(keys);
+    out.putArray(values);
+    out.endSection();
+}
+
+bool GraphManager::readCongestion(SnapshotReader &in, CongestionState &state) const {
+    uint32_t version = 0;
+    int64_t nodes = 0;
+    uint64_t edges = 0;
+    double lo = 1.0, hi = 1.0;
+    std::vector<long long> keys;
+    std::vector<double> values;
+    if (!in.enter(SNAPSHOT_CONGESTION, CONGESTION_VERSION, version) || !in.get(nodes) ||
+        !in.get(edges) || !in.get(lo) || !in.get(hi) || !in.getArray(keys) || !in.getArray(values)) {
+        return false;
+    }
+    if (nodes != n || edges != edgeCount()) {
+        return in.fail("snapshot was taken on another road graph");
+    }
+    if (keys.size() != values.size()) return in.fail("congestion keys and values differ in length");
+
+    state.multipliers.clear();
+    state.multipliers.reserve(keys.size());
+    for (std::size_t i = 0; i < keys.size(); ++i) state.multipliers[keys[i]] = values[i];
+    state.minMultiplier = lo;
+    state.maxMultiplier = hi;
+    return true;
+}
+
+void GraphManager::replaceCongestion(CongestionState &&state) {
+    congestionMultiplier.swap(state.multipliers);
+    minCongestion = state.minMultiplier;
+    maxCongestion = state.maxMultiplier;
+    ++metricEpoch;
+    if (frozen) indexFrozen();
+}
+
+std::vector<double> GraphManager::dijkstra(int src, std::vector<int> *parent) const {
+    freeze();
     const double INF = std::numeric_limits<double>::infinity();
     std::vector<double> dist(n + 1, INF);
+    if (parent) parent->assign(n + 1, -1);
 
     if (src < 1 || src > n) return dist;
+    search(src, 0, dist, parent);
+    return dist;
+}
 
-    using State = std::pair<double, int>; // (dist, node)
-    std::priority_queue<State, std::vector<State>, std::greater<State>> pq;
+// ---------------- SEARCH QUEUES ----------------
 
+template <class Queue>
+int GraphManager::search(int src, int dest, Queue &pq, std::vector<double> &dist,
+                         std::vector<int> *parent) const {
     dist[src] = 0.0;
-    pq.push({0.0, src});
+    if (parent) (*parent)[src] = src;
+    pq.push(0.0, src);
+    int settled = 0;
 
     while (!pq.empty()) {
-        auto [d, u] = pq.top();
-        pq.pop();
+        auto [d, u] = pq.pop();
         if (d > dist[u]) continue;
+        ++settled;
+        if (u == dest) break;
 
-        for (const auto &e : adj[u]) {
-            double wt = e.weight * getCongestion(u, e.to);
-            if (dist[e.to] > d + wt) {
-                dist[e.to] = d + wt;
-                pq.push({dist[e.to], e.to});
+        for (uint32_t i = csr.begin(u); i < csr.end(u); ++i) {
+            uint32_t to = csr.targets[i];
+            double wt = edgeCost(i);
+            if (dist[to] > d + wt) {
+                dist[to] = d + wt;
+                if (parent) (*parent)[to] = u;
+                pq.push(dist[to], static_cast<int>(to));
             }
         }
     }
+    return settled;
+}
 
-    return dist;
+int GraphManager::search(int src, int dest, std::vector<double> &dist,
+                         std::vector<int> *parent) const {
+    switch (queue) {
+    case QueueKind::RadixHeap: {
+        RadixHeapQueue pq;
+        return search(src, dest, pq, dist, parent);
+    }
+    case QueueKind::QuaternaryHeap: {
+        IndexedQuaternaryHeap pq(n);
+        return search(src, dest, pq, dist, parent);
+    }
+    case QueueKind::Dial: {
+        // Congestion multipliers are stored as float; keep the width
+        // safely below the true cheapest edge cost
+        double width = minEdgeWeight * std::min(1.0, minCongestion) * (1.0 - 1e-6);
+        double maxEdge = maxEdgeWeight * std::max(1.0, maxCongestion) * (1.0 + 1e-6);
+        if (width > 0.0 && DialQueue::bucketsFor(width, maxEdge) <= (1 << 20)) {
+            DialQueue pq(width, maxEdge);
+            return search(src, dest, pq, dist, parent);
+        }
+        break;
+    }
+    case QueueKind::BinaryHeap:
+        break;
+    }
+    BinaryHeapQueue pq;
+    return search(src, dest, pq, dist, parent);
 }
-std::vector<int> GraphManager::shortestPath(int src, int dest) {
+
+void SearchScratch::prepare(int n) {
+    if (static_cast<int>(dist.size()) != n + 1) {
+        dist.assign(n + 1, std::numeric_limits<double>::infinity());
+        isTarget.assign(n + 1, 0);
+        touched.clear();
+    }
+    heap.clear();
+}
+
+void SearchScratch::release() {
+    for (int v : touched) {
+        dist[v] = std::numeric_limits<double>::infinity();
+        isTarget[v] = 0;
+    }
+    touched.clear();
+}
+
+void GraphManager::distancesTo(int src, const std::vector<int> &targets,
+                               SearchScratch &scratch, double *out) const {
     const double INF = std::numeric_limits<double>::infinity();
-    std::vector<double> dist(n + 1, INF);
-    std::vector<int> parent(n + 1, -1);
+    std::fill(out, out + targets.size(), INF);
+    if (src < 1 || src > n) return;
 
-    using State = std::pair<double, int>;
-    std::priority_queue<State, std::vector<State>, std::greater<State>> pq;
+    SearchScratch &s = scratch;
+    s.prepare(n);
+    // Raw pointers: the heap pushes below would otherwise force reloads
+    double *dist = s.dist.data();
+    char *isTarget = s.isTarget.data();
 
-    dist[src] = 0;
-    pq.push({0, src});
-    parent[src] = src;
+    std::size_t remaining = 0;
+    for (int t : targets) {
+        if (t < 1 || t > n || isTarget[t]) continue;
+        isTarget[t] = 1;
+        s.touched.push_back(t);
+        ++remaining;
+    }
 
-    while (!pq.empty()) {
-        auto [d, u] = pq.top();
-        pq.pop();
+    auto later = [](const std::pair<double, int> &a, const std::pair<double, int> &b) {
+        return a.first > b.first;
+    };
 
-        if (u == dest) break;
+    dist[src] = 0.0;
+    s.touched.push_back(src);
+    s.heap.push_back({0.0, src});
+
+    while (!s.heap.empty() && remaining > 0) {
+        std::pop_heap(s.heap.begin(), s.heap.end(), later);
+        auto [d, u] = s.heap.back();
+        s.heap.pop_back();
+        if (d > dist[u]) continue;
+        if (isTarget[u]) --remaining;
+
+        for (uint32_t i = csr.begin(u); i < csr.end(u); ++i) {
+            uint32_t to = csr.targets[i];
+            double nd = d + edgeCost(i);
+            if (nd < dist[to]) {
+                if (dist[to] == INF) s.touched.push_back(static_cast<int>(to));
+                dist[to] = nd;
+                s.heap.push_back({nd, static_cast<int>(to)});
+                std::push_heap(s.heap.begin(), s.heap.end(), later);
+            }
+        }
+    }
+
+    for (std::size_t j = 0; j < targets.size(); ++j) {
+        int t = targets[j];
+        if (t >= 1 && t <= n) out[j] = dist[t];
+    }
+    s.release();
+}
+
+int GraphManager::expandFrom(int src, double maxCost, SearchScratch &scratch,
+                             const std::function<bool(int, double)> &visit) const {
+    if (src < 1 || src > n) return 0;
+    const double INF = std::numeric_limits<double>::infinity();
+    SearchScratch &s = scratch;
+    s.prepare(n);
+    double *dist = s.dist.data();
+
+    auto later = [](const std::pair<double, int> &a, const std::pair<double, int> &b) {
+        return a.first > b.first;
+    };
+
+    dist[src] = 0.0;
+    s.touched.push_back(src);
+    s.heap.push_back({0.0, src});
+    int settled = 0;
+
+    while (!s.heap.empty()) {
+        std::pop_heap(s.heap.begin(), s.heap.end(), later);
+        auto [d, u] = s.heap.back();
+        s.heap.pop_back();
         if (d > dist[u]) continue;
+        ++settled;
+        if (!visit(u, d)) break;
+
+        for (uint32_t i = csr.begin(u); i < csr.end(u); ++i) {
+            uint32_t to = csr.targets[i];
+            double nd = d + edgeCost(i);
+            if (nd < dist[to] && nd <= maxCost) {
+                if (dist[to] == INF) s.touched.push_back(static_cast<int>(to));
+                dist[to] = nd;
+                s.heap.push_back({nd, static_cast<int>(to)});
+                std::push_heap(s.heap.begin(), s.heap.end(), later);
+            }
+        }
+    }
+    s.release();
+    return settled;
+}
+
+void GraphManager::nearestSources(const std::vector<int> &sources,
+                                  const std::vector<int> &targets,
+                                  std::vector<double> &dist, std::vector<int> &parent,
+                                  std::vector<int> &root) const {
+    freeze();
+    dist.assign(n + 1, std::numeric_limits<double>::infinity());
+    parent.assign(n + 1, -1);
+    root.assign(n + 1, -1);
+
+    std::vector<char> isTarget(n + 1, 0);
+    std::size_t remaining = 0;
+    for (int t : targets) {
+        if (t < 1 || t > n || isTarget[t]) continue;
+        isTarget[t] = 1;
+        ++remaining;
+    }
+
+    BinaryHeapQueue pq;
+    for (int s : sources) {
+        if (s < 1 || s > n || root[s] != -1) continue;
+        dist[s] = 0.0;
+        parent[s] = s;
+        root[s] = s;
+        pq.push(0.0, s);
+    }
+
+    bool labelAll = targets.empty();
+    while (!pq.empty() && (labelAll || remaining > 0)) {
+        auto [d, u] = pq.pop();
+        if (d > dist[u]) continue;
+        if (isTarget[u]) --remaining;
+
+        for (uint32_t i = csr.begin(u); i < csr.end(u); ++i) {
+            uint32_t to = csr.targets[i];
+            double nd = d + edgeCost(i);
+            if (nd < dist[to]) {
+                dist[to] = nd;
+                parent[to] = u;
+                root[to] = root[u];
+                pq.push(nd, static_cast<int>(to));
+            }
+        }
+    }
+}
+
+void GraphManager::withdrawSources(const std::vector<int> &removed, std::vector<double> &dist,
+                                   std::vector<int> &parent, std::vector<int> &root) const {
+    const double INF = std::numeric_limits<double>::infinity();
+    const CsrGraph &rev = reverseGraph();
+
+    // A removed source's cell is its search tree: walk it down from the
+    // source through parent links instead of scanning every label
+    std::vector<char> orphan(n + 1, 0);
+    std::vector<int> orphans;
+    for (int s : removed) {
+        if (s < 1 || s > n || orphan[s] || root[s] != s) continue;
+        orphan[s] = 1;
+        orphans.push_back(s);
+    }
+    for (std::size_t k = 0; k < orphans.size(); ++k) {
+        int u = orphans[k];
+        for (uint32_t i = csr.begin(u); i < csr.end(u); ++i) {
+            int to = static_cast<int>(csr.targets[i]);
+            if (!orphan[to] && parent[to] == u && root[to] == root[u]) {
+                orphan[to] = 1;
+                orphans.push_back(to);
+            }
+        }
+    }
+    for (int v : orphans) {
+        dist[v] = INF;
+        parent[v] = -1;
+        root[v] = -1;
+    }
 
-        for (const auto &e : adj[u]) {
-            double wt = e.weight * getCongestion(u, e.to);
-            if (dist[e.to] > d + wt) {
-                dist[e.to] = d + wt;
-                parent[e.to] = u;
-                pq.push({dist[e.to], e.to});
+    // Best entry into each orphan from a node that kept its source
+    BinaryHeapQueue pq;
+    for (int v : orphans) {
+        for (uint32_t r = rev.begin(v); r < rev.end(v); ++r) {
+            int from = static_cast<int>(rev.targets[r]);
+            if (orphan[from] || root[from] == -1) continue;
+            double nd = dist[from] + edgeCost(static_cast<uint32_t>(rev.ids[r]));
+            if (nd < dist[v]) {
+                dist[v] = nd;
+                parent[v] = from;
+                root[v] = root[from];
             }
         }
+        if (dist[v] < INF) pq.push(dist[v], v);
     }
 
+    // Nodes that kept their source cannot improve; settle only orphans
+    while (!pq.empty()) {
+        auto [d, u] = pq.pop();
+        if (d > dist[u]) continue;
+        for (uint32_t i = csr.begin(u); i < csr.end(u); ++i) {
+            uint32_t to = csr.targets[i];
+            if (!orphan[to]) continue;
+            double nd = d + edgeCost(i);
+            if (nd < dist[to]) {
+                dist[to] = nd;
+                parent[to] = u;
+                root[to] = root[u];
+                pq.push(nd, static_cast<int>(to));
+            }
+        }
+    }
+}
+
+std::vector<int> GraphManager::shortestPath(int src, int dest,
+                                            PathAlgorithm algo,
+                                            SearchStats *stats) {
+    freeze();
+    const double INF = std::numeric_limits<double>::infinity();
+    if (stats) *stats = SearchStats{0, INF};
+    if (src < 1 || src > n || dest < 1 || dest > n) return {};
+
+    if (algo == PathAlgorithm::BidirectionalAStar) {
+        if (src == dest) {
+            if (stats) *stats = SearchStats{1, 0.0};
+            return {src};
+        }
+        return bidirectionalAStar(src, dest, stats);
+    }
+
+    std::vector<double> dist(n + 1, INF);
+    std::vector<int> parent(n + 1, -1);
+    int settled = search(src, dest, dist, &parent);
+
+    if (stats) *stats = SearchStats{settled, dist[dest]};
     if (dist[dest] == INF) return {};
 
     std::vector<int> path;
@@ -156,3 +726,97 @@ std::vector<int> GraphManager::shortestPath(int src, int dest) {
     std::reverse(path.begin(), path.end());
     return path;
 }
+
+// Bidirectional A* with the symmetric average potential
+//   pf(v) = (h(v, dest) - h(src, v)) / 2,   pr(v) = -pf(v)
+// which is consistent for both searches, so each is a plain Dijkstra on
+// reduced costs and the searches can stop once topF + topR >= best.
+std::vector<int> GraphManager::bidirectionalAStar(int src, int dest,
+                                                  SearchStats *stats) const {
+    const double INF = std::numeric_limits<double>::infinity();
+    const CsrGraph &rev = reverseGraph();
+    const double scale = heuristicFactor();
+
+    auto potential = [&](int v) {
+        if (scale == 0.0) return 0.0;
+        return 0.5 * scale * (geoDistance(v, dest) - geoDistance(src, v));
+    };
+
+    std::vector<double> distF(n + 1, INF), distR(n + 1, INF);
+    std::vector<int> parentF(n + 1, -1), nextR(n + 1, -1);
+    std::vector<char> doneF(n + 1, 0), doneR(n + 1, 0);
+
+    using State = std::pair<double, int>; // (dist + potential, node)
+    std::priority_queue<State, std::vector<State>, std::greater<State>> pqF, pqR;
+
+    distF[src] = 0.0;
+    parentF[src] = src;
+    pqF.push({potential(src), src});
+    distR[dest] = 0.0;
+    nextR[dest] = dest;
+    pqR.push({-potential(dest), dest});
+
+    double best = INF;
+    int meet = -1;
+    int settled = 0;
+
+    while (!pqF.empty() && !pqR.empty()) {
+        if (pqF.top().first + pqR.top().first >= best) break;
+
+        bool forward = pqF.size() <= pqR.size();
+        if (forward) {
+            int u = pqF.top().second;
+            pqF.pop();
+            if (doneF[u]) continue;
+            doneF[u] = 1;
+            ++settled;
+
+            for (uint32_t i = csr.begin(u); i < csr.end(u); ++i) {
+                int to = static_cast<int>(csr.targets[i]);
+                double nd = distF[u] + edgeCost(i);
+                if (nd < distF[to]) {
+                    distF[to] = nd;
+                    parentF[to] = u;
+                    pqF.push({nd + potential(to), to});
+                }
+                if (distR[to] < INF && nd + distR[to] < best) {
+                    best = nd + distR[to];
+                    meet = to;
+                }
+            }
+        } else {
+            int u = pqR.top().second;
+            pqR.pop();
+            if (doneR[u]) continue;
+            doneR[u] = 1;
+            ++settled;
+
+            for (uint32_t i = rev.begin(u); i < rev.end(u); ++i) {
+                int from = static_cast<int>(rev.targets[i]);
+                double nd = distR[u] + edgeCost(static_cast<uint32_t>(rev.ids[i]));
+                if (nd < distR[from]) {
+                    distR[from] = nd;
+                    nextR[from] = u;
+                    pqR.push({nd - potential(from), from});
+                }
+                if (distF[from] < INF && nd + distF[from] < best) {
+                    best = nd + distF[from];
+                    meet = from;
+                }
+            }
+        }
+    }
+
+    if (stats) *stats = SearchStats{settled, best};
+    if (meet == -1) return {};
+
+    std::vector<int> path;
+    for (int v = meet; v != src; v = parentF[v]) path.push_back(v);
+    path.push_back(src);
+    std::reverse(path.begin(), path.end());
+    for (int v = meet; v != dest; ) {
+        v = nextR[v];
+        path.push_back(v);
+    }
+    return path;
+}
@@ -2,32 +2,187 @@
 #define GRAPH_MANAGER_H
 #include <vector>
 #include <string>
+#include <cstddef>
+#include <functional>
+#include <mutex>
 #include <unordered_map>
-struct Edge {
-    int to;
-    double weight; 
-    int id;       
+#include "CsrGraph.h"
+#include "SearchQueues.h"
+
+class SnapshotWriter;
+class SnapshotReader;
+
+enum class PathAlgorithm {
+    Dijkstra,           // unidirectional, stops when dest is settled
+    BidirectionalAStar, // goal-directed from both ends (needs node coordinates
+                        // to beat Dijkstra, still exact without them)
+    Hierarchy           // CoreEngineService's contraction hierarchy; plain
+                        // GraphManager answers it with Dijkstra
+};
+
+// Congestion read from a snapshot, checked but not yet in place
+struct CongestionState {
+    std::unordered_map<long long, double> multipliers;
+    double minMultiplier = 1.0;
+    double maxMultiplier = 1.0;
+};
+
+// Filled in by point-to-point queries
+struct SearchStats {
+    int settled = 0;    // nodes popped with a final distance
+    double cost = 0.0;  // length of the returned path (inf if none)
+};
+
+// Reusable state for repeated searches on one thread. dist stays all-inf
+// between searches: each search records what it touched and resets only
+// that, so it costs O(visited) rather than O(n).
+struct SearchScratch {
+    std::vector<double> dist;
+    std::vector<char> isTarget;
+    std::vector<int> touched;
+    std::vector<std::pair<double, int>> heap;
+
+    void prepare(int n);
+    void release();
 };
+
 class GraphManager {
 private:
-    int n; 
-    std::vector<std::vector<Edge>> adj;
-    std::vector<std::vector<double>> adjMatrix;
+    int n;
+    // Roads added since the last freeze; folded into csr on first query
+    mutable std::vector<Edge> pending;
+    mutable CsrGraph csr;
+    mutable bool frozen = false;
+    // Per-CSR-edge multiplier, empty while no road is congested
+    mutable std::vector<float> edgeCongestion;
     std::unordered_map<long long, double> congestionMultiplier;
+    double minCongestion = 1.0;
+    double maxCongestion = 1.0;
+    // Cheapest / dearest road weight, refreshed on freeze
+    mutable double minEdgeWeight = 0.0;
+    mutable double maxEdgeWeight = 0.0;
+    // Queue used by dijkstra() and Dijkstra point-to-point queries
+    QueueKind queue = QueueKind::BinaryHeap;
+    // Bumped whenever roads change / whenever a congestion multiplier changes
+    uint64_t topologyEpoch = 0;
+    uint64_t metricEpoch = 0;
+
+    // Incoming edges, built on first use. ids[i] holds the forward CSR
+    // position of the edge so costs and congestion are shared.
+    mutable CsrGraph reverseCsr;
+
+    // Node coordinates in degrees (NaN when unknown)
+    std::vector<float> lat, lon;
+    // km of road cost per km of great-circle distance, lower bound over
+    // all edges; negative until recomputed
+    mutable double heuristicScale = -1.0;
+    mutable std::vector<double> unitXyz; // 3 per node, cached with the scale
+    mutable int coordinatesComplete = -1; // -1 unknown, else 0 / 1
+    // Const queries fill reverseCsr, coordinatesComplete and the heuristic
+    // cache on first use; concurrent readers take turns doing it
+    mutable std::mutex lazyLock;
+    bool coordinatesKnown() const;        // lazyLock held
 
     long long key(int u, int v) const {
         return (static_cast<long long>(u) << 32) |
                static_cast<unsigned long long>(v);
     }
+    void thaw();
+    void indexFrozen() const;
+    double geoDistance(int u, int v) const;
+    double heuristicFactor() const;
+    std::vector<int> bidirectionalAStar(int src, int dest, SearchStats *stats) const;
+    // Dijkstra from src, stopping once dest is settled (dest 0: never).
+    // Returns the number of settled nodes.
+    int search(int src, int dest, std::vector<double> &dist,
+               std::vector<int> *parent) const;
+    template <class Queue>
+    int search(int src, int dest, Queue &pq, std::vector<double> &dist,
+               std::vector<int> *parent) const;
 
 public:
     GraphManager(int nodes = 0);
     void reserveNodes(int nodes);
     void addEdge(int u, int v, double w, int id = 0);
-    void loadGraph(const std::string &nodeFile, const std::string &edgeFile);
+    // Node file lines are "id [lat lon]"; edge file lines "u v w [id]".
+    // Blank and '#' lines are skipped; malformed lines are reported with
+    // their line number on std::cerr, skipped and counted in the result.
+    std::size_t loadGraph(const std::string &nodeFile, const std::string &edgeFile);
+    // Binary graph file (see GraphFile.h). Loading maps the file and
+    // serves the road arrays from it without copying; the graph starts
+    // frozen. verify = false skips the checksum pass over the file.
+    bool loadBinaryGraph(const std::string &file, bool verify = true);
+    bool saveBinaryGraph(const std::string &file) const;
     void setCongestion(int u, int v, double mult);
     double getCongestion(int u, int v) const;
-    std::vector<double> dijkstra(int src) const;
-    std::vector<int> shortestPath(int src, int dest);
+    // Congestion multipliers as a snapshot section (see SnapshotFile.h).
+    // Reading needs the same road graph (node and edge counts must match
+    // the ones saved) and changes nothing; replaceCongestion puts what
+    // was read in place as a new metric epoch.
+    void saveCongestion(SnapshotWriter &out) const;
+    bool readCongestion(SnapshotReader &in, CongestionState &state) const;
+    void replaceCongestion(CongestionState &&state);
+
+    // Dial falls back to the binary heap when the cheapest road costs 0 or
+    // the cost spread would need too many buckets
+    void setQueueKind(QueueKind kind) { queue = kind; }
+    QueueKind queueKind() const { return queue; }
+
+    void setNodeLocation(int id, double latitude, double longitude);
+    bool hasCoordinates() const;
+    // False when the node has no location
+    bool nodeLocation(int id, double &latitude, double &longitude) const;
+
+    // Pack pending roads into the CSR arrays. Queries do this on demand;
+    // call it explicitly before sharing the graph between threads.
+    void freeze() const;
+    // freeze(), then build what searches otherwise fill in on first use:
+    // reverse roads, the coordinate check and the A* heuristic scale
+    void prepareSearches() const;
+    int nodeCount() const { return n; }
+    uint64_t topologyVersion() const { return topologyEpoch; }
+    uint64_t metricVersion() const { return metricEpoch; }
+    std::size_t edgeCount() const;
+    std::size_t memoryBytes() const;
+
+    // Read-only views for search code outside this class (freeze first)
+    const CsrGraph &forwardGraph() const { return csr; }
+    const CsrGraph &reverseGraph() const;
+    double edgeCost(uint32_t i) const {
+        return edgeCongestion.empty()
+                   ? csr.weights[i]
+                   : csr.weights[i] * static_cast<double>(edgeCongestion[i]);
+    }
+
+    // Full single-source search; fills parent (previous node, src -> src,
+    // -1 unreached) when given
+    std::vector<double> dijkstra(int src, std::vector<int> *parent = nullptr) const;
+    // Distances from src to each of targets, written to out[0 .. size).
+    // Stops as soon as every target is settled. Safe to call concurrently
+    // on a frozen graph with one scratch per thread.
+    void distancesTo(int src, const std::vector<int> &targets,
+                     SearchScratch &scratch, double *out) const;
+    // Dijkstra from src handing each settled node to visit(node, cost) in
+    // cost order; stops when visit returns false or nothing within
+    // maxCost is left. Same concurrency rules as distancesTo. Returns the
+    // number of settled nodes.
+    int expandFrom(int src, double maxCost, SearchScratch &scratch,
+                   const std::function<bool(int node, double cost)> &visit) const;
+    // One Dijkstra seeded at all of sources: dist[v] is the cost from the
+    // nearest source, root[v] that source (-1 unreached), parent[v] the
+    // previous node (a source -> itself). Stops once every target is
+    // settled (no targets: labels every node); arrays are resized to
+    // nodeCount() + 1.
+    void nearestSources(const std::vector<int> &sources, const std::vector<int> &targets,
+                        std::vector<double> &dist, std::vector<int> &parent,
+                        std::vector<int> &root) const;
+    // Updates complete nearestSources() labels after some sources drop
+    // out: only nodes whose nearest source was removed are re-settled,
+    // seeded from their in-roads out of still-valid cells.
+    void withdrawSources(const std::vector<int> &removed, std::vector<double> &dist,
+                         std::vector<int> &parent, std::vector<int> &root) const;
+    std::vector<int> shortestPath(int src, int dest,
+                                  PathAlgorithm algo = PathAlgorithm::Dijkstra,
+                                  SearchStats *stats = nullptr);
 };
 #endif
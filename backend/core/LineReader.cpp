@@ -0,0 +1,112 @@
+// ===================== LineReader.cpp =====================
+#include "LineReader.h"
+#include <charconv>
+#include <cstring>
+#include <iostream>
+
+// ---------------- LINES ----------------
+
+LineReader::LineReader(const std::string &path, std::size_t bufferBytes)
+    : file(std::fopen(path.c_str(), "rb")), buffer(bufferBytes < 64 ? 64 : bufferBytes) {}
+
+LineReader::~LineReader() {
+    if (file) std::fclose(file);
+}
+
+// Moves the unread tail to the front and reads more behind it; grows the
+// buffer only when a single line does not fit
+bool LineReader::refill() {
+    if (eof || !file) return false;
+    if (begin > 0) {
+        std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+        end -= begin;
+        begin = 0;
+    }
+    if (end == buffer.size()) buffer.resize(buffer.size() * 2);
+
+    std::size_t got = std::fread(buffer.data() + end, 1, buffer.size() - end, file);
+    if (got == 0) eof = true;
+    end += got;
+    consumed += got;
+    return got > 0;
+}
+
+bool LineReader::next(std::string_view &line) {
+    for (;;) {
+        const char *start = buffer.data() + begin;
+        const char *nl = static_cast<const char *>(std::memchr(start, '\n', end - begin));
+        if (nl || (eof && begin < end)) {
+            std::size_t len = nl ? static_cast<std::size_t>(nl - start) : end - begin;
+            begin += nl ? len + 1 : len;
+            if (len > 0 && start[len - 1] == '\r') --len;
+            line = std::string_view(start, len);
+            ++lineNo;
+            return true;
+        }
+        if (!refill() && begin == end) return false;
+    }
+}
+
+// ---------------- FIELDS ----------------
+
+void FieldCursor::skipSeparators() {
+    while (p < stop && separators.find(*p) != std::string_view::npos) ++p;
+}
+
+// Numbers may be padded with blanks even when blanks do not separate
+// fields ("A1, 3" in a CSV line)
+bool FieldCursor::endsField(const char *at) const {
+    return at == stop || *at == ' ' || *at == '\t' ||
+           separators.find(*at) != std::string_view::npos;
+}
+
+void FieldCursor::skipBlanks() {
+    skipSeparators();
+    while (p < stop && (*p == ' ' || *p == '\t')) ++p;
+}
+
+bool FieldCursor::nextInt(int &out) {
+    skipBlanks();
+    auto [next, ec] = std::from_chars(p, stop, out);
+    if (ec != std::errc() || !endsField(next)) return false;
+    p = next;
+    return true;
+}
+
+bool FieldCursor::nextDouble(double &out) {
+    skipBlanks();
+    const char *from = p < stop && *p == '+' ? p + 1 : p;   // from_chars rejects '+'
+    auto [next, ec] = std::from_chars(from, stop, out);
+    if (ec != std::errc() || !endsField(next)) return false;
+    p = next;
+    return true;
+}
+
+bool FieldCursor::nextToken(std::string_view &out) {
+    skipSeparators();
+    const char *start = p;
+    while (p < stop && separators.find(*p) == std::string_view::npos) ++p;
+    out = std::string_view(start, static_cast<std::size_t>(p - start));
+    return p > start;
+}
+
+bool FieldCursor::atEnd() {
+    skipBlanks();
+    return p == stop;
+}
+
+// ---------------- REPORTING ----------------
+
+void ParseReport::reject(std::size_t line, const char *message) {
+    ++malformed;
+    if (shown < 10) {
+        std::cerr << file << ":" << line << ": " << message << "\n";
+        ++shown;
+    }
+}
+
+void ParseReport::finish() const {
+    if (malformed > shown) {
+        std::cerr << file << ": " << (malformed - shown) << " more malformed line(s)\n";
+    }
+}
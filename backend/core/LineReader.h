@@ -0,0 +1,77 @@
+#ifndef LINE_READER_H
+#define LINE_READER_H
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Streams a text file through one large buffer and hands out its lines as
+// views into that buffer (no copy, no per-line allocation). A view stays
+// valid until the next call to next(). "\r\n" endings are accepted.
+class LineReader {
+private:
+    std::FILE *file = nullptr;
+    std::vector<char> buffer;
+    std::size_t begin = 0;            // unread bytes are [begin, end)
+    std::size_t end = 0;
+    bool eof = false;
+    std::size_t lineNo = 0;
+    uint64_t consumed = 0;
+
+    bool refill();
+
+public:
+    explicit LineReader(const std::string &path, std::size_t bufferBytes = 4u << 20);
+    ~LineReader();
+    LineReader(const LineReader &) = delete;
+    LineReader &operator=(const LineReader &) = delete;
+
+    bool isOpen() const { return file != nullptr; }
+    bool next(std::string_view &line);
+    // 1-based number of the line last returned
+    std::size_t lineNumber() const { return lineNo; }
+    uint64_t bytesRead() const { return consumed; }
+};
+
+// Splits one line into fields on any of the separator characters and
+// parses them with std::from_chars
+class FieldCursor {
+private:
+    const char *p;
+    const char *stop;
+    std::string_view separators;
+
+    void skipSeparators();
+    void skipBlanks();
+    bool endsField(const char *at) const;
+
+public:
+    FieldCursor(std::string_view line, std::string_view separators = " \t")
+        : p(line.data()), stop(line.data() + line.size()), separators(separators) {}
+
+    bool nextInt(int &out);
+    bool nextDouble(double &out);
+    bool nextToken(std::string_view &out);
+    // Nothing but separators left
+    bool atEnd();
+};
+
+// Counts records and malformed lines while loading one file; the first
+// few problems are printed to std::cerr as "file:line: message"
+class ParseReport {
+private:
+    std::string file;
+    std::size_t shown = 0;
+
+public:
+    std::size_t records = 0;
+    std::size_t malformed = 0;
+
+    explicit ParseReport(std::string file) : file(std::move(file)) {}
+    void reject(std::size_t line, const char *message);
+    // Prints the count of problems that were not shown individually
+    void finish() const;
+};
+#endif // LINE_READER_H
@@ -0,0 +1,55 @@
+// ===================== ResponderRegistry.cpp =====================
+#include "ResponderRegistry.h"
+
+void ResponderRegistry::addUnit(int id, int node, const std::string &type, bool available) {
+    auto it = index.find(id);
+    if (it != index.end()) {
+        units[it->second] = {id, node, type, available};
+        return;
+    }
+    index[id] = units.size();
+    units.push_back({id, node, type, available});
+}
+
+bool ResponderRegistry::removeUnit(int id) {
+    auto it = index.find(id);
+    if (it == index.end()) return false;
+
+    // Swap the last unit into the hole
+    std::size_t slot = it->second;
+    index.erase(it);
+    if (slot != units.size() - 1) {
+        units[slot] = units.back();
+        index[units[slot].id] = slot;
+    }
+    units.pop_back();
+    return true;
+}
+
+bool ResponderRegistry::setAvailable(int id, bool available) {
+    auto it = index.find(id);
+    if (it == index.end()) return false;
+    units[it->second].available = available;
+    return true;
+}
+
+bool ResponderRegistry::moveUnit(int id, int node) {
+    auto it = index.find(id);
+    if (it == index.end()) return false;
+    units[it->second].node = node;
+    return true;
+}
+
+const ResponderUnit *ResponderRegistry::findUnit(int id) const {
+    auto it = index.find(id);
+    if (it == index.end()) return nullptr;
+    return &units[it->second];
+}
+
+std::size_t ResponderRegistry::availableCount(const std::string &type) const {
+    std::size_t count = 0;
+    for (const auto &u : units) {
+        if (u.available && u.type == type) ++count;
+    }
+    return count;
+}
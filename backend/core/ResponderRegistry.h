@@ -0,0 +1,31 @@
+#ifndef RESPONDER_REGISTRY_H
+#define RESPONDER_REGISTRY_H
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// One emergency vehicle / crew that can be sent to incidents
+struct ResponderUnit {
+    int id;
+    int node;               // where the unit currently is
+    std::string type;       // EmergencyManager type name, e.g. "ambulance"
+    bool available;
+};
+
+class ResponderRegistry {
+private:
+    std::vector<ResponderUnit> units;
+    std::unordered_map<int, std::size_t> index;   // unit id -> slot in units
+
+public:
+    // Adds the unit, or updates node / type / availability of a known id
+    void addUnit(int id, int node, const std::string &type, bool available = true);
+    bool removeUnit(int id);
+    bool setAvailable(int id, bool available);
+    bool moveUnit(int id, int node);
+
+    const ResponderUnit *findUnit(int id) const;
+    const std::vector<ResponderUnit> &allUnits() const { return units; }
+    std::size_t availableCount(const std::string &type) const;
+};
+#endif // RESPONDER_REGISTRY_H
@@ -0,0 +1,108 @@
+// ===================== RouteCache.cpp =====================
+#include "RouteCache.h"
+#include <algorithm>
+
+// ---------------- TREE ----------------
+
+std::size_t ShortestPathTree::memoryBytes() const {
+    return sizeof(ShortestPathTree) + dist.capacity() * sizeof(double) +
+           parent.capacity() * sizeof(int);
+}
+
+std::vector<int> ShortestPathTree::pathTo(int dest) const {
+    if (dest < 0 || dest >= static_cast<int>(parent.size()) || parent[dest] == -1) return {};
+
+    std::vector<int> path;
+    for (int v = dest; v != source; v = parent[v]) path.push_back(v);
+    path.push_back(source);
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+// ---------------- CACHE ----------------
+
+RouteCache::RouteCache(std::size_t capacityBytes) : capacityBytes(capacityBytes) {}
+
+RouteCache::TreePtr RouteCache::find(int src, uint64_t topology, uint64_t metric) {
+    std::lock_guard<std::mutex> lk(lock);
+    auto it = bySource.find(src);
+    if (it == bySource.end()) {
+        ++counters.misses;
+        return nullptr;
+    }
+
+    TreePtr tree = *it->second;
+    if (tree->topology != topology || tree->metric != metric) {
+        // Roads or congestion changed since: never serve it again
+        counters.bytes -= tree->memoryBytes();
+        lru.erase(it->second);
+        bySource.erase(it);
+        ++counters.misses;
+        return nullptr;
+    }
+
+    lru.splice(lru.begin(), lru, it->second);
+    ++counters.hits;
+    return tree;
+}
+
+RouteCache::TreePtr RouteCache::peek(int src, uint64_t topology, uint64_t metric) const {
+    std::lock_guard<std::mutex> lk(lock);
+    auto it = bySource.find(src);
+    if (it == bySource.end()) return nullptr;
+    const TreePtr &tree = *it->second;
+    if (tree->topology != topology || tree->metric != metric) return nullptr;
+    return tree;
+}
+
+void RouteCache::insert(TreePtr tree) {
+    std::size_t bytes = tree->memoryBytes();
+    std::lock_guard<std::mutex> lk(lock);
+    if (bytes > capacityBytes) return;
+
+    auto it = bySource.find(tree->source);
+    if (it != bySource.end()) {
+        counters.bytes -= (*it->second)->memoryBytes();
+        lru.erase(it->second);
+        bySource.erase(it);
+    }
+
+    evictTo(capacityBytes - bytes);
+    lru.push_front(std::move(tree));
+    bySource[lru.front()->source] = lru.begin();
+    counters.bytes += bytes;
+}
+
+void RouteCache::evictTo(std::size_t limit) {
+    while (counters.bytes > limit && !lru.empty()) {
+        counters.bytes -= lru.back()->memoryBytes();
+        bySource.erase(lru.back()->source);
+        lru.pop_back();
+        ++counters.evictions;
+    }
+}
+
+void RouteCache::clear() {
+    std::lock_guard<std::mutex> lk(lock);
+    lru.clear();
+    bySource.clear();
+    counters.bytes = 0;
+}
+
+void RouteCache::setCapacity(std::size_t bytes) {
+    std::lock_guard<std::mutex> lk(lock);
+    capacityBytes = bytes;
+    evictTo(capacityBytes);
+}
+
+std::size_t RouteCache::capacity() const {
+    std::lock_guard<std::mutex> lk(lock);
+    return capacityBytes;
+}
+
+RouteCacheStats RouteCache::stats() const {
+    std::lock_guard<std::mutex> lk(lock);
+    RouteCacheStats s = counters;
+    s.entries = lru.size();
+    return s;
+}
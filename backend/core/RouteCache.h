@@ -0,0 +1,65 @@
+#ifndef ROUTE_CACHE_H
+#define ROUTE_CACHE_H
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Single-source shortest-path tree: dist[v] from the source, parent[v] the
+// previous node on the path (source -> itself, -1 unreached)
+struct ShortestPathTree {
+    int source = 0;
+    uint64_t topology = 0;            // graph epochs the tree was computed at
+    uint64_t metric = 0;
+    std::vector<double> dist;
+    std::vector<int> parent;
+
+    std::size_t memoryBytes() const;
+    // Node path source .. dest, empty if dest is unreachable
+    std::vector<int> pathTo(int dest) const;
+};
+
+struct RouteCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;               // includes stale lookups
+    uint64_t evictions = 0;            // dropped to stay under the cap
+    std::size_t entries = 0;
+    std::size_t bytes = 0;
+};
+
+// Bounded LRU of shortest-path trees keyed by source. Every entry carries
+// the topology/metric epochs it was computed at; a lookup with different
+// epochs drops the entry instead of serving it. Trees are handed out as
+// shared pointers, so eviction never invalidates one a caller still holds.
+// All members are safe to call concurrently.
+class RouteCache {
+private:
+    using TreePtr = std::shared_ptr<const ShortestPathTree>;
+
+    std::list<TreePtr> lru;            // most recently used first
+    std::unordered_map<int, std::list<TreePtr>::iterator> bySource;
+    std::size_t capacityBytes;
+    RouteCacheStats counters;
+    mutable std::mutex lock;
+
+    void evictTo(std::size_t limit);
+
+public:
+    explicit RouteCache(std::size_t capacityBytes = 64u << 20);
+
+    // Tree for src if cached at exactly these epochs (counts a hit/miss)
+    TreePtr find(int src, uint64_t topology, uint64_t metric);
+    // Same lookup for bulk probes: no hit/miss counted, LRU order and
+    // stale entries left alone
+    TreePtr peek(int src, uint64_t topology, uint64_t metric) const;
+    void insert(TreePtr tree);
+    void clear();
+
+    void setCapacity(std::size_t bytes);
+    std::size_t capacity() const;
+    RouteCacheStats stats() const;
+};
+#endif // ROUTE_CACHE_H
@@ -0,0 +1,224 @@
+#ifndef SEARCH_QUEUES_H
+#define SEARCH_QUEUES_H
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+// Priority queues for label-setting searches. All share one interface:
+//   bool empty() const;
+//   void push(double key, int node);
+//   std::pair<double, int> pop();      // (key, node), smallest key first
+// BinaryHeapQueue, RadixHeapQueue and DialQueue are lazy (a decreased node
+// is pushed again, callers skip stale pops); IndexedQuaternaryHeap keeps
+// one entry per node and never returns a stale one. RadixHeapQueue and
+// DialQueue are monotone: keys pushed must not be below the last pop,
+// which holds for Dijkstra on non-negative costs.
+
+enum class QueueKind {
+    BinaryHeap,         // std::priority_queue with lazy deletion
+    RadixHeap,          // monotone radix heap over the key's bit pattern
+    Dial,               // bucket queue, bucket width = cheapest edge cost
+    QuaternaryHeap      // 4-ary indexed heap with decrease-key
+};
+
+// ---------------- BINARY HEAP ----------------
+
+class BinaryHeapQueue {
+private:
+    using State = std::pair<double, int>;
+    std::priority_queue<State, std::vector<State>, std::greater<State>> pq;
+
+public:
+    bool empty() const { return pq.empty(); }
+    void push(double key, int node) { pq.push({key, node}); }
+    std::pair<double, int> pop() {
+        State top = pq.top();
+        pq.pop();
+        return top;
+    }
+};
+
+// ---------------- RADIX HEAP ----------------
+
+// Non-negative doubles order like their bit patterns read as uint64, so
+// the radix heap works on exact keys. Bucket i > 0 holds keys whose highest
+// bit differing from the last popped key is bit i - 1; each entry moves to
+// a lower bucket at most 64 times.
+class RadixHeapQueue {
+private:
+    using Entry = std::pair<uint64_t, int>;
+    std::vector<Entry> buckets[65];
+    uint64_t last = 0;
+    std::size_t count = 0;
+
+    static uint64_t bits(double key) {
+        uint64_t b;
+        std::memcpy(&b, &key, sizeof b);
+        return b;
+    }
+    static double value(uint64_t b) {
+        double key;
+        std::memcpy(&key, &b, sizeof key);
+        return key;
+    }
+    int bucketOf(uint64_t b) const {
+        uint64_t diff = b ^ last;
+        if (diff == 0) return 0;
+#if defined(__GNUC__) || defined(__clang__)
+        return 64 - __builtin_clzll(diff);
+#else
+        int bit = 0;
+        while (diff) {
+            diff >>= 1;
+            ++bit;
+        }
+        return bit;
+#endif
+    }
+
+public:
+    bool empty() const { return count == 0; }
+    void push(double key, int node) {
+        uint64_t b = bits(key + 0.0);   // folds -0.0 into +0.0
+        buckets[bucketOf(b)].push_back({b, node});
+        ++count;
+    }
+    // Smallest key without popping it (the queue stays monotone from the
+    // last pop, so keys below this one may still be pushed)
+    double minKey() const {
+        if (!buckets[0].empty()) return value(last);
+        int i = 1;
+        while (buckets[i].empty()) ++i;
+        uint64_t lowest = buckets[i][0].first;
+        for (const Entry &e : buckets[i]) lowest = std::min(lowest, e.first);
+        return value(lowest);
+    }
+    std::pair<double, int> pop() {
+        if (buckets[0].empty()) {
+            int i = 1;
+            while (buckets[i].empty()) ++i;
+            uint64_t lowest = buckets[i][0].first;
+            for (const Entry &e : buckets[i]) lowest = std::min(lowest, e.first);
+            last = lowest;
+            for (const Entry &e : buckets[i]) buckets[bucketOf(e.first)].push_back(e);
+            buckets[i].clear();
+        }
+        Entry e = buckets[0].back();
+        buckets[0].pop_back();
+        --count;
+        return {value(e.first), e.second};
+    }
+};
+
+// ---------------- DIAL ----------------
+
+// Circular array of buckets of width w <= the cheapest edge cost. A node
+// popped from bucket k can only push keys into bucket k + 1 or later, so
+// every node in the current bucket is already final and order inside a
+// bucket does not matter. maxEdge bounds the spread of live keys, which
+// sizes the ring.
+class DialQueue {
+private:
+    std::vector<std::vector<std::pair<double, int>>> ring;
+    double width;
+    uint64_t cursor = 0;               // absolute index of the current bucket
+    std::size_t count = 0;
+
+public:
+    DialQueue(double width, double maxEdge)
+        : ring(static_cast<std::size_t>(maxEdge / width) + 2), width(width) {}
+
+    // Number of buckets DialQueue(width, maxEdge) would allocate
+    static double bucketsFor(double width, double maxEdge) { return maxEdge / width + 2.0; }
+
+    bool empty() const { return count == 0; }
+    void push(double key, int node) {
+        uint64_t k = static_cast<uint64_t>(key / width);
+        if (k < cursor) k = cursor;    // rounding at a bucket edge
+        ring[k % ring.size()].push_back({key, node});
+        ++count;
+    }
+    std::pair<double, int> pop() {
+        while (ring[cursor % ring.size()].empty()) ++cursor;
+        auto &bucket = ring[cursor % ring.size()];
+        std::pair<double, int> e = bucket.back();
+        bucket.pop_back();
+        --count;
+        return e;
+    }
+};
+
+// ---------------- 4-ARY INDEXED HEAP ----------------
+
+// One slot per node: push() inserts or decreases the node's key in place,
+// so the heap never holds more than n entries.
+class IndexedQuaternaryHeap {
+private:
+    std::vector<int> heap;             // node ids, heap-ordered by key
+    std::vector<int> pos;              // node -> index in heap, -1 if absent
+    std::vector<double> key;
+
+    void place(std::size_t i, int node) {
+        heap[i] = node;
+        pos[node] = static_cast<int>(i);
+    }
+    void siftUp(std::size_t i) {
+        int node = heap[i];
+        while (i > 0) {
+            std::size_t up = (i - 1) / 4;
+            if (key[heap[up]] <= key[node]) break;
+            place(i, heap[up]);
+            i = up;
+        }
+        place(i, node);
+    }
+    void siftDown(std::size_t i) {
+        int node = heap[i];
+        std::size_t size = heap.size();
+        for (;;) {
+            std::size_t first = 4 * i + 1;
+            if (first >= size) break;
+            std::size_t best = first;
+            std::size_t stop = std::min(first + 4, size);
+            for (std::size_t c = first + 1; c < stop; ++c) {
+                if (key[heap[c]] < key[heap[best]]) best = c;
+            }
+            if (key[heap[best]] >= key[node]) break;
+            place(i, heap[best]);
+            i = best;
+        }
+        place(i, node);
+    }
+
+public:
+    explicit IndexedQuaternaryHeap(int n) : pos(n + 1, -1), key(n + 1) {}
+
+    bool empty() const { return heap.empty(); }
+    void push(double k, int node) {
+        if (pos[node] < 0) {
+            key[node] = k;
+            heap.push_back(node);
+            siftUp(heap.size() - 1);
+        } else if (k < key[node]) {
+            key[node] = k;
+            siftUp(static_cast<std::size_t>(pos[node]));
+        }
+    }
+    std::pair<double, int> pop() {
+        int top = heap[0];
+        pos[top] = -1;
+        int tail = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            heap[0] = tail;
+            siftDown(0);
+        }
+        return {key[top], top};
+    }
+};
+#endif // SEARCH_QUEUES_H
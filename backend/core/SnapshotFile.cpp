@@ -0,0 +1,311 @@
+// ===================== SnapshotFile.cpp =====================
+#include "SnapshotFile.h"
+#include <cstdio>
+
+namespace {
+
+const char MAGIC[8] = {'C', 'I', 'T', 'Y', 'S', 'N', 'A', 'P'};
+const uint32_t ENDIAN_MARK = 0x01020304;
+
+uint64_t alignUp(uint64_t at, uint64_t alignment) {
+    return (at + alignment - 1) & ~(alignment - 1);
+}
+
+} // namespace
+
+// ---------------- CHECKSUM ----------------
+
+// FNV-1a over 8-byte words like the graph file, but word i goes to lane
+// i % 4: four independent multiply chains keep up with a streaming copy
+// where one chain would not
+void SnapshotChecksum::mix(const unsigned char *data, std::size_t bytes) {
+    std::size_t count = bytes / 8;
+    std::size_t i = 0;
+    auto one = [&](std::size_t k) {
+        uint64_t w;
+        std::memcpy(&w, data + k * 8, 8);
+        uint64_t &h = lane[words++ & 3];
+        h = (h ^ w) * FNV_PRIME;
+    };
+    for (; i < count && (words & 3) != 0; ++i) one(i);
+    uint64_t h0 = lane[0], h1 = lane[1], h2 = lane[2], h3 = lane[3];
+    for (; i + 4 <= count; i += 4) {
+        uint64_t w[4];
+        std::memcpy(w, data + i * 8, 32);
+        h0 = (h0 ^ w[0]) * FNV_PRIME;
+        h1 = (h1 ^ w[1]) * FNV_PRIME;
+        h2 = (h2 ^ w[2]) * FNV_PRIME;
+        h3 = (h3 ^ w[3]) * FNV_PRIME;
+        words += 4;
+    }
+    lane[0] = h0;
+    lane[1] = h1;
+    lane[2] = h2;
+    lane[3] = h3;
+    for (; i < count; ++i) one(i);
+}
+
+uint64_t SnapshotChecksum::value() const {
+    uint64_t h = FNV_OFFSET;
+    for (uint64_t l : lane) h = (h ^ l) * FNV_PRIME;
+    return (h ^ words) * FNV_PRIME;
+}
+
+// ---------------- WRITE ----------------
+
+SnapshotWriter::SnapshotWriter(std::size_t bufferBytes)
+    : buffer(alignUp(bufferBytes < 4096 ? 4096 : bufferBytes, 64)) {}
+
+bool SnapshotWriter::open(const std::string &path) {
+    target = path;
+    tmp = path + ".tmp";
+    out.open(tmp, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        fail("cannot write " + tmp);
+        return false;
+    }
+    // Header goes in last, once the checksum is known
+    SnapshotHeader h;
+    std::memset(&h, 0, sizeof h);
+    out.write(reinterpret_cast<const char *>(&h), sizeof h);
+    at = sizeof h;
+    checksum = SnapshotChecksum();
+    return good();
+}
+
+void SnapshotWriter::fail(const std::string &message) {
+    if (failure.empty()) failure = message;
+}
+
+void SnapshotWriter::flush() {
+    if (buffered == 0 || !good()) return;
+    // Everything is padded to 8 bytes, and so is every flush but the
+    // last of an unpadded write; keep a partial word for the next one
+    std::size_t whole = buffered & ~static_cast<std::size_t>(7);
+    checksum.mix(buffer.data(), whole);
+    out.write(reinterpret_cast<const char *>(buffer.data()), static_cast<std::streamsize>(whole));
+    if (!out) fail("write failed for " + tmp);
+    std::memmove(buffer.data(), buffer.data() + whole, buffered - whole);
+    buffered -= whole;
+}
+
+void SnapshotWriter::write(const void *data, std::size_t bytes) {
+    if (!good() || bytes == 0) return;
+    const unsigned char *src = static_cast<const unsigned char *>(data);
+    at += bytes;
+
+    if (bytes >= buffer.size() / 2) {
+        // Large array: top the buffer up to a whole word, then stream the
+        // word-aligned bulk from the caller's memory
+        std::size_t head = (8 - buffered % 8) % 8;
+        if (head > bytes) head = bytes;
+        std::memcpy(buffer.data() + buffered, src, head);
+        buffered += head;
+        src += head;
+        bytes -= head;
+        flush();
+        std::size_t whole = bytes & ~static_cast<std::size_t>(7);
+        if (buffered == 0 && whole) {
+            checksum.mix(src, whole);
+            out.write(reinterpret_cast<const char *>(src), static_cast<std::streamsize>(whole));
+            if (!out) fail("write failed for " + tmp);
+            src += whole;
+            bytes -= whole;
+        }
+    }
+    while (bytes > 0 && good()) {
+        std::size_t room = buffer.size() - buffered;
+        std::size_t chunk = bytes < room ? bytes : room;
+        std::memcpy(buffer.data() + buffered, src, chunk);
+        buffered += chunk;
+        src += chunk;
+        bytes -= chunk;
+        if (buffered == buffer.size()) flush();
+    }
+}
+
+void SnapshotWriter::pad(uint64_t alignment) {
+    static const unsigned char zeros[64] = {};
+    std::size_t gap = static_cast<std::size_t>(alignUp(at, alignment) - at);
+    write(zeros, gap);
+}
+
+void SnapshotWriter::putBytes(const void *data, uint64_t count, std::size_t size) {
+    put<uint64_t>(count);
+    pad(64);
+    write(data, static_cast<std::size_t>(count * size));
+    pad(8);
+}
+
+void SnapshotWriter::putStrings(const std::vector<std::string> &values) {
+    std::vector<uint32_t> lengths(values.size());
+    std::string chars;
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        lengths[i] = static_cast<uint32_t>(values[i].size());
+        chars += values[i];
+    }
+    putArray(lengths);
+    putArray(chars.data(), chars.size());
+}
+
+void SnapshotWriter::beginSection(uint32_t tag, uint32_t version) {
+    if (inSection) endSection();
+    pad(64);
+    sections.push_back({tag, version, at, 0});
+    inSection = true;
+}
+
+void SnapshotWriter::endSection() {
+    if (!inSection) return;
+    pad(8);
+    sections.back().bytes = at - sections.back().at;
+    inSection = false;
+}
+
+bool SnapshotWriter::finish() {
+    endSection();
+    pad(64);
+    uint64_t directoryAt = at;
+    putArray(sections);
+    flush();
+    if (!good()) {
+        out.close();
+        std::remove(tmp.c_str());
+        return false;
+    }
+
+    SnapshotHeader h;
+    std::memset(&h, 0, sizeof h);
+    std::memcpy(h.magic, MAGIC, sizeof MAGIC);
+    h.version = SNAPSHOT_FILE_VERSION;
+    h.byteOrder = ENDIAN_MARK;
+    h.sectionCount = static_cast<uint32_t>(sections.size());
+    h.directoryAt = directoryAt;
+    h.fileBytes = at;
+    h.checksum = checksum.value();
+    out.seekp(0);
+    out.write(reinterpret_cast<const char *>(&h), sizeof h);
+    out.close();
+    if (!out) {
+        fail("write failed for " + tmp);
+        std::remove(tmp.c_str());
+        return false;
+    }
+#ifdef _WIN32
+    std::remove(target.c_str());     // rename does not replace there
+#endif
+    if (std::rename(tmp.c_str(), target.c_str()) != 0) {
+        fail("cannot rename " + tmp + " to " + target);
+        return false;
+    }
+    return true;
+}
+
+// ---------------- READ ----------------
+
+bool SnapshotReader::fail(const std::string &message) {
+    if (failure.empty()) failure = message;
+    return false;
+}
+
+bool SnapshotReader::open(const std::string &path, bool verify) {
+    // Every byte is read once, front to back
+    file = MappedFile::open(path, true);
+    if (!file) return fail("cannot open " + path);
+    if (file->size() < sizeof(SnapshotHeader)) return fail("file too short for a header");
+
+    SnapshotHeader h;
+    std::memcpy(&h, file->data(), sizeof h);
+    if (std::memcmp(h.magic, MAGIC, sizeof MAGIC) != 0) return fail("not a CitySense snapshot");
+    if (h.byteOrder != ENDIAN_MARK) return fail("snapshot was written with the other byte order");
+    if (h.version != SNAPSHOT_FILE_VERSION) {
+        return fail("unsupported snapshot version " + std::to_string(h.version));
+    }
+    if (h.fileBytes != file->size() || h.fileBytes % 8 != 0) {
+        return fail("file size does not match the header (truncated?)");
+    }
+    base = file->data();
+    if (verify) {
+        SnapshotChecksum sum;
+        sum.mix(base + sizeof h, file->size() - sizeof h);
+        if (sum.value() != h.checksum) return fail("checksum mismatch");
+    }
+
+    // The directory is an array like any other, at directoryAt
+    cursor = h.directoryAt;
+    limit = h.fileBytes;
+    if (h.directoryAt < sizeof h || h.directoryAt > h.fileBytes || !getArray(sections) ||
+        sections.size() != h.sectionCount) {
+        return fail("bad section directory");
+    }
+    // Sections lie between the header and the directory; the file size
+    // already bounds directoryAt, so neither test can wrap
+    for (const SnapshotSection &s : sections) {
+        if (s.at < sizeof h || s.at % 64 != 0 || s.at > h.directoryAt ||
+            s.bytes > h.directoryAt - s.at) {
+            return fail("section outside the file");
+        }
+    }
+    cursor = limit = 0;
+    return true;
+}
+
+bool SnapshotReader::hasSection(uint32_t tag) const {
+    for (const SnapshotSection &s : sections) {
+        if (s.tag == tag) return true;
+    }
+    return false;
+}
+
+bool SnapshotReader::enter(uint32_t tag, uint32_t maxVersion, uint32_t &version) {
+    if (!good()) return false;
+    for (const SnapshotSection &s : sections) {
+        if (s.tag != tag) continue;
+        if (s.version > maxVersion) {
+            return fail("section version " + std::to_string(s.version) + " is newer than this build");
+        }
+        version = s.version;
+        cursor = s.at;
+        limit = s.at + s.bytes;
+        return true;
+    }
+    char name[5] = {static_cast<char>(tag), static_cast<char>(tag >> 8),
+                    static_cast<char>(tag >> 16), static_cast<char>(tag >> 24), 0};
+    return fail(std::string("no ") + name + " section");
+}
+
+bool SnapshotReader::take(uint64_t bytes, uint64_t alignment, uint64_t &from) {
+    if (!good()) return false;
+    uint64_t start = alignUp(cursor, alignment);
+    if (start > limit || bytes > limit - start) return fail("section ends early");
+    from = start;
+    cursor = start + bytes;
+    return true;
+}
+
+const unsigned char *SnapshotReader::arrayBytes(std::size_t size, uint64_t &count) {
+    uint64_t from;
+    if (!get(count)) return nullptr;
+    if (size != 0 && count > (limit - cursor) / size) {
+        fail("array runs past its section");
+        return nullptr;
+    }
+    if (!take(count * size, 64, from)) return nullptr;
+    return base + from;
+}
+
+bool SnapshotReader::getStrings(std::vector<std::string> &values) {
+    std::vector<uint32_t> lengths;
+    const char *chars = nullptr;
+    std::size_t total = 0;
+    if (!getArray(lengths) || !view(chars, total)) return false;
+    values.clear();
+    values.reserve(lengths.size());
+    std::size_t at = 0;
+    for (uint32_t len : lengths) {
+        if (len > total - at) return fail("string table runs past its data");
+        values.emplace_back(chars + at, len);
+        at += len;
+    }
+    return true;
+}
@@ -0,0 +1,188 @@
+#ifndef SNAPSHOT_FILE_H
+#define SNAPSHOT_FILE_H
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "GraphFile.h"
+
+// Binary snapshot of live engine state, one section per component:
+//
+//   SnapshotHeader (64 bytes)
+//   sections, each on a 64-byte boundary
+//   directory: SnapshotSection x sectionCount
+//
+// A section is a sequence of 8-byte scalars and arrays; an array is its
+// element count (8 bytes) followed by the raw elements starting on the
+// next 64-byte boundary, so large arrays are copied (or used) straight
+// from the mapping. Values are in host byte order, byteOrder tells a
+// mismatched reader; checksum covers every byte after the header.
+//
+// Sections are written in order through a large buffer and the
+// directory comes last, so saving is one sequential pass; readers find
+// sections by tag and skip ones they do not know. Each section carries
+// its own version, bumped by its component when its layout changes.
+constexpr uint32_t SNAPSHOT_FILE_VERSION = 1;
+
+struct SnapshotHeader {
+    char magic[8];                 // "CITYSNAP"
+    uint32_t version;
+    uint32_t byteOrder;            // 0x01020304 as written
+    uint32_t sectionCount;
+    uint32_t reserved0;
+    uint64_t directoryAt;
+    uint64_t fileBytes;
+    uint64_t checksum;
+    uint8_t reserved[16];
+};
+static_assert(sizeof(SnapshotHeader) == 64, "snapshot header must stay 64 bytes");
+
+struct SnapshotSection {
+    uint32_t tag;                  // four characters, see snapshotTag
+    uint32_t version;
+    uint64_t at;                   // byte position of the payload
+    uint64_t bytes;
+};
+
+constexpr uint32_t snapshotTag(const char (&name)[5]) {
+    return static_cast<uint32_t>(static_cast<unsigned char>(name[0])) |
+           static_cast<uint32_t>(static_cast<unsigned char>(name[1])) << 8 |
+           static_cast<uint32_t>(static_cast<unsigned char>(name[2])) << 16 |
+           static_cast<uint32_t>(static_cast<unsigned char>(name[3])) << 24;
+}
+
+// Running checksum of a snapshot body, fed whole 8-byte words
+struct SnapshotChecksum {
+    static constexpr uint64_t FNV_OFFSET = 1469598103934665603ULL;
+    static constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+    uint64_t lane[4] = {FNV_OFFSET, FNV_OFFSET, FNV_OFFSET, FNV_OFFSET};
+    uint64_t words = 0;
+
+    void mix(const unsigned char *data, std::size_t bytes);
+    uint64_t value() const;
+};
+
+// Sections of the engine and simulation components
+constexpr uint32_t SNAPSHOT_CONGESTION = snapshotTag("CONG");   // GraphManager
+constexpr uint32_t SNAPSHOT_EMERGENCIES = snapshotTag("EMRG");  // EmergencyManager
+constexpr uint32_t SNAPSHOT_SERIES = snapshotTag("SERS");       // TimeSeriesManager
+constexpr uint32_t SNAPSHOT_SIGNALS = snapshotTag("SGNL");      // TrafficController
+constexpr uint32_t SNAPSHOT_PARKING = snapshotTag("PARK");      // ParkingManager
+constexpr uint32_t SNAPSHOT_VEHICLES = snapshotTag("VEHI");     // VehicleTable
+
+// Streams a snapshot to path (through path + ".tmp", renamed by finish,
+// so readers never map a half file). Writes go through a buffer of a few
+// MB; arrays larger than that go to the stream directly from the caller's
+// memory. The first error sticks: later calls do nothing and finish()
+// returns false with it.
+class SnapshotWriter {
+private:
+    std::ofstream out;
+    std::string target, tmp, failure;
+    std::vector<unsigned char> buffer;
+    std::size_t buffered = 0;
+    uint64_t at = 0;                       // file position of the next byte
+    SnapshotChecksum checksum;
+    std::vector<SnapshotSection> sections;
+    bool inSection = false;
+
+    void flush();
+    void write(const void *data, std::size_t bytes);
+    void pad(uint64_t alignment);
+    void putBytes(const void *data, uint64_t count, std::size_t size);
+
+public:
+    explicit SnapshotWriter(std::size_t bufferBytes = 8u << 20);
+    bool open(const std::string &path);
+    void fail(const std::string &message);
+    bool good() const { return failure.empty(); }
+    const std::string &error() const { return failure; }
+    uint64_t bytesWritten() const { return at; }
+
+    void beginSection(uint32_t tag, uint32_t version);
+    void endSection();
+
+    // Scalars of up to 8 bytes (integers, doubles, enums)
+    template <class T>
+    void put(T value) {
+        static_assert(std::is_trivially_copyable<T>::value && sizeof(T) <= 8, "8-byte scalars only");
+        unsigned char word[8] = {};
+        std::memcpy(word, &value, sizeof(T));
+        write(word, 8);
+    }
+    // Arrays of plain structs or scalars
+    template <class T>
+    void putArray(const T *data, std::size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value, "plain data only");
+        putBytes(data, count, sizeof(T));
+    }
+    template <class T>
+    void putArray(const std::vector<T> &values) { putArray(values.data(), values.size()); }
+    void putStrings(const std::vector<std::string> &values);
+
+    // Directory, header, rename; false with error() on any failure
+    bool finish();
+};
+
+// A validated snapshot, mapped read-only. enter() moves the cursor to a
+// section; get* read from it in the order they were written and fail
+// (sticky, with a message) on a short or malformed section.
+class SnapshotReader {
+private:
+    std::shared_ptr<MappedFile> file;
+    const unsigned char *base = nullptr;
+    std::vector<SnapshotSection> sections;
+    uint64_t cursor = 0, limit = 0;
+    std::string failure;
+
+    bool take(uint64_t bytes, uint64_t alignment, uint64_t &from);
+    const unsigned char *arrayBytes(std::size_t size, uint64_t &count);
+
+public:
+    // Checks magic, version, byte order, bounds and (when verify) the
+    // checksum
+    bool open(const std::string &path, bool verify = true);
+    bool fail(const std::string &message);
+    bool good() const { return failure.empty(); }
+    const std::string &error() const { return failure; }
+    uint64_t fileBytes() const { return file ? file->size() : 0; }
+
+    bool hasSection(uint32_t tag) const;
+    // False (and failed) if the section is missing or newer than
+    // maxVersion; version gets the section's own
+    bool enter(uint32_t tag, uint32_t maxVersion, uint32_t &version);
+
+    template <class T>
+    bool get(T &value) {
+        static_assert(std::is_trivially_copyable<T>::value && sizeof(T) <= 8, "8-byte scalars only");
+        uint64_t from;
+        if (!take(8, 8, from)) return false;
+        std::memcpy(&value, base + from, sizeof(T));
+        return true;
+    }
+    // Points into the mapping; valid while this reader lives
+    template <class T>
+    bool view(const T *&data, std::size_t &count) {
+        static_assert(std::is_trivially_copyable<T>::value, "plain data only");
+        uint64_t n = 0;
+        const unsigned char *p = arrayBytes(sizeof(T), n);
+        if (!p) return false;
+        data = reinterpret_cast<const T *>(p);
+        count = static_cast<std::size_t>(n);
+        return true;
+    }
+    template <class T>
+    bool getArray(std::vector<T> &values) {
+        const T *data = nullptr;
+        std::size_t count = 0;
+        if (!view(data, count)) return false;
+        values.assign(data, data + count);   // one copy, no zero fill first
+        return true;
+    }
+    bool getStrings(std::vector<std::string> &values);
+};
+#endif // SNAPSHOT_FILE_H
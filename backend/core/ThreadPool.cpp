@@ -0,0 +1,112 @@
+// ===================== ThreadPool.cpp =====================
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(int threads) {
+    if (threads <= 0) threads = static_cast<int>(std::thread::hardware_concurrency());
+    if (threads <= 0) threads = 1;
+    for (int i = 0; i < threads; ++i) blocks.emplace_back(new Block());
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lk(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto &t : workers) t.join();
+}
+
+// ---------------- SCHEDULING ----------------
+
+bool ThreadPool::takeIndex(int id, std::size_t &index) {
+    Block &own = *blocks[id];
+    std::lock_guard<std::mutex> lk(own.lock);
+    if (own.begin == own.end) return false;
+    index = own.begin++;
+    return true;
+}
+
+// Moves the back half of the largest other block into this worker's
+// (empty) block. False once no work is left anywhere.
+bool ThreadPool::steal(int id) {
+    int count = size();
+    for (;;) {
+        int victim = -1;
+        std::size_t most = 0;
+        for (int k = 1; k < count; ++k) {
+            int w = (id + k) % count;
+            std::lock_guard<std::mutex> lk(blocks[w]->lock);
+            std::size_t left = blocks[w]->end - blocks[w]->begin;
+            if (left > most) {
+                most = left;
+                victim = w;
+            }
+        }
+        if (victim < 0) return false;
+
+        std::size_t from, to;
+        {
+            Block &v = *blocks[victim];
+            std::lock_guard<std::mutex> lk(v.lock);
+            std::size_t left = v.end - v.begin;
+            if (left == 0) continue;               // drained meanwhile, rescan
+            to = v.end;
+            from = v.end - (left + 1) / 2;
+            v.end = from;
+        }
+        Block &own = *blocks[id];
+        std::lock_guard<std::mutex> lk(own.lock);
+        own.begin = from;
+        own.end = to;
+        return true;
+    }
+}
+
+void ThreadPool::workerLoop(int id) {
+    uint64_t seen = 0;
+    for (;;) {
+        const std::function<void(std::size_t, int)> *fn;
+        {
+            std::unique_lock<std::mutex> lk(lock);
+            wake.wait(lk, [&] { return stopping || round != seen; });
+            if (stopping) return;
+            seen = round;
+            fn = body;
+        }
+
+        std::size_t i;
+        for (;;) {
+            if (takeIndex(id, i)) {
+                (*fn)(i, id);
+            } else if (!steal(id)) {
+                break;
+            }
+        }
+
+        std::lock_guard<std::mutex> lk(lock);
+        if (--busy == 0) done.notify_all();
+    }
+}
+
+void ThreadPool::parallelFor(std::size_t n,
+                             const std::function<void(std::size_t, int)> &fn) {
+    if (n == 0) return;
+    std::lock_guard<std::mutex> serial(loopLock);
+
+    std::unique_lock<std::mutex> lk(lock);
+    std::size_t count = blocks.size();
+    for (std::size_t w = 0; w < count; ++w) {
+        std::lock_guard<std::mutex> blk(blocks[w]->lock);
+        blocks[w]->begin = n * w / count;
+        blocks[w]->end = n * (w + 1) / count;
+    }
+    body = &fn;
+    busy = size();
+    ++round;
+    wake.notify_all();
+    done.wait(lk, [&] { return busy == 0; });
+    body = nullptr;
+}
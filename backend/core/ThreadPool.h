@@ -0,0 +1,55 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for data-parallel loops.
+// parallelFor() splits the index range into one contiguous block per
+// worker; a worker that runs out steals the back half of the fullest
+// remaining block, so uneven per-index costs still balance. The worker id
+// passed to the body (0 .. size()-1) lets callers keep per-thread scratch
+// buffers. parallelFor blocks until every index has run; one loop runs at
+// a time.
+class ThreadPool {
+private:
+    // Indices [begin, end) still owned by one worker. The owner takes from
+    // the front, thieves split off the back.
+    struct alignas(64) Block {
+        std::mutex lock;
+        std::size_t begin = 0;
+        std::size_t end = 0;
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<Block>> blocks;
+    std::mutex lock;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::mutex loopLock;              // serializes parallelFor callers
+
+    const std::function<void(std::size_t, int)> *body = nullptr;
+    int busy = 0;
+    uint64_t round = 0;
+    bool stopping = false;
+
+    void workerLoop(int id);
+    bool takeIndex(int id, std::size_t &index);
+    bool steal(int id);
+
+public:
+    // threads <= 0 uses the hardware concurrency
+    explicit ThreadPool(int threads = 0);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    int size() const { return static_cast<int>(workers.size()); }
+    void parallelFor(std::size_t n, const std::function<void(std::size_t index, int worker)> &fn);
+};
+#endif // THREAD_POOL_H
@@ -1,35 +1,345 @@
 #include "TimeSeriesManager.h"
+#include "SnapshotFile.h"
 #include <algorithm>
-TimeSeriesManager::TimeSeriesManager(int slots) {
-    init(slots);
-}
-void TimeSeriesManager::init(int slots) {
-    if (slots <= 0) slots = 1;
-    n = 1;
-    while (n < slots) n <<= 1;   
-    tree.assign(2 * n, 0);       
-}
-void TimeSeriesManager::pointUpdate(int idx, int delta) {
-    if (idx < 0 || idx >= n) return;  
-    int pos = idx + n;
-    tree[pos] += delta;
-    for (pos >>= 1; pos >= 1; pos >>= 1) {
-        tree[pos] = tree[pos * 2] + tree[pos * 2 + 1];
-        if (pos == 1) break;
-    }
-}
-int TimeSeriesManager::rangeQuery(int l, int r) const {
-    if (l > r) std::swap(l, r);
-    l = std::max(l, 0);
-    r = std::min(r, n - 1);
-    int res = 0;
-    int L = l + n;
-    int R = r + n;
-    while (L <= R) {
-        if (L & 1) res += tree[L++];      // L is a right child
-        if (!(R & 1)) res += tree[R--];   // R is a left child
-        L >>= 1;
-        R >>= 1;
-    }
-    return res;
+
+TimeSeriesManager::TimeSeriesManager(int retentionDays)
+    : ring(static_cast<std::size_t>(std::max(retentionDays, 1))) {}
+
+uint32_t TimeSeriesManager::seriesId(SeriesKind kind, int id) {
+    auto it = seriesIds.find(keyOf(kind, id));
+    if (it != seriesIds.end()) return it->second;
+    uint32_t series = static_cast<uint32_t>(seriesTotal++);
+    seriesIds.emplace(keyOf(kind, id), series);
+    return series;
+}
+
+int64_t TimeSeriesManager::findSeries(SeriesKind kind, int id) const {
+    auto it = seriesIds.find(keyOf(kind, id));
+    return it == seriesIds.end() ? -1 : static_cast<int64_t>(it->second);
+}
+
+// ---------------- DAY SEGMENTS ----------------
+
+TimeSeriesManager::DaySegment *TimeSeriesManager::writableSegment(int64_t day) {
+    int64_t days = static_cast<int64_t>(ring.size());
+    if (day < 0 || (newestDay >= 0 && day <= newestDay - days)) return nullptr;
+    if (day > newestDay) {
+        // Recycle the slots of every day the window moves past
+        int64_t first = std::max(newestDay + 1, day - days + 1);
+        for (int64_t d = first; d <= day; ++d) {
+            DaySegment &seg = ring[d % days];
+            seg.day = d;
+            seg.columnOf.clear();
+            seg.data.clear();
+            seg.tiers.clear();
+            seg.written.clear();
+        }
+        newestDay = day;
+    }
+    return &ring[day % days];
+}
+
+bool TimeSeriesManager::column(int64_t day, uint32_t series, ColumnView &view) const {
+    const DaySegment &seg = ring[day % static_cast<int64_t>(ring.size())];
+    if (seg.day != day || series >= seg.columnOf.size()) return false;
+    uint32_t c = seg.columnOf[series];
+    if (c == 0) return false;
+    std::size_t k = c - 1;
+    view.minutes = seg.data.data() + k * COLUMN;
+    view.tiers = seg.tiers.data() + k * TIER_NODES;
+    view.written = seg.written.data() + k * MASK_WORDS;
+    return true;
+}
+
+bool TimeSeriesManager::add(uint32_t series, int64_t minute, int64_t delta) {
+    if (minute < 0 || series >= seriesTotal) return false;
+    DaySegment *seg = writableSegment(minute / MINUTES_PER_DAY);
+    if (!seg) return false;
+
+    if (seg->columnOf.size() <= series) seg->columnOf.resize(seriesTotal, 0);
+    uint32_t &c = seg->columnOf[series];
+    if (c == 0) {
+        seg->data.resize(seg->data.size() + COLUMN, 0);
+        seg->tiers.resize(seg->tiers.size() + TIER_NODES);
+        seg->written.resize(seg->written.size() + MASK_WORDS, 0);
+        c = static_cast<uint32_t>(seg->data.size() / COLUMN);
+    }
+    std::size_t k = c - 1;
+    int64_t *col = seg->data.data() + k * COLUMN;
+    SeriesAggregate *tiers = seg->tiers.data() + k * TIER_NODES;
+    uint64_t *written = seg->written.data() + k * MASK_WORDS;
+
+    int offset = static_cast<int>(minute % MINUTES_PER_DAY);
+    uint64_t bit = uint64_t(1) << (offset % 64);
+    bool wasWritten = (written[offset / 64] & bit) != 0;
+    int64_t before = col[offset];
+    col[offset] += delta;
+    for (int b = offset / BLOCK; b < BLOCKS; ++b) col[MINUTES_PER_DAY + b] += delta;
+    written[offset / 64] |= bit;
+
+    // The five-minute, hour and day nodes above this minute each see one
+    // value replaced (or added). Patch them in place; only when the old
+    // value was a node's minimum (maximum) and went up (down) is the node
+    // rebuilt from its children.
+    int64_t after = col[offset];
+    auto patch = [&](SeriesAggregate &node) {
+        node.sum += delta;
+        if (!wasWritten) ++node.count;
+        bool stale = wasWritten && ((before == node.min && after > before) ||
+                                    (before == node.max && after < before));
+        if (after < node.min) node.min = after;
+        if (after > node.max) node.max = after;
+        return !stale;
+    };
+    auto rebuild = [](SeriesAggregate &node, const SeriesAggregate *child, int count) {
+        node = SeriesAggregate();
+        for (int i = 0; i < count; ++i) node.merge(child[i]);
+    };
+
+    int five = offset / 5;
+    if (!patch(tiers[five])) {
+        SeriesAggregate node;
+        for (int m = five * 5; m < five * 5 + 5; ++m) {
+            if (written[m / 64] >> (m % 64) & 1) node.include(col[m]);
+        }
+        tiers[five] = node;
+    }
+    int hour = offset / 60;
+    if (!patch(tiers[FIVE_MIN_NODES + hour])) {
+        rebuild(tiers[FIVE_MIN_NODES + hour], tiers + hour * 12, 12);
+    }
+    if (!patch(tiers[TIER_NODES - 1])) {
+        rebuild(tiers[TIER_NODES - 1], tiers + FIVE_MIN_NODES, HOUR_NODES);
+    }
+    return true;
+}
+
+// ---------------- QUERIES ----------------
+
+namespace {
+
+// Four independent accumulators so the loop vectorizes
+int64_t sumRun(const int64_t *p, int count) {
+    int64_t a0 = 0, a1 = 0, a2 = 0, a3 = 0;
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        a0 += p[i];
+        a1 += p[i + 1];
+        a2 += p[i + 2];
+        a3 += p[i + 3];
+    }
+    for (; i < count; ++i) a0 += p[i];
+    return (a0 + a1) + (a2 + a3);
+}
+
+} // namespace
+
+// Sum of minutes [0, m] of one day column: the block prefix plus or
+// minus the shorter half of m's block
+int64_t TimeSeriesManager::prefixDay(const int64_t *col, int m) {
+    if (m < 0) return 0;
+    int b = m / BLOCK;
+    int inBlock = m - b * BLOCK;
+    if (inBlock < BLOCK / 2) {
+        int64_t before = b > 0 ? col[MINUTES_PER_DAY + b - 1] : 0;
+        return before + sumRun(col + b * BLOCK, inBlock + 1);
+    }
+    return col[MINUTES_PER_DAY + b] - sumRun(col + m + 1, BLOCK - 1 - inBlock);
+}
+
+bool TimeSeriesManager::clampDays(int64_t &from, int64_t &to, int64_t &d0, int64_t &d1) const {
+    if (from > to) std::swap(from, to);
+    if (newestDay < 0) return false;
+    int64_t oldest = std::max<int64_t>(newestDay - static_cast<int64_t>(ring.size()) + 1, 0);
+    from = std::max(from, oldest * MINUTES_PER_DAY);
+    to = std::min(to, (newestDay + 1) * MINUTES_PER_DAY - 1);
+    if (from > to) return false;
+    d0 = from / MINUTES_PER_DAY;
+    d1 = to / MINUTES_PER_DAY;
+    return true;
+}
+
+bool TimeSeriesManager::retainedDays(int64_t &first, int64_t &last) const {
+    if (newestDay < 0) return false;
+    first = std::max<int64_t>(newestDay - static_cast<int64_t>(ring.size()) + 1, 0);
+    last = newestDay;
+    return true;
+}
+
+int64_t TimeSeriesManager::rangeSum(uint32_t series, int64_t from, int64_t to) const {
+    int64_t d0, d1;
+    if (!clampDays(from, to, d0, d1)) return 0;
+    int64_t sum = 0;
+    for (int64_t d = d0; d <= d1; ++d) {
+        ColumnView col;
+        if (!column(d, series, col)) continue;
+        int first = d == d0 ? static_cast<int>(from % MINUTES_PER_DAY) : 0;
+        int last = d == d1 ? static_cast<int>(to % MINUTES_PER_DAY) : MINUTES_PER_DAY - 1;
+        sum += prefixDay(col.minutes, last) - prefixDay(col.minutes, first - 1);
+    }
+    return sum;
+}
+
+void TimeSeriesManager::rangeSums(const std::vector<uint32_t> &series, int64_t from, int64_t to,
+                                  std::vector<int64_t> &out) const {
+    out.assign(series.size(), 0);
+    int64_t d0, d1;
+    if (!clampDays(from, to, d0, d1)) return;
+    // Day-major, so each segment's columns are visited together
+    for (int64_t d = d0; d <= d1; ++d) {
+        int first = d == d0 ? static_cast<int>(from % MINUTES_PER_DAY) : 0;
+        int last = d == d1 ? static_cast<int>(to % MINUTES_PER_DAY) : MINUTES_PER_DAY - 1;
+        for (std::size_t i = 0; i < series.size(); ++i) {
+            ColumnView col;
+            if (column(d, series[i], col)) {
+                out[i] += prefixDay(col.minutes, last) - prefixDay(col.minutes, first - 1);
+            }
+        }
+    }
+}
+
+int64_t TimeSeriesManager::rangeSum(const std::vector<uint32_t> &series, int64_t from,
+                                    int64_t to) const {
+    std::vector<int64_t> sums;
+    rangeSums(series, from, to, sums);
+    int64_t total = 0;
+    for (int64_t s : sums) total += s;
+    return total;
+}
+
+// ---------------- AGGREGATES ----------------
+
+void TimeSeriesManager::aggregateMinutes(const ColumnView &col, int first, int last,
+                                         SeriesAggregate &agg) {
+    for (int m = first; m <= last; ++m) {
+        if (col.written[m / 64] >> (m % 64) & 1) agg.include(col.minutes[m]);
+    }
+}
+
+// Minutes [first, last] of one day: whole hours from the hour tier, the
+// edges from five-minute nodes, what is left minute by minute
+void TimeSeriesManager::aggregateDay(const ColumnView &col, int first, int last,
+                                     SeriesAggregate &agg) {
+    if (first == 0 && last == MINUTES_PER_DAY - 1) {
+        agg.merge(col.tiers[TIER_NODES - 1]);
+        return;
+    }
+    int h0 = (first + 59) / 60, h1 = (last + 1) / 60;
+    int f0 = (first + 4) / 5, f1 = (last + 1) / 5;
+    if (h0 < h1) {
+        for (int h = h0; h < h1; ++h) agg.merge(col.tiers[FIVE_MIN_NODES + h]);
+        for (int f = f0; f < h0 * 12; ++f) agg.merge(col.tiers[f]);
+        for (int f = h1 * 12; f < f1; ++f) agg.merge(col.tiers[f]);
+    } else if (f0 < f1) {
+        for (int f = f0; f < f1; ++f) agg.merge(col.tiers[f]);
+    } else {
+        aggregateMinutes(col, first, last, agg);
+        return;
+    }
+    aggregateMinutes(col, first, f0 * 5 - 1, agg);
+    aggregateMinutes(col, f1 * 5, last, agg);
+}
+
+SeriesAggregate TimeSeriesManager::aggregate(const std::vector<uint32_t> &series, int64_t from,
+                                             int64_t to) const {
+    SeriesAggregate agg;
+    int64_t d0, d1;
+    if (!clampDays(from, to, d0, d1)) return agg;
+    for (int64_t d = d0; d <= d1; ++d) {
+        int first = d == d0 ? static_cast<int>(from % MINUTES_PER_DAY) : 0;
+        int last = d == d1 ? static_cast<int>(to % MINUTES_PER_DAY) : MINUTES_PER_DAY - 1;
+        for (uint32_t s : series) {
+            ColumnView col;
+            if (column(d, s, col)) aggregateDay(col, first, last, agg);
+        }
+    }
+    return agg;
+}
+
+SeriesAggregate TimeSeriesManager::aggregate(uint32_t series, int64_t from, int64_t to) const {
+    SeriesAggregate agg;
+    int64_t d0, d1;
+    if (!clampDays(from, to, d0, d1)) return agg;
+    for (int64_t d = d0; d <= d1; ++d) {
+        int first = d == d0 ? static_cast<int>(from % MINUTES_PER_DAY) : 0;
+        int last = d == d1 ? static_cast<int>(to % MINUTES_PER_DAY) : MINUTES_PER_DAY - 1;
+        ColumnView col;
+        if (column(d, series, col)) aggregateDay(col, first, last, agg);
+    }
+    return agg;
+}
+
+// ---------------- SNAPSHOT ----------------
+
+namespace {
+constexpr uint32_t SERIES_VERSION = 1;
+}
+
+void TimeSeriesManager::saveState(SnapshotWriter &out) const {
+    // (kind, id) of each series, by series id
+    std::vector<uint64_t> keys(seriesTotal);
+    for (const auto &kv : seriesIds) keys[kv.second] = kv.first;
+
+    out.beginSection(SNAPSHOT_SERIES, SERIES_VERSION);
+    out.put<uint64_t>(ring.size());
+    out.put(newestDay);
+    out.putArray(keys);
+    for (const DaySegment &seg : ring) {
+        out.put(seg.day);
+        out.putArray(seg.columnOf);
+        out.putArray(seg.data);
+        out.putArray(seg.tiers);
+        out.putArray(seg.written);
+    }
+    out.endSection();
+}
+
+bool TimeSeriesManager::loadState(SnapshotReader &in) {
+    uint32_t version = 0;
+    uint64_t days = 0;
+    int64_t newest = -1;
+    std::vector<uint64_t> keys;
+    if (!in.enter(SNAPSHOT_SERIES, SERIES_VERSION, version) || !in.get(days) || !in.get(newest) ||
+        !in.getArray(keys)) {
+        return false;
+    }
+    if (days == 0 || days > 100000) return in.fail("bad time series retention");
+    std::size_t total = keys.size();
+
+    std::vector<DaySegment> segments(static_cast<std::size_t>(days));
+    for (std::size_t slot = 0; slot < segments.size(); ++slot) {
+        DaySegment &seg = segments[slot];
+        if (!in.get(seg.day) || !in.getArray(seg.columnOf) || !in.getArray(seg.data) ||
+            !in.getArray(seg.tiers) || !in.getArray(seg.written)) {
+            return false;
+        }
+        std::size_t columns = seg.data.size() / COLUMN;
+        if (seg.data.size() != columns * COLUMN || seg.tiers.size() != columns * TIER_NODES ||
+            seg.written.size() != columns * MASK_WORDS || seg.columnOf.size() > total ||
+            (seg.day >= 0 && (seg.day > newest || static_cast<uint64_t>(seg.day) % days != slot))) {
+            return in.fail("time series day " + std::to_string(seg.day) + " is inconsistent");
+        }
+        for (uint32_t c : seg.columnOf) {
+            if (c > columns) return in.fail("time series column out of range");
+        }
+    }
+
+    std::unordered_map<uint64_t, uint32_t> index;
+    index.reserve(total);
+    for (std::size_t i = 0; i < total; ++i) index[keys[i]] = static_cast<uint32_t>(i);
+    ring.swap(segments);
+    newestDay = newest;
+    seriesIds.swap(index);
+    seriesTotal = total;
+    return true;
+}
+
+std::size_t TimeSeriesManager::memoryBytes() const {
+    std::size_t bytes = seriesIds.size() * (sizeof(uint64_t) + sizeof(uint32_t) + 2 * sizeof(void *));
+    for (const auto &seg : ring) {
+        bytes += seg.columnOf.capacity() * sizeof(uint32_t) + seg.data.capacity() * sizeof(int64_t) +
+                 seg.tiers.capacity() * sizeof(SeriesAggregate) +
+                 seg.written.capacity() * sizeof(uint64_t);
+    }
+    return bytes;
 }
@@ -1,18 +1,142 @@
 #ifndef TIMESERIES_MANAGER_H
 #define TIMESERIES_MANAGER_H
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
 #include <vector>
-// Simple segment tree for point updates & range queries
+
+class SnapshotWriter;
+class SnapshotReader;
+
+// What a series counts. Ids are the caller's (edge index, intersection
+// node, parking zone number); City has the single id 0.
+enum class SeriesKind : uint8_t {
+    City,
+    Edge,
+    Intersection,
+    ParkingZone
+};
+
+// Sum / min / max over the written minutes of a range. A minute counts
+// once anything was added to it, even if it nets out to 0; minutes never
+// written are left out of min, max and count.
+struct SeriesAggregate {
+    int64_t sum = 0;
+    int64_t min = std::numeric_limits<int64_t>::max();
+    int64_t max = std::numeric_limits<int64_t>::min();
+    int64_t count = 0;
+
+    void include(int64_t value) {
+        sum += value;
+        if (value < min) min = value;
+        if (value > max) max = value;
+        ++count;
+    }
+    void merge(const SeriesAggregate &o) {
+        sum += o.sum;
+        if (o.min < min) min = o.min;
+        if (o.max > max) max = o.max;
+        count += o.count;
+    }
+    double mean() const { return count ? static_cast<double>(sum) / count : 0.0; }
+};
+
+// Columnar store of per-minute 64-bit counters, one series per road,
+// intersection or parking zone.
+//
+// Time is an absolute minute, minute / 1440 is its day. The newest
+// retentionDays days live in a ring of day segments; writing into a newer
+// day recycles the oldest ones. Within a segment a series gets a column
+// on its first write: 1440 minute counters followed by the prefix sums of
+// its 45 blocks of 32 minutes. A range sum is two block prefixes, each
+// corrected by a run of at most 16 contiguous minutes; a write touches at
+// most 45 prefixes. Each column also carries aggregate tiers (288
+// five-minute, 24 hourly and one daily node), rebuilt bottom-up on every
+// write; aggregate() covers a range with the coarsest nodes that fit it
+// exactly, so a week is ~7 day nodes plus at most a few dozen edge nodes
+// instead of 10k minutes. A series with no traffic that day costs only
+// its 4-byte column index.
 class TimeSeriesManager {
+public:
+    static constexpr int MINUTES_PER_DAY = 1440;
+    static constexpr int BLOCK = 32;
+    static constexpr int BLOCKS = MINUTES_PER_DAY / BLOCK;
+    static constexpr int COLUMN = MINUTES_PER_DAY + BLOCKS;   // counters per column
+    static constexpr int FIVE_MIN_NODES = MINUTES_PER_DAY / 5;
+    static constexpr int HOUR_NODES = 24;
+    static constexpr int TIER_NODES = FIVE_MIN_NODES + HOUR_NODES + 1;
+    static constexpr int MASK_WORDS = (MINUTES_PER_DAY + 63) / 64;
+
 private:
-    int n;                    
-    std::vector<int> tree;    // segment tree array
+    struct DaySegment {
+        int64_t day = -1;                  // -1 = unused
+        std::vector<uint32_t> columnOf;    // series -> column + 1, 0 = none
+        std::vector<int64_t> data;         // columns * COLUMN
+        std::vector<SeriesAggregate> tiers; // columns * TIER_NODES
+        std::vector<uint64_t> written;     // columns * MASK_WORDS, minute bits
+    };
+
+    // One column of a segment, all three parts
+    struct ColumnView {
+        const int64_t *minutes;
+        const SeriesAggregate *tiers;
+        const uint64_t *written;
+    };
+
+    std::vector<DaySegment> ring;
+    int64_t newestDay = -1;
+    std::unordered_map<uint64_t, uint32_t> seriesIds;   // (kind, id) -> series
+    std::size_t seriesTotal = 0;
+
+    static uint64_t keyOf(SeriesKind kind, int id) {
+        return (static_cast<uint64_t>(kind) << 32) | static_cast<uint32_t>(id);
+    }
+    DaySegment *writableSegment(int64_t day);
+    bool column(int64_t day, uint32_t series, ColumnView &view) const;
+    // Retained part of [from, to] as days [d0, d1]; false if none
+    bool clampDays(int64_t &from, int64_t &to, int64_t &d0, int64_t &d1) const;
+    static int64_t prefixDay(const int64_t *col, int m);
+    static void aggregateDay(const ColumnView &col, int first, int last, SeriesAggregate &agg);
+    static void aggregateMinutes(const ColumnView &col, int first, int last, SeriesAggregate &agg);
+
 public:
-    // Initialize with required number of time slots
-    TimeSeriesManager(int slots = 1440);
-    void init(int slots);
-    // Increase/decrease a single time slot value
-    void pointUpdate(int idx, int delta);
-    // Query sum in range [l, r]
-    int rangeQuery(int l, int r) const;
+    explicit TimeSeriesManager(int retentionDays = 7);
+
+    // Dense id of a series, created on first use
+    uint32_t seriesId(SeriesKind kind, int id);
+    // -1 if the series was never created
+    int64_t findSeries(SeriesKind kind, int id) const;
+    std::size_t seriesCount() const { return seriesTotal; }
+    int retentionDays() const { return static_cast<int>(ring.size()); }
+    // Days currently held, [first, last]; false before the first write
+    bool retainedDays(int64_t &first, int64_t &last) const;
+
+    // Adds delta at the given minute. False (nothing stored) for a
+    // negative minute or one older than the retained window.
+    bool add(uint32_t series, int64_t minute, int64_t delta);
+    bool add(SeriesKind kind, int id, int64_t minute, int64_t delta) {
+        return add(seriesId(kind, id), minute, delta);
+    }
+
+    // Sums over minutes [from, to] (swapped if reversed); minutes outside
+    // the retained window count as 0
+    int64_t rangeSum(uint32_t series, int64_t from, int64_t to) const;
+    // Total over several series
+    int64_t rangeSum(const std::vector<uint32_t> &series, int64_t from, int64_t to) const;
+    // One sum per series, into out (resized to series.size())
+    void rangeSums(const std::vector<uint32_t> &series, int64_t from, int64_t to,
+                   std::vector<int64_t> &out) const;
+
+    // Sum / min / max / count over minutes [from, to], see SeriesAggregate
+    SeriesAggregate aggregate(uint32_t series, int64_t from, int64_t to) const;
+    SeriesAggregate aggregate(const std::vector<uint32_t> &series, int64_t from, int64_t to) const;
+
+    // Every retained day segment as a snapshot section; loading replaces
+    // the store (and its retention) with the saved one
+    void saveState(SnapshotWriter &out) const;
+    bool loadState(SnapshotReader &in);
+
+    std::size_t memoryBytes() const;
 };
 #endif // TIMESERIES_MANAGER_H
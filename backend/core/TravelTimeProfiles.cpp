@@ -0,0 +1,157 @@
+// ===================== TravelTimeProfiles.cpp =====================
+#include "TravelTimeProfiles.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <unordered_map>
+
+namespace {
+
+constexpr double STEPS_PER_UNIT = 16.0;   // quantization: m = 1 + q / 16
+
+// Raises breakpoints until the curve never drops by more than a slot's
+// worth of minutes between neighbours (wrapping at midnight)
+void makeFifo(uint8_t *q, int slots, double cost, double slotMinutes) {
+    if (cost <= 0.0) return;
+    double drop = std::floor(slotMinutes / cost * STEPS_PER_UNIT);
+    if (drop >= 255.0) return;
+    int maxDrop = static_cast<int>(drop);
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (int i = 0; i < slots; ++i) {
+            int next = (i + 1) % slots;
+            int floorValue = q[i] - maxDrop;
+            if (q[next] < floorValue) {
+                q[next] = static_cast<uint8_t>(floorValue);
+                changed = true;
+            }
+        }
+    }
+}
+
+} // namespace
+
+void TravelTimeProfiles::build(const GraphManager &graph, const TimeSeriesManager &history,
+                               double capacity) {
+    graph.freeze();
+    const CsrGraph &g = graph.forwardGraph();
+    uint32_t edges = g.edgeCount();
+
+    profiles.assign(SLOTS, 0);    // profile 0: flat, free flow all day
+    edgeProfile.assign(edges, 0);
+    std::unordered_map<std::string, uint32_t> shared;
+    shared.emplace(std::string(SLOTS, '\0'), 0);
+
+    int64_t firstDay = 0, lastDay = -1;
+    history.retainedDays(firstDay, lastDay);
+    uint8_t curve[SLOTS];
+
+    for (uint32_t i = 0; i < edges; ++i) {
+        if (g.ids[i] == 0) continue;
+        int64_t series = history.findSeries(SeriesKind::Edge, g.ids[i]);
+        if (series < 0) continue;
+
+        for (int k = 0; k < SLOTS; ++k) {
+            SeriesAggregate agg;
+            for (int64_t d = firstDay; d <= lastDay; ++d) {
+                int64_t from = d * TimeSeriesManager::MINUTES_PER_DAY + k * SLOT_MINUTES;
+                agg.merge(history.aggregate(static_cast<uint32_t>(series), from,
+                                            from + SLOT_MINUTES - 1));
+            }
+            double load = std::max(agg.mean(), 0.0) / capacity;
+            double m = 1.0 + 0.15 * load * load * load * load;
+            double steps = std::round((m - 1.0) * STEPS_PER_UNIT);
+            curve[k] = static_cast<uint8_t>(std::min(steps, 255.0));
+        }
+        makeFifo(curve, SLOTS, graph.edgeCost(i), SLOT_MINUTES);
+
+        std::string key(reinterpret_cast<const char *>(curve), SLOTS);
+        auto it = shared.find(key);
+        if (it == shared.end()) {
+            uint32_t id = static_cast<uint32_t>(profiles.size() / SLOTS);
+            profiles.insert(profiles.end(), curve, curve + SLOTS);
+            it = shared.emplace(std::move(key), id).first;
+        }
+        edgeProfile[i] = it->second;
+    }
+
+    profiles.shrink_to_fit();
+    builtTopology = graph.topologyVersion();
+    builtMetric = graph.metricVersion();
+    built = true;
+}
+
+double TravelTimeProfiles::multiplier(uint32_t p, double t) const {
+    double slot = std::fmod(t, static_cast<double>(TimeSeriesManager::MINUTES_PER_DAY));
+    if (slot < 0) slot += TimeSeriesManager::MINUTES_PER_DAY;
+    slot /= SLOT_MINUTES;
+    int k = static_cast<int>(slot);
+    if (k >= SLOTS) k = SLOTS - 1;
+    double frac = slot - k;
+    const uint8_t *q = profiles.data() + static_cast<std::size_t>(p) * SLOTS;
+    double steps = q[k] * (1.0 - frac) + q[(k + 1) % SLOTS] * frac;
+    return 1.0 + steps / STEPS_PER_UNIT;
+}
+
+double TravelTimeProfiles::travelTime(const GraphManager &graph, uint32_t i, double t) const {
+    uint32_t p = i < edgeProfile.size() ? edgeProfile[i] : 0;
+    double cost = graph.edgeCost(i);
+    return p == 0 ? cost : cost * multiplier(p, t);
+}
+
+// ---------------- TIME-DEPENDENT DIJKSTRA ----------------
+
+// Labels are arrival times; with FIFO roads the earliest arrival at a
+// node is also the best time to leave it, so plain label setting is exact.
+std::vector<int> TravelTimeProfiles::shortestPath(const GraphManager &graph, int src, int dest,
+                                                  double depart, SearchStats *stats) const {
+    const double INF = std::numeric_limits<double>::infinity();
+    int n = graph.nodeCount();
+    if (stats) *stats = SearchStats();
+    if (src < 1 || src > n || dest < 1 || dest > n) {
+        if (stats) stats->cost = INF;
+        return {};
+    }
+    graph.freeze();
+    const CsrGraph &g = graph.forwardGraph();
+
+    std::vector<double> arrival(n + 1, INF);
+    std::vector<int> parent(n + 1, -1);
+    BinaryHeapQueue pq;
+    arrival[src] = depart;
+    parent[src] = src;
+    pq.push(depart, src);
+    int settled = 0;
+
+    while (!pq.empty()) {
+        auto [t, u] = pq.pop();
+        if (t > arrival[u]) continue;
+        ++settled;
+        if (u == dest) break;
+        for (uint32_t i = g.begin(u); i < g.end(u); ++i) {
+            int v = static_cast<int>(g.targets[i]);
+            double at = t + travelTime(graph, i, t);
+            if (at < arrival[v]) {
+                arrival[v] = at;
+                parent[v] = u;
+                pq.push(at, v);
+            }
+        }
+    }
+
+    if (stats) {
+        stats->settled = settled;
+        stats->cost = arrival[dest] - depart;
+    }
+    if (arrival[dest] == INF) return {};
+    std::vector<int> path;
+    for (int v = dest; v != src; v = parent[v]) path.push_back(v);
+    path.push_back(src);
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+std::size_t TravelTimeProfiles::memoryBytes() const {
+    return profiles.capacity() * sizeof(uint8_t) + edgeProfile.capacity() * sizeof(uint32_t);
+}
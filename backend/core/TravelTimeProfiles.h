@@ -0,0 +1,62 @@
+#ifndef TRAVEL_TIME_PROFILES_H
+#define TRAVEL_TIME_PROFILES_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "GraphManager.h"
+#include "TimeSeriesManager.h"
+
+// Time-dependent travel times for every road, built from traffic history.
+//
+// A road's travel time when entering it at minute t of the day is
+// edgeCost x m(t), where m is piecewise linear between 96 breakpoints (one
+// every 15 minutes, wrapping at midnight). Costs are taken as minutes of
+// travel at free flow. Breakpoints are quantized to a byte
+// (m = 1 + q / 16, so 1.0 .. ~16.9), and roads whose quantized curves
+// come out equal share one profile: a road costs 4 bytes plus its share
+// of a 96-byte profile, and every road without history shares the flat one.
+//
+// m at a breakpoint comes from the road's Edge series (SeriesKind::Edge,
+// keyed by the road id; roads with id 0 have none): the mean vehicles per
+// minute q in that quarter hour over all retained days, through the BPR
+// curve 1 + 0.15 (q / capacity)^4. Each curve is then raised where it
+// falls faster than one minute per minute, so leaving later never
+// arrives earlier (FIFO) and the time-dependent Dijkstra stays exact.
+class TravelTimeProfiles {
+public:
+    static constexpr int SLOTS = 96;
+    static constexpr int SLOT_MINUTES = TimeSeriesManager::MINUTES_PER_DAY / SLOTS;
+
+private:
+    std::vector<uint8_t> profiles;    // SLOTS quantized breakpoints per profile
+    std::vector<uint32_t> edgeProfile; // forward CSR edge -> profile
+    uint64_t builtTopology = 0;
+    uint64_t builtMetric = 0;
+    bool built = false;
+
+    // Multiplier of profile p when entering at minute-of-day t
+    double multiplier(uint32_t p, double t) const;
+
+public:
+    // capacity: vehicles per minute at which a road's time is 1.15x free flow
+    void build(const GraphManager &graph, const TimeSeriesManager &history,
+               double capacity = 30.0);
+
+    // Built for the graph's current roads and congestion
+    bool isCurrent(const GraphManager &graph) const {
+        return built && builtTopology == graph.topologyVersion() &&
+               builtMetric == graph.metricVersion();
+    }
+
+    // Minutes to traverse forward CSR edge i when entering at absolute minute t
+    double travelTime(const GraphManager &graph, uint32_t i, double t) const;
+
+    // Fastest path when leaving src at absolute minute depart; stats->cost
+    // is the travel time. Safe to run concurrently.
+    std::vector<int> shortestPath(const GraphManager &graph, int src, int dest, double depart,
+                                  SearchStats *stats = nullptr) const;
+
+    std::size_t profileCount() const { return profiles.size() / SLOTS; }
+    std::size_t memoryBytes() const;
+};
+#endif // TRAVEL_TIME_PROFILES_H
@@ -0,0 +1,336 @@
+// ===================== MesoSimulator.cpp =====================
+#include "MesoSimulator.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+MesoSimulator::MesoSimulator(const GraphManager &g, MesoParams p) : graph(g), params(p) {
+    params.lanes = std::max(params.lanes, 1);
+    graph.freeze();
+    csr = &graph.forwardGraph();
+    buildLinks();
+}
+
+// ---------------- LINKS ----------------
+
+void MesoSimulator::buildLinks() {
+    uint32_t links = csr->edgeCount();
+    uint32_t nodes = csr->nodeCount();
+    travel.assign(links, 0.0f);
+    headway.assign(links, 0.0f);
+    capacity.assign(links, 1);
+    ringBase.assign(links, 0);
+    ringHead.assign(links, 0);
+    ringCount.assign(links, 0);
+    nextExit.assign(links, 0.0);
+    checkAt.assign(links, -1.0);
+    approach.assign(links, 0);
+    signal.assign(links, -1);
+    waitHead.assign(links, -1);
+    waitTail.assign(links, -1);
+    waitNext.assign(links, -1);
+    waiting.assign(links, 0);
+    entryHead.assign(links, -1);
+    entryTail.assign(links, -1);
+
+    const double gap = 3600.0 / (params.laneFlow * params.lanes);
+    std::vector<uint8_t> inSeen(nodes + 1, 0);
+    std::size_t total = 0;
+    for (uint32_t u = 1; u <= nodes; ++u) {
+        for (uint32_t e = csr->begin(u); e < csr->end(u); ++e) {
+            uint32_t v = csr->targets[e];
+            double km = std::max(0.0, static_cast<double>(csr->weights[e]));
+            // At least a second of driving, and room for one vehicle
+            travel[e] = static_cast<float>(std::max(1.0, km / params.speedKmh * 3600.0));
+            headway[e] = static_cast<float>(gap);
+            capacity[e] = static_cast<uint32_t>(
+                std::max(1.0, std::ceil(km * params.lanes * params.jamDensity)));
+            ringBase[e] = total;
+            total += capacity[e];
+
+            // The side of v the road arrives from
+            double latU, lonU, latV, lonV;
+            Approach side = static_cast<Approach>(inSeen[v]++ % APPROACHES);
+            if (graph.nodeLocation(static_cast<int>(u), latU, lonU) &&
+                graph.nodeLocation(static_cast<int>(v), latV, lonV)) {
+                double dLat = latU - latV;
+                double dLon = (lonU - lonV) * std::cos(latV * 3.14159265358979323846 / 180.0);
+                if (std::fabs(dLat) >= std::fabs(dLon)) {
+                    side = dLat > 0 ? Approach::North : Approach::South;
+                } else {
+                    side = dLon > 0 ? Approach::East : Approach::West;
+                }
+            }
+            approach[e] = static_cast<uint8_t>(side);
+        }
+    }
+    arena.assign(total, 0);
+}
+
+void MesoSimulator::attachSignals(TrafficController *t, SignalScheduler *s) {
+    traffic = t;
+    scheduler = s;
+    std::fill(signal.begin(), signal.end(), -1);
+    if (!traffic || !scheduler) return;
+    for (uint32_t e = 0; e < csr->edgeCount(); ++e) {
+        signal[e] = traffic->intersectionIndex(static_cast<int>(csr->targets[e]));
+    }
+}
+
+void MesoSimulator::setLinkApproach(uint32_t link, Approach a) {
+    if (link < approach.size()) approach[link] = static_cast<uint8_t>(a);
+}
+
+int64_t MesoSimulator::edgeBetween(int u, int v) const {
+    if (u < 1 || u > static_cast<int>(csr->nodeCount())) return -1;
+    int64_t best = -1;
+    for (uint32_t e = csr->begin(u); e < csr->end(u); ++e) {
+        if (static_cast<int>(csr->targets[e]) != v) continue;
+        if (best < 0 || csr->weights[e] < csr->weights[best]) best = e;
+    }
+    return best;
+}
+
+// ---------------- TRIPS ----------------
+
+int MesoSimulator::addTrip(int vehicleID, double departTime, const std::vector<int> &nodePath) {
+    if (nodePath.empty()) return -1;
+
+    std::size_t start = routes.size();
+    double seconds = 0.0;
+    for (std::size_t k = 1; k < nodePath.size(); ++k) {
+        int64_t e = edgeBetween(nodePath[k - 1], nodePath[k]);
+        if (e < 0) {
+            routes.resize(start);
+            return -1;
+        }
+        routes.push_back(static_cast<uint32_t>(e));
+        seconds += travel[e];
+    }
+
+    int trip = static_cast<int>(vehicle.size());
+    vehicle.push_back(vehicleID);
+    depart.push_back(departTime);
+    arrival.push_back(-1.0);
+    exitAt.push_back(0.0);
+    freeFlow.push_back(static_cast<float>(seconds));
+    routeStart.push_back(start);
+    routeLength.push_back(static_cast<uint32_t>(routes.size() - start));
+    cursor.push_back(0);
+    entryNext.push_back(-1);
+    events.push(std::max(departTime, clock), -trip - 1);
+    return trip;
+}
+
+std::size_t MesoSimulator::addShortestPathTrips(const std::vector<int> &vehicleIDs,
+                                                const std::vector<int> &origins,
+                                                const std::vector<int> &destinations,
+                                                const std::vector<double> &departTimes) {
+    std::size_t count = std::min({vehicleIDs.size(), origins.size(), destinations.size(),
+                                  departTimes.size()});
+    std::vector<std::size_t> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](std::size_t a, std::size_t b) { return origins[a] < origins[b]; });
+
+    std::size_t routed = 0;
+    std::vector<int> parent, path;
+    for (std::size_t k = 0; k < count;) {
+        int origin = origins[order[k]];
+        graph.dijkstra(origin, &parent);
+        for (; k < count && origins[order[k]] == origin; ++k) {
+            std::size_t i = order[k];
+            int dest = destinations[i];
+            if (dest < 1 || dest >= static_cast<int>(parent.size()) || parent[dest] < 0) continue;
+            path.clear();
+            for (int v = dest; v != origin; v = parent[v]) path.push_back(v);
+            path.push_back(origin);
+            std::reverse(path.begin(), path.end());
+            if (addTrip(vehicleIDs[i], departTimes[i], path) >= 0) ++routed;
+        }
+    }
+    return routed;
+}
+
+// ---------------- EVENTS ----------------
+
+void MesoSimulator::schedule(uint32_t link, double time) {
+    // An earlier pending check re-schedules itself when it finds too early
+    if (checkAt[link] >= 0.0 && checkAt[link] <= time) return;
+    checkAt[link] = time;
+    events.push(time, static_cast<int>(link));
+}
+
+void MesoSimulator::enterLink(uint32_t link, uint32_t trip, double time) {
+    uint32_t slot = (ringHead[link] + ringCount[link]) % capacity[link];
+    arena[ringBase[link] + slot] = trip;
+    exitAt[trip] = time + travel[link];
+    if (++ringCount[link] == 1) schedule(link, std::max(exitAt[trip], nextExit[link]));
+}
+
+void MesoSimulator::departTrip(uint32_t trip, double time) {
+    if (routeLength[trip] == 0) {
+        arrival[trip] = time;
+        ++counters.arrived;
+        return;
+    }
+    uint32_t link = routes[routeStart[trip]];
+    cursor[trip] = 0;
+    if (entryHead[link] >= 0 || full(link)) {
+        // Queue at the entry behind earlier departures
+        if (entryTail[link] >= 0) {
+            entryNext[entryTail[link]] = static_cast<int32_t>(trip);
+        } else {
+            entryHead[link] = static_cast<int32_t>(trip);
+        }
+        entryTail[link] = static_cast<int32_t>(trip);
+        ++counters.waitingToEnter;
+        return;
+    }
+    ++counters.onNetwork;
+    enterLink(link, trip, time);
+}
+
+void MesoSimulator::admitEntries(uint32_t link, double time, uint32_t reserved) {
+    while (entryHead[link] >= 0 && ringCount[link] + reserved < capacity[link]) {
+        uint32_t entering = static_cast<uint32_t>(entryHead[link]);
+        entryHead[link] = entryNext[entering];
+        if (entryHead[link] < 0) entryTail[link] = -1;
+        entryNext[entering] = -1;
+        --counters.waitingToEnter;
+        ++counters.onNetwork;
+        enterLink(link, entering, time);
+    }
+}
+
+void MesoSimulator::checkLink(uint32_t link, double time) {
+    // Room left over by blocked links that were woken and went elsewhere
+    if (waitHead[link] < 0) admitEntries(link, time, 0);
+    if (ringCount[link] == 0) return;
+    uint32_t trip = headOf(link);
+    double ready = std::max(exitAt[trip], nextExit[link]);
+    if (time < ready) {
+        schedule(link, ready);
+        return;
+    }
+
+    int32_t junction = signal[link];
+    if (junction >= 0) {
+        int64_t second = static_cast<int64_t>(std::floor(time));
+        if (second > scheduler->now()) scheduler->advanceTo(second);
+        if (!(traffic->greenMask(junction) & (1u << approach[link]))) {
+            ++counters.signalStops;
+            // Manually controlled signals (no next change) hold the queue
+            int64_t change = scheduler->nextChange(junction);
+            if (change > time) schedule(link, static_cast<double>(change));
+            return;
+        }
+    }
+
+    uint32_t pos = cursor[trip] + 1;
+    bool last = pos >= routeLength[trip];
+    uint32_t next = last ? 0 : routes[routeStart[trip] + pos];
+    if (!last && full(next)) {
+        if (!waiting[link]) {
+            waiting[link] = 1;
+            waitNext[link] = -1;
+            if (waitTail[next] >= 0) {
+                waitNext[waitTail[next]] = static_cast<int32_t>(link);
+            } else {
+                waitHead[next] = static_cast<int32_t>(link);
+            }
+            waitTail[next] = static_cast<int32_t>(link);
+            ++counters.spillbacks;
+        }
+        return;
+    }
+
+    // The head leaves
+    ringHead[link] = (ringHead[link] + 1) % capacity[link];
+    --ringCount[link];
+    nextExit[link] = time + headway[link];
+    if (last) {
+        arrival[trip] = time;
+        ++counters.arrived;
+        --counters.onNetwork;
+    } else {
+        cursor[trip] = pos;
+        enterLink(next, trip, time);
+    }
+
+    // The freed slot: links blocked on this one retry first, then trips
+    // waiting at the entry take what they leave
+    uint32_t woken = 0;
+    for (int32_t w = waitHead[link]; w >= 0;) {
+        int32_t after = waitNext[w];
+        waiting[w] = 0;
+        schedule(static_cast<uint32_t>(w), time);
+        ++woken;
+        w = after;
+    }
+    waitHead[link] = waitTail[link] = -1;
+    admitEntries(link, time, woken);
+
+    if (ringCount[link] > 0) {
+        schedule(link, std::max(exitAt[headOf(link)], nextExit[link]));
+    } else if (entryHead[link] >= 0) {
+        schedule(link, time);
+    }
+}
+
+// ---------------- RUN ----------------
+
+std::size_t MesoSimulator::runUntil(double time) {
+    std::size_t handled = 0;
+    while (!events.empty() && events.minKey() <= time) {
+        auto [at, who] = events.pop();
+        clock = at;
+        if (who >= 0) {
+            // Stale if the link was re-scheduled earlier since
+            if (checkAt[who] != at) continue;
+            checkAt[who] = -1.0;
+            checkLink(static_cast<uint32_t>(who), at);
+        } else {
+            departTrip(static_cast<uint32_t>(-who - 1), at);
+        }
+        ++handled;
+    }
+    if (time != std::numeric_limits<double>::infinity()) clock = std::max(clock, time);
+    counters.events += handled;
+    return handled;
+}
+
+std::size_t MesoSimulator::run() {
+    return runUntil(std::numeric_limits<double>::infinity());
+}
+
+// ---------------- RESULTS ----------------
+
+MesoStats MesoSimulator::stats() const {
+    MesoStats out = counters;
+    double travelSum = 0.0, delaySum = 0.0;
+    std::size_t done = 0;
+    for (std::size_t k = 0; k < vehicle.size(); ++k) {
+        if (arrival[k] < 0.0) continue;
+        double t = arrival[k] - depart[k];
+        travelSum += t;
+        delaySum += t - freeFlow[k];
+        ++done;
+    }
+    if (done > 0) {
+        out.meanTravel = travelSum / static_cast<double>(done);
+        out.meanDelay = delaySum / static_cast<double>(done);
+    }
+    return out;
+}
+
+std::size_t MesoSimulator::memoryBytes() const {
+    std::size_t links = capacity.size();
+    std::size_t perLink = sizeof(uint32_t) * 4 + sizeof(float) * 2 + sizeof(std::size_t) +
+                          sizeof(double) * 2 + sizeof(uint8_t) * 2 + sizeof(int32_t) * 6;
+    std::size_t trips = vehicle.size();
+    std::size_t perTrip = sizeof(int) + sizeof(double) * 3 + sizeof(float) + sizeof(std::size_t) +
+                          sizeof(uint32_t) * 2 + sizeof(int32_t);
+    return links * perLink + trips * perTrip + (arena.capacity() + routes.capacity()) * sizeof(uint32_t);
+}
@@ -0,0 +1,146 @@
+// ===================== MesoSimulator.h =====================
+#ifndef MESO_SIMULATOR_H
+#define MESO_SIMULATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "GraphManager.h"
+#include "SearchQueues.h"
+#include "SignalScheduler.h"
+#include "TrafficController.h"
+
+// Link model of the mesoscopic simulation. Road weights are km.
+struct MesoParams {
+    double speedKmh = 40.0;       // free-flow speed
+    double jamDensity = 150.0;    // vehicles per km and lane a link can hold
+    double laneFlow = 1800.0;     // vehicles per hour and lane leaving a link
+    int lanes = 1;
+};
+
+// Counters of a run
+struct MesoStats {
+    std::size_t events = 0;           // link checks and departures handled
+    std::size_t arrived = 0;
+    std::size_t onNetwork = 0;        // entered their first link, not arrived
+    std::size_t waitingToEnter = 0;   // departed onto a full first link
+    std::size_t signalStops = 0;      // queue heads held by a red light
+    std::size_t spillbacks = 0;       // queue heads held by a full next link
+    double meanTravel = 0.0;          // seconds, over arrived trips
+    double meanDelay = 0.0;           // over free-flow time, arrived trips
+};
+
+// Queue-based mesoscopic traffic over the road graph: every directed road
+// (CSR edge) is a link with a free-flow travel time, a storage capacity
+// and a discharge headway. A vehicle follows its route edge by edge:
+// it enters a link's FIFO, may leave once its free-flow time is up and it
+// is at the head, the link's headway has passed, the signal at the link's
+// end shows green for its approach and the next link has room (otherwise
+// it spills back). Vehicles that depart onto a full link wait at its
+// entry.
+//
+// Everything is driven by one monotone event queue (a radix heap) of link
+// checks and departures, so a link is only touched when its head can
+// move, a blocking link frees a slot or its light changes; idle links
+// cost nothing. Link queues are fixed-capacity rings in one arena and
+// trips live in flat arrays.
+//
+// Signals are optional: intersection ids of the TrafficController are
+// graph nodes and their phases come from the SignalScheduler, which the
+// simulation advances with its own clock. A link's approach comes from
+// node coordinates (the side of the junction it arrives from), else from
+// the order of the junction's in-roads; setLinkApproach overrides it.
+class MesoSimulator {
+private:
+    const GraphManager &graph;
+    const CsrGraph *csr = nullptr;
+    MesoParams params;
+
+    TrafficController *traffic = nullptr;
+    SignalScheduler *scheduler = nullptr;
+
+    // Per link (CSR edge position)
+    std::vector<float> travel;              // free-flow seconds
+    std::vector<float> headway;             // seconds between exits
+    std::vector<uint32_t> capacity;
+    std::vector<std::size_t> ringBase;      // start of the link's ring in arena
+    std::vector<uint32_t> ringHead;
+    std::vector<uint32_t> ringCount;
+    std::vector<double> nextExit;           // earliest time the next head may leave
+    std::vector<double> checkAt;            // pending check, -1 if none
+    std::vector<uint8_t> approach;
+    std::vector<int32_t> signal;            // controller index at the link's end, -1
+    std::vector<int32_t> waitHead, waitTail;  // links blocked on this one (FIFO)
+    std::vector<int32_t> waitNext;          // next in that list, -1 ends
+    std::vector<uint8_t> waiting;           // on some link's list
+    std::vector<int32_t> entryHead, entryTail;  // trips waiting to enter
+    std::vector<uint32_t> arena;            // trip indices
+
+    // Per trip
+    std::vector<int> vehicle;
+    std::vector<double> depart;
+    std::vector<double> arrival;            // -1 until arrived
+    std::vector<double> exitAt;             // earliest exit from its current link
+    std::vector<float> freeFlow;            // seconds, whole route
+    std::vector<std::size_t> routeStart;
+    std::vector<uint32_t> routeLength;
+    std::vector<uint32_t> cursor;           // index of the current link in the route
+    std::vector<int32_t> entryNext;         // next trip waiting at the same entry
+    std::vector<uint32_t> routes;           // edges of all routes
+
+    RadixHeapQueue events;                  // key time; >= 0 link check, < 0 ~trip departs
+    double clock = 0.0;
+    MesoStats counters;
+
+    void buildLinks();
+    // Edge u -> v with the lowest weight, -1 if none
+    int64_t edgeBetween(int u, int v) const;
+    void schedule(uint32_t link, double time);
+    void enterLink(uint32_t link, uint32_t trip, double time);
+    void departTrip(uint32_t trip, double time);
+    void checkLink(uint32_t link, double time);
+    // Lets trips waiting at the entry in while room is left beyond reserved
+    void admitEntries(uint32_t link, double time, uint32_t reserved);
+    bool full(uint32_t link) const { return ringCount[link] >= capacity[link]; }
+    uint32_t headOf(uint32_t link) const { return arena[ringBase[link] + ringHead[link]]; }
+
+public:
+    // The graph is frozen here and must not change while this exists
+    explicit MesoSimulator(const GraphManager &graph, MesoParams params = MesoParams());
+
+    // Phases at junctions that the controller has an intersection for
+    void attachSignals(TrafficController *traffic, SignalScheduler *scheduler);
+    void setLinkApproach(uint32_t link, Approach a);
+
+    // ---------------- TRIPS ----------------
+    // Route as graph nodes (origin first); returns the trip index, -1 if
+    // some step has no road
+    int addTrip(int vehicleID, double departTime, const std::vector<int> &nodePath);
+    // Shortest-path routes under the current road costs, one Dijkstra per
+    // distinct origin; returns how many trips could be routed
+    std::size_t addShortestPathTrips(const std::vector<int> &vehicleIDs,
+                                     const std::vector<int> &origins,
+                                     const std::vector<int> &destinations,
+                                     const std::vector<double> &departTimes);
+    std::size_t tripCount() const { return vehicle.size(); }
+
+    // ---------------- RUN ----------------
+    // Handles every event up to time; returns how many
+    std::size_t runUntil(double time);
+    // Until nothing is left to do
+    std::size_t run();
+    double now() const { return clock; }
+
+    // ---------------- RESULTS ----------------
+    int tripVehicle(int trip) const { return vehicle[trip]; }
+    double arrivalTime(int trip) const { return arrival[trip]; }
+    double departTime(int trip) const { return depart[trip]; }
+    double freeFlowTime(int trip) const { return freeFlow[trip]; }
+    // Vehicles on the link, moving or queued
+    int linkOccupancy(uint32_t link) const { return static_cast<int>(ringCount[link]); }
+    int linkCapacity(uint32_t link) const { return static_cast<int>(capacity[link]); }
+    MesoStats stats() const;
+    std::size_t memoryBytes() const;
+};
+
+#endif
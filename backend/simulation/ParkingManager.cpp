@@ -1,124 +1,526 @@
 // ===================== ParkingManager.cpp =====================
 #include "ParkingManager.h"
-#include <fstream>
-#include <sstream>
+#include "LineReader.h"
+#include "SnapshotFile.h"
+#include <algorithm>
 #include <iostream>
 
 // ---------------------- SETUP ----------------------
 
-void ParkingManager::addSpot(const std::string &spotID, int zone) {
-    ParkingSpot spot;
-    spot.spotID = spotID;
-    spot.zone = zone;
-    spot.occupied = false;
-    spot.vehicleID = -1;
+uint32_t ParkingManager::addSpot(const std::string &spotID, int zone, int node) {
+    auto found = spotIds.find(spotID);
+    if (found != spotIds.end()) return found->second;
 
-    spots[spotID] = spot;
-    zoneMap[zone].push_back(spotID);
+    uint32_t spot = static_cast<uint32_t>(spotNames.size());
+    spotIds.emplace(spotID, spot);
+    spotNames.push_back(spotID);
+    spotZone.push_back(zone);
+    spotVehicle.push_back(-1);
+    spotNode.push_back(0);
+    spotBookings.emplace_back();
+
+    Zone &z = zones[zone];
+    uint32_t slot = static_cast<uint32_t>(z.spots.size());
+    spotSlot.push_back(slot);
+    z.spots.push_back(spot);
+    if (slot % 64 == 0) {
+        // New word: every bit is padding (occupied) until its slot exists
+        z.occupied.push_back(~uint64_t(0));
+        if (z.full.size() * 64 < z.occupied.size()) z.full.push_back(0);
+    }
+    z.occupied[slot / 64] &= ~(uint64_t(1) << (slot % 64));
+    std::size_t word = slot / 64;
+    z.full[word / 64] &= ~(uint64_t(1) << (word % 64));
+    ++z.freeCount;
+    if (z.timeline) {
+        z.timeline->addGap(std::numeric_limits<int64_t>::min(), ReservationTimeline::OPEN, spot);
+    }
+
+    if (node > 0) setSpotNode(spot, node);
+    return spot;
+}
+
+void ParkingManager::setSpotNode(uint32_t spot, int node) {
+    if (spot >= spotNode.size() || spotNode[spot] == node) return;
+    bool free = spotVehicle[spot] < 0;
+    if (int old = spotNode[spot]; old > 0) {
+        auto &list = nodeSpots[old];
+        list.erase(std::find(list.begin(), list.end(), spot));
+        if (list.empty()) nodeSpots.erase(old);
+        if (free) {
+            --nodeFree[old];
+            --freeOnGraph;
+        }
+    }
+    spotNode[spot] = node < 0 ? 0 : node;
+    if (node > 0) {
+        nodeSpots[node].push_back(spot);
+        if (nodeFree.size() <= static_cast<std::size_t>(node)) nodeFree.resize(node + 1, 0);
+        if (free) {
+            ++nodeFree[node];
+            ++freeOnGraph;
+        }
+    }
 }
 
-void ParkingManager::loadFromFile(const std::string &filename) {
-    std::ifstream in(filename);
-    if (!in) {
+int ParkingManager::findSpot(const std::string &spotID) const {
+    auto it = spotIds.find(spotID);
+    return it == spotIds.end() ? -1 : static_cast<int>(it->second);
+}
+
+std::size_t ParkingManager::loadFromFile(const std::string &filename) {
+    LineReader in(filename);
+    if (!in.isOpen()) {
         std::cerr << "Failed to open parking file: " << filename << "\n";
-        return;
+        return 0;
     }
 
-    std::string line;
-    while (std::getline(in, line)) {
-        if (line.empty()) continue;
+    // "id,zone[,node]" or "id zone [node]"; CSV ids may contain spaces
+    ParseReport report(filename);
+    std::string_view line;
+    while (in.next(line)) {
+        if (line.empty() || line[0] == '#') continue;
+        bool csv = line.find(',') != std::string_view::npos;
+        FieldCursor f(line, csv ? "," : " \t");
+        if (f.atEnd()) continue;
 
-        std::stringstream ss(line);
-        std::string id;
+        std::string_view id;
         int zone = 0;
-
-        if (line.find(',') != std::string::npos) {
-            std::string token;
-            std::vector<std::string> row;
-            while (std::getline(ss, token, ',')) row.push_back(token);
-            if (row.size() < 2) continue;
-            id = row[0];
-            zone = std::stoi(row[1]);
-        } else {
-            ss >> id >> zone;
+        if (!f.nextToken(id) || !f.nextInt(zone)) {
+            report.reject(in.lineNumber(), "expected 'spotID,zone' or 'spotID zone'");
+            continue;
+        }
+        int node = 0;
+        if (!f.atEnd() && (!f.nextInt(node) || !f.atEnd())) {
+            report.reject(in.lineNumber(), "expected an optional node id after the zone");
+            continue;
         }
 
-        addSpot(id, zone);
+        addSpot(std::string(id), zone, node);
+        ++report.records;
     }
+    report.finish();
+    return report.malformed;
 }
 
 // ---------------------- ALLOCATION ----------------------
 
-bool ParkingManager::assignSpot(const std::string &spotID, int vehicleID) {
-    auto it = spots.find(spotID);
-    if (it == spots.end()) return false;
+void ParkingManager::setOccupied(uint32_t spot, bool occupied) {
+    Zone &z = zones.find(spotZone[spot])->second;
+    uint32_t slot = spotSlot[spot];
+    uint64_t &word = z.occupied[slot / 64];
+    uint64_t bit = uint64_t(1) << (slot % 64);
+    if (((word & bit) != 0) == occupied) return;
 
-    ParkingSpot &spot = it->second;
-    if (spot.occupied) return false;
+    word ^= bit;
+    if (int node = spotNode[spot]; node > 0) {
+        if (occupied) {
+            --nodeFree[node];
+            --freeOnGraph;
+        } else {
+            ++nodeFree[node];
+            ++freeOnGraph;
+        }
+    }
+    std::size_t w = slot / 64;
+    uint64_t fullBit = uint64_t(1) << (w % 64);
+    if (occupied) {
+        --z.freeCount;
+        if (word == ~uint64_t(0)) z.full[w / 64] |= fullBit;
+    } else {
+        ++z.freeCount;
+        z.full[w / 64] &= ~fullBit;
+    }
+}
 
-    ParkingUndoAction action;
-    action.spotID = spotID;
-    action.prevOccupied = spot.occupied;
-    action.prevVehicleID = spot.vehicleID;
-    undoStack.push(action);
+bool ParkingManager::assignSpot(uint32_t spot, int vehicleID) {
+    if (spot >= spotVehicle.size() || spotVehicle[spot] >= 0) return false;
 
-    spot.occupied = true;
-    spot.vehicleID = vehicleID;
+    logChange(ParkingChange::Occupancy, spot, -1, false);
+    spotVehicle[spot] = vehicleID;
+    setOccupied(spot, true);
     return true;
 }
 
+bool ParkingManager::assignSpot(const std::string &spotID, int vehicleID) {
+    int spot = findSpot(spotID);
+    return spot >= 0 && assignSpot(static_cast<uint32_t>(spot), vehicleID);
+}
+
+namespace {
+
+// Index of the lowest set bit of a non-zero word
+int lowestBit(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(word);
+#else
+    int bit = 0;
+    while (!(word & 1)) {
+        word >>= 1;
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+int firstZero(uint64_t word) { return lowestBit(~word); }
+
+} // namespace
+
+int ParkingManager::findFreeSpot(int zone) const {
+    auto it = zones.find(zone);
+    if (it == zones.end() || it->second.freeCount == 0) return -1;
+
+    const Zone &z = it->second;
+    for (std::size_t s = 0; s < z.full.size(); ++s) {
+        if (z.full[s] == ~uint64_t(0)) continue;
+        std::size_t w = s * 64 + firstZero(z.full[s]);
+        if (w >= z.occupied.size()) break;
+        std::size_t slot = w * 64 + firstZero(z.occupied[w]);
+        return static_cast<int>(z.spots[slot]);
+    }
+    return -1;
+}
+
 std::string ParkingManager::findNearestFreeSpot(int zone) const {
-    auto it = zoneMap.find(zone);
-    if (it == zoneMap.end()) return "";
+    int spot = findFreeSpot(zone);
+    return spot < 0 ? "" : spotNames[spot];
+}
+
+std::vector<ParkingMatch> ParkingManager::findNearestFreeSpots(const GraphManager &graph,
+                                                              int fromNode, int k,
+                                                              double maxCost) const {
+    std::vector<ParkingMatch> found;
+    if (k <= 0 || freeOnGraph == 0) return found;
+    graph.freeze();
+    graph.expandFrom(fromNode, maxCost, scratch, [&](int node, double cost) {
+        if (static_cast<std::size_t>(node) >= nodeFree.size() || nodeFree[node] == 0) return true;
+        for (uint32_t spot : nodeSpots.find(node)->second) {
+            if (spotVehicle[spot] >= 0) continue;
+            found.push_back({static_cast<int>(spot), node, cost});
+            if (static_cast<int>(found.size()) == k) return false;
+        }
+        // Every free spot seen: nothing left to find farther out
+        return found.size() < freeOnGraph;
+    });
+    return found;
+}
+
+std::vector<ParkingMatch> ParkingManager::assignNearestSpots(const GraphManager &graph,
+                                                             const std::vector<int> &fromNodes,
+                                                             const std::vector<int> &vehicleIDs,
+                                                             double maxCost) {
+    std::size_t count = std::min(fromNodes.size(), vehicleIDs.size());
+    std::vector<ParkingMatch> plan(count, {-1, 0, std::numeric_limits<double>::infinity()});
+    for (std::size_t i = 0; i < count; ++i) {
+        std::vector<ParkingMatch> best = findNearestFreeSpots(graph, fromNodes[i], 1, maxCost);
+        if (best.empty()) continue;
+        assignSpot(static_cast<uint32_t>(best[0].spot), vehicleIDs[i]);
+        plan[i] = best[0];
+    }
+    return plan;
+}
+
+// ---------------------- RESERVATIONS ----------------------
+
+const ReservationTimeline *ParkingManager::timelineOf(int zone) const {
+    auto it = zones.find(zone);
+    if (it == zones.end()) return nullptr;
+    const Zone &z = it->second;
+    if (!z.timeline) {
+        z.timeline.reset(new ReservationTimeline(windowOrigin, windowMinutes));
+        for (uint32_t spot : z.spots) {
+            int64_t gapStart = std::numeric_limits<int64_t>::min();
+            for (const auto &b : spotBookings[spot]) {
+                z.timeline->addGap(gapStart, b.first, spot);
+                gapStart = b.second.end;
+            }
+            z.timeline->addGap(gapStart, ReservationTimeline::OPEN, spot);
+        }
+    }
+    return z.timeline.get();
+}
+
+void ParkingManager::gapAround(uint32_t spot, int64_t end, int64_t &gapStart,
+                               int64_t &gapEnd) const {
+    const auto &bookings = spotBookings[spot];
+    auto next = bookings.lower_bound(end);
+    gapEnd = next == bookings.end() ? ReservationTimeline::OPEN : next->first;
+    gapStart = next == bookings.begin() ? std::numeric_limits<int64_t>::min()
+                                        : std::prev(next)->second.end;
+}
+
+bool ParkingManager::bookSpot(uint32_t spot, int64_t start, int64_t end, int vehicleID) {
+    if (spot >= spotBookings.size() || start < windowOrigin || end <= start ||
+        end > windowOrigin + windowMinutes) {
+        return false;
+    }
+    auto &bookings = spotBookings[spot];
+    auto next = bookings.lower_bound(start);
+    if (next != bookings.end() && next->first < end) return false;
+    if (next != bookings.begin() && std::prev(next)->second.end > start) return false;
+
+    int64_t gapStart, gapEnd;
+    gapAround(spot, end, gapStart, gapEnd);
+    if (const Zone &z = zones.find(spotZone[spot])->second; z.timeline) {
+        z.timeline->removeGap(gapStart, gapEnd, spot);
+        z.timeline->addGap(gapStart, start, spot);
+        z.timeline->addGap(end, gapEnd, spot);
+    }
+    bookings.emplace(start, Booking{end, vehicleID});
+    return true;
+}
+
+bool ParkingManager::unbookSpot(uint32_t spot, int64_t start, Booking &removed) {
+    if (spot >= spotBookings.size()) return false;
+    auto &bookings = spotBookings[spot];
+    auto it = bookings.find(start);
+    if (it == bookings.end()) return false;
+    removed = it->second;
+    bookings.erase(it);
+
+    int64_t gapStart, gapEnd;
+    gapAround(spot, removed.end, gapStart, gapEnd);
+    if (const Zone &z = zones.find(spotZone[spot])->second; z.timeline) {
+        z.timeline->removeGap(gapStart, start, spot);
+        z.timeline->removeGap(removed.end, gapEnd, spot);
+        z.timeline->addGap(gapStart, gapEnd, spot);
+    }
+    return true;
+}
 
-    for (const auto &spotID : it->second) {
-        auto sit = spots.find(spotID);
-        if (sit != spots.end() && !sit->second.occupied) {
-            return spotID;
+void ParkingManager::setReservationWindow(int64_t origin, int64_t minutes) {
+    windowOrigin = origin;
+    windowMinutes = std::max<int64_t>(minutes, 1);
+    for (auto &bookings : spotBookings) {
+        while (!bookings.empty() && bookings.begin()->second.end <= origin) {
+            bookings.erase(bookings.begin());
         }
     }
-    return "";
+    for (auto &kv : zones) kv.second.timeline.reset();
+}
+
+bool ParkingManager::reserveSpot(uint32_t spot, int64_t start, int64_t end, int vehicleID) {
+    if (!bookSpot(spot, start, end, vehicleID)) return false;
+
+    logChange(ParkingChange::Reserve, spot, vehicleID, false, start, end);
+    return true;
+}
+
+bool ParkingManager::cancelReservation(uint32_t spot, int64_t start) {
+    Booking removed;
+    if (!unbookSpot(spot, start, removed)) return false;
+
+    logChange(ParkingChange::CancelReservation, spot, removed.vehicleID, false, start, removed.end);
+    return true;
+}
+
+bool ParkingManager::isReserved(uint32_t spot, int64_t start, int64_t end) const {
+    if (spot >= spotBookings.size()) return false;
+    const auto &bookings = spotBookings[spot];
+    auto next = bookings.lower_bound(start);
+    if (next != bookings.end() && next->first < end) return true;
+    return next != bookings.begin() && std::prev(next)->second.end > start;
+}
+
+int ParkingManager::findReservableSpot(int zone, int64_t start, int64_t end) const {
+    if (start < windowOrigin || end > windowOrigin + windowMinutes) return -1;
+    const ReservationTimeline *t = timelineOf(zone);
+    return t ? static_cast<int>(t->findFree(start, end)) : -1;
+}
+
+bool ParkingManager::zoneAvailable(int zone, int64_t start, int64_t end) const {
+    return findReservableSpot(zone, start, end) >= 0;
+}
+
+int ParkingManager::reserveInZone(int zone, int64_t start, int64_t end, int vehicleID) {
+    int spot = findReservableSpot(zone, start, end);
+    if (spot < 0 || !reserveSpot(static_cast<uint32_t>(spot), start, end, vehicleID)) return -1;
+    return spot;
+}
+
+int64_t ParkingManager::earliestFreeSlot(int zone, int64_t from, int64_t length) const {
+    const ReservationTimeline *t = timelineOf(zone);
+    if (!t) return -1;
+    int64_t at = t->earliestFree(from, length);
+    return at >= 0 && at + length <= windowOrigin + windowMinutes ? at : -1;
 }
 
 // ---------------------- UNDO FEATURE ----------------------
 
+void ParkingManager::logChange(ParkingChange kind, uint32_t spot, int before, bool flag,
+                               int64_t start, int64_t end) {
+    UndoEntry entry{};
+    entry.domain = UndoDomain::Parking;
+    entry.kind = static_cast<uint8_t>(kind);
+    entry.target = static_cast<int32_t>(spot);
+    entry.before = before;
+    entry.flag = flag ? 1 : 0;
+    entry.start = start;
+    entry.end = end;
+    log().record(entry);
+}
+
 void ParkingManager::undoLastChange() {
-    if (undoStack.empty()) return;
+    if (journal) {
+        journal->undoActions(1);
+    } else {
+        ownJournal.undoActions(1, [this](const UndoEntry &entry) { applyUndo(entry); });
+    }
+}
+
+void ParkingManager::applyUndo(const UndoEntry &entry) {
+    uint32_t spot = static_cast<uint32_t>(entry.target);
+    if (entry.domain != UndoDomain::Parking || spot >= spotVehicle.size()) return;
+
+    Booking removed;
+    switch (static_cast<ParkingChange>(entry.kind)) {
+    case ParkingChange::Occupancy:
+        spotVehicle[spot] = entry.flag ? entry.before : -1;
+        setOccupied(spot, entry.flag != 0);
+        break;
+    case ParkingChange::Reserve:
+        unbookSpot(spot, entry.start, removed);
+        break;
+    case ParkingChange::CancelReservation:
+        bookSpot(spot, entry.start, entry.end, entry.before);
+        break;
+    }
+}
+
+// ---------------------- SNAPSHOT ----------------------
+
+namespace {
+constexpr uint32_t PARKING_VERSION = 1;
+}
+
+void ParkingManager::saveState(SnapshotWriter &out) const {
+    std::vector<uint32_t> bookingSpot;
+    std::vector<int64_t> bookingStart, bookingEnd;
+    std::vector<int> bookingVehicle;
+    for (uint32_t spot = 0; spot < spotBookings.size(); ++spot) {
+        for (const auto &kv : spotBookings[spot]) {
+            bookingSpot.push_back(spot);
+            bookingStart.push_back(kv.first);
+            bookingEnd.push_back(kv.second.end);
+            bookingVehicle.push_back(kv.second.vehicleID);
+        }
+    }
 
-    ParkingUndoAction action = undoStack.top();
-    undoStack.pop();
+    out.beginSection(SNAPSHOT_PARKING, PARKING_VERSION);
+    out.put(windowOrigin);
+    out.put(windowMinutes);
+    out.putStrings(spotNames);
+    out.putArray(spotZone);
+    out.putArray(spotNode);
+    out.putArray(spotVehicle);
+    out.putArray(bookingSpot);
+    out.putArray(bookingStart);
+    out.putArray(bookingEnd);
+    out.putArray(bookingVehicle);
+    out.endSection();
+}
+
+bool ParkingManager::loadState(SnapshotReader &in) {
+    uint32_t version = 0;
+    int64_t origin = 0, minutes = 0;
+    std::vector<std::string> names;
+    std::vector<int> zone, node, vehicle, bookingVehicle;
+    std::vector<uint32_t> bookingSpot;
+    std::vector<int64_t> bookingStart, bookingEnd;
+    if (!in.enter(SNAPSHOT_PARKING, PARKING_VERSION, version) || !in.get(origin) || !in.get(minutes) ||
+        !in.getStrings(names) || !in.getArray(zone) || !in.getArray(node) ||
+        !in.getArray(vehicle) || !in.getArray(bookingSpot) || !in.getArray(bookingStart) ||
+        !in.getArray(bookingEnd) || !in.getArray(bookingVehicle)) {
+        return false;
+    }
+    std::size_t count = names.size();
+    std::size_t bookings = bookingSpot.size();
+    if (zone.size() != count || node.size() != count || vehicle.size() != count ||
+        bookingStart.size() != bookings || bookingEnd.size() != bookings ||
+        bookingVehicle.size() != bookings || minutes < 1) {
+        return in.fail("parking arrays do not match the spot count");
+    }
+
+    // Rebuilt through addSpot so zones, bitsets and node counts follow;
+    // addSpot hands out ids in order, so a duplicate name shows as a gap
+    ParkingManager loaded;
+    loaded.windowOrigin = origin;
+    loaded.windowMinutes = minutes;
+    for (std::size_t spot = 0; spot < count; ++spot) {
+        if (loaded.addSpot(names[spot], zone[spot], node[spot]) != spot) {
+            return in.fail("parking spot " + names[spot] + " appears twice");
+        }
+        if (vehicle[spot] >= 0) {
+            loaded.spotVehicle[spot] = vehicle[spot];
+            loaded.setOccupied(static_cast<uint32_t>(spot), true);
+        }
+    }
+    // Bookings as saved: one that began before the window still runs
+    for (std::size_t b = 0; b < bookings; ++b) {
+        uint32_t spot = bookingSpot[b];
+        if (spot >= count || bookingEnd[b] <= bookingStart[b]) {
+            return in.fail("parking booking out of range");
+        }
+        auto &list = loaded.spotBookings[spot];
+        if (!list.empty() && (list.rbegin()->first >= bookingStart[b] ||
+                              list.rbegin()->second.end > bookingStart[b])) {
+            return in.fail("parking bookings of spot " + names[spot] + " overlap");
+        }
+        list.emplace_hint(list.end(), bookingStart[b], Booking{bookingEnd[b], bookingVehicle[b]});
+    }
 
-    auto it = spots.find(action.spotID);
-    if (it == spots.end()) return;
+    replaceState(std::move(loaded));
+    return true;
+}
 
-    it->second.occupied = action.prevOccupied;
-    it->second.vehicleID = action.prevVehicleID;
+void ParkingManager::replaceState(ParkingManager &&loaded) {
+    UndoJournal own = std::move(ownJournal);
+    UndoJournal *shared = journal;
+    *this = std::move(loaded);
+    ownJournal = std::move(own);
+    journal = shared;
+    ownJournal.clear();
+    if (journal) journal->clear();
 }
 
 // ---------------------- STATUS ----------------------
 
 bool ParkingManager::isOccupied(const std::string &spotID) const {
-    auto it = spots.find(spotID);
-    if (it == spots.end()) return false;
-    return it->second.occupied;
+    int spot = findSpot(spotID);
+    return spot >= 0 && isOccupied(static_cast<uint32_t>(spot));
 }
 
 int ParkingManager::getVehicleInSpot(const std::string &spotID) const {
-    auto it = spots.find(spotID);
-    if (it == spots.end()) return -1;
-    return it->second.vehicleID;
+    int spot = findSpot(spotID);
+    return spot < 0 ? -1 : getVehicleInSpot(static_cast<uint32_t>(spot));
+}
+
+ParkingSpot ParkingManager::getSpot(uint32_t spot) const {
+    return {spotNames[spot], spotZone[spot], spotVehicle[spot] >= 0, spotVehicle[spot]};
+}
+
+std::size_t ParkingManager::freeSpotCount(int zone) const {
+    auto it = zones.find(zone);
+    return it == zones.end() ? 0 : it->second.freeCount;
+}
+
+std::size_t ParkingManager::zoneSize(int zone) const {
+    auto it = zones.find(zone);
+    return it == zones.end() ? 0 : it->second.spots.size();
 }
 
 std::vector<std::string> ParkingManager::getFreeSpotsInZone(int zone) const {
     std::vector<std::string> freeSpots;
-    auto it = zoneMap.find(zone);
-    if (it == zoneMap.end()) return freeSpots;
+    auto it = zones.find(zone);
+    if (it == zones.end()) return freeSpots;
 
-    for (auto &spotID : it->second) {
-        auto sit = spots.find(spotID);
-        if (sit != spots.end() && !sit->second.occupied)
-            freeSpots.push_back(spotID);
+    const Zone &z = it->second;
+    freeSpots.reserve(z.freeCount);
+    for (std::size_t w = 0; w < z.occupied.size(); ++w) {
+        for (uint64_t bits = ~z.occupied[w]; bits; bits &= bits - 1) {
+            freeSpots.push_back(spotNames[z.spots[w * 64 + lowestBit(bits)]]);
+        }
     }
-
     return freeSpots;
 }
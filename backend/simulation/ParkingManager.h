@@ -5,9 +5,19 @@
 #include <unordered_map>
 #include <string>
 #include <vector>
-#include <stack>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include "GraphManager.h"
+#include "ReservationTimeline.h"
+#include "UndoJournal.h"
 
-// Represents a single parking spot
+class SnapshotWriter;
+class SnapshotReader;
+
+// Snapshot of a single parking spot, for callers that want every field
 struct ParkingSpot {
     std::string spotID;
     int zone;
@@ -15,40 +25,176 @@ struct ParkingSpot {
     int vehicleID;
 };
 
-struct ParkingUndoAction {
-    std::string spotID;
-    bool prevOccupied;
-    int prevVehicleID;
+// A free spot found by a graph search; spot is -1 when none was found
+struct ParkingMatch {
+    int spot;
+    int node;
+    double cost;
+};
+
+// Kinds of the parking entries in the undo journal (target: spot id)
+enum class ParkingChange : uint8_t {
+    Occupancy,          // assignSpot: flag prevOccupied, before prevVehicleID
+    Reserve,            // reserveSpot: [start, end) by before
+    CancelReservation   // cancelReservation: [start, end) held by before
 };
 
+// Spots are interned to dense ids (0, 1, ... in order of addSpot) on the
+// way in; everything inside works on those ids and the string ids are
+// only kept for the API. Each zone keeps its spots in insertion order
+// with one occupancy bit per spot, a summary bit per 64-spot word that is
+// set while the word is full, and a free counter, so the first free spot
+// is a find-first-zero over the summary and then over one word.
+//
+// Spots may sit on a road-graph node; per node the manager keeps a free
+// count, so a Dijkstra from the driver's node only looks at spots where
+// one is free and stops after the k-th.
+//
+// Advance reservations are half-open minute intervals [start, end) inside
+// a sliding window (see setReservationWindow). Each spot keeps its own
+// bookings sorted by start; each zone indexes the free gaps between them
+// in a ReservationTimeline, built on the zone's first reservation query,
+// so zone availability and earliest-free queries are O(log window).
+// Reservations are separate from "occupied now" (assignSpot).
 class ParkingManager {
 private:
-    // spotID -> ParkingSpot
-    std::unordered_map<std::string, ParkingSpot> spots;
+    struct Zone {
+        std::vector<uint32_t> spots;       // slot -> spot id
+        std::vector<uint64_t> occupied;    // bit per slot, padding bits set
+        std::vector<uint64_t> full;        // bit per occupied word, set when ~0
+        uint32_t freeCount = 0;
+        mutable std::unique_ptr<ReservationTimeline> timeline;
+    };
+
+    struct Booking {
+        int64_t end;
+        int vehicleID;
+    };
+
+    // Spot id -> fields
+    std::vector<std::string> spotNames;
+    std::vector<int> spotZone;
+    std::vector<uint32_t> spotSlot;        // position in its zone
+    std::vector<int> spotVehicle;          // -1 when free
+    std::vector<int> spotNode;             // 0 when not on the graph
+    std::vector<std::map<int64_t, Booking>> spotBookings;  // start -> booking
+    std::unordered_map<std::string, uint32_t> spotIds;
 
-    // zone -> list of spotIDs
-    std::unordered_map<int, std::vector<std::string>> zoneMap;
+    std::unordered_map<int, Zone> zones;
 
-    // stack for undo operations
-    std::stack<ParkingUndoAction> undoStack;
+    // Node -> spots on it / how many of those are free
+    std::unordered_map<int, std::vector<uint32_t>> nodeSpots;
+    std::vector<uint32_t> nodeFree;
+    std::size_t freeOnGraph = 0;           // free spots that have a node
+    mutable SearchScratch scratch;
+
+    int64_t windowOrigin = 0;
+    int64_t windowMinutes = 7 * 1440;
+
+    // Changes go to the shared journal when one is attached, else to ours
+    UndoJournal ownJournal;
+    UndoJournal *journal = nullptr;
+
+    void setOccupied(uint32_t spot, bool occupied);
+    const ReservationTimeline *timelineOf(int zone) const;
+    // The free gap of spot around a free interval ending at end, which no
+    // booking of the spot overlaps: [gapStart, gapEnd)
+    void gapAround(uint32_t spot, int64_t end, int64_t &gapStart, int64_t &gapEnd) const;
+    bool bookSpot(uint32_t spot, int64_t start, int64_t end, int vehicleID);
+    bool unbookSpot(uint32_t spot, int64_t start, Booking &removed);
+    UndoJournal &log() { return journal ? *journal : ownJournal; }
+    void logChange(ParkingChange kind, uint32_t spot, int before, bool flag,
+                   int64_t start = 0, int64_t end = 0);
 
 public:
     ParkingManager() = default;
 
     // ----------- SETUP -----------
-    void addSpot(const std::string &spotID, int zone);
-    void loadFromFile(const std::string &filename);  // optional CSV / text
+    // Returns the spot's id; a spotID already known keeps its id and zone.
+    // node > 0 places the spot on that road-graph node.
+    uint32_t addSpot(const std::string &spotID, int zone, int node = 0);
+    void setSpotNode(uint32_t spot, int node);
+    // "spotID,zone[,node]" (CSV) or "spotID zone [node]" lines; returns the
+    // number of malformed lines, which are reported with line numbers and
+    // skipped
+    std::size_t loadFromFile(const std::string &filename);
+
+    // ----------- IDS -----------
+    // -1 if the spot is unknown
+    int findSpot(const std::string &spotID) const;
+    const std::string &spotName(uint32_t spot) const { return spotNames[spot]; }
+    std::size_t spotCount() const { return spotNames.size(); }
 
     // ----------- ALLOCATION -----------
+    bool assignSpot(uint32_t spot, int vehicleID);
     bool assignSpot(const std::string &spotID, int vehicleID);
+    // First free spot of the zone in insertion order, -1 if none
+    int findFreeSpot(int zone) const;
+    // Same, as a spotID ("" if none)
     std::string findNearestFreeSpot(int zone) const;
+    // Up to k free spots closest to fromNode by travel cost over the
+    // graph (at most maxCost), nearest first; spots on one node come in
+    // insertion order.
+    std::vector<ParkingMatch> findNearestFreeSpots(
+        const GraphManager &graph, int fromNode, int k,
+        double maxCost = std::numeric_limits<double>::infinity()) const;
+    // Parks vehicleIDs[i], arriving at fromNodes[i], in its nearest free
+    // spot, in order; each vehicle sees the spots taken before it, so no
+    // spot is handed out twice. One result per vehicle (spot -1: none
+    // within maxCost); every assignment goes on the undo log.
+    std::vector<ParkingMatch> assignNearestSpots(
+        const GraphManager &graph, const std::vector<int> &fromNodes,
+        const std::vector<int> &vehicleIDs,
+        double maxCost = std::numeric_limits<double>::infinity());
+
+    // ----------- RESERVATIONS -----------
+    // Moves the window to [origin, origin + minutes]; bookings that ended
+    // by origin are dropped. Default: minutes 0 .. 7 days.
+    void setReservationWindow(int64_t origin, int64_t minutes);
+    // False if [start, end) leaves the window or overlaps a booking
+    bool reserveSpot(uint32_t spot, int64_t start, int64_t end, int vehicleID);
+    // Cancels the booking of spot that starts at start
+    bool cancelReservation(uint32_t spot, int64_t start);
+    bool isReserved(uint32_t spot, int64_t start, int64_t end) const;
+    // Whether some spot of the zone is free over all of [start, end)
+    bool zoneAvailable(int zone, int64_t start, int64_t end) const;
+    // Such a spot, -1 if none
+    int findReservableSpot(int zone, int64_t start, int64_t end) const;
+    // Reserves such a spot; its id, -1 if none
+    int reserveInZone(int zone, int64_t start, int64_t end, int vehicleID);
+    // Earliest t >= from at which some spot of the zone is free for
+    // length minutes, -1 if none inside the window
+    int64_t earliestFreeSlot(int zone, int64_t from, int64_t length) const;
 
     // ----------- UNDO FEATURE -----------
+    // Logs to journal (shared with other components, which then undo
+    // through its applier) instead of the manager's own; nullptr detaches
+    void attachJournal(UndoJournal *shared) { journal = shared; }
+    // Undoes the latest action of the journal in use
     void undoLastChange();
+    // Reverts one parking entry of a journal
+    void applyUndo(const UndoEntry &entry);
+
+    // ----------- SNAPSHOT -----------
+    // Spots (ids, zones, nodes, occupants), bookings and the window.
+    // Loading replaces them and clears the undo history; spot ids stay.
+    // To restore together with other components, load into a fresh
+    // manager and hand it to replaceState once every part has loaded.
+    void saveState(SnapshotWriter &out) const;
+    bool loadState(SnapshotReader &in);
+    // Takes loaded's spots and bookings; keeps this manager's journals
+    // (cleared)
+    void replaceState(ParkingManager &&loaded);
 
     // ----------- STATUS -----------
+    bool isOccupied(uint32_t spot) const { return spot < spotVehicle.size() && spotVehicle[spot] >= 0; }
     bool isOccupied(const std::string &spotID) const;
+    int getVehicleInSpot(uint32_t spot) const { return spot < spotVehicle.size() ? spotVehicle[spot] : -1; }
     int getVehicleInSpot(const std::string &spotID) const;
+    ParkingSpot getSpot(uint32_t spot) const;
+    std::size_t freeSpotCount(int zone) const;
+    int spotNodeOf(uint32_t spot) const { return spotNode[spot]; }
+    std::size_t zoneSize(int zone) const;
     std::vector<std::string> getFreeSpotsInZone(int zone) const;
 };
 
@@ -0,0 +1,95 @@
+// ===================== ReservationTimeline.cpp =====================
+#include "ReservationTimeline.h"
+#include <algorithm>
+
+namespace {
+constexpr int64_t NONE = std::numeric_limits<int64_t>::min();
+}
+
+ReservationTimeline::ReservationTimeline(int64_t start, int64_t minutes)
+    : origin(start), span(std::max<int64_t>(minutes, 1)) {
+    while (size < static_cast<std::size_t>(span) + 1) size <<= 1;
+    latestEnd.assign(2 * size, NONE);
+    longest.assign(2 * size, NONE);
+}
+
+std::size_t ReservationTimeline::leafOf(int64_t minute) const {
+    if (minute <= origin) return 0;
+    if (minute >= origin + span) return static_cast<std::size_t>(span);
+    return static_cast<std::size_t>(minute - origin);
+}
+
+void ReservationTimeline::refresh(std::size_t leaf) {
+    std::size_t pos = leaf + size;
+    auto it = gaps.find(leaf);
+    if (it == gaps.end() || it->second.empty()) {
+        if (it != gaps.end()) gaps.erase(it);
+        latestEnd[pos] = longest[pos] = NONE;
+    } else {
+        int64_t end = it->second.rbegin()->first;
+        latestEnd[pos] = end;
+        longest[pos] = end == OPEN ? OPEN : end - (origin + static_cast<int64_t>(leaf));
+    }
+    for (pos >>= 1; pos >= 1; pos >>= 1) {
+        latestEnd[pos] = std::max(latestEnd[2 * pos], latestEnd[2 * pos + 1]);
+        longest[pos] = std::max(longest[2 * pos], longest[2 * pos + 1]);
+    }
+}
+
+void ReservationTimeline::addGap(int64_t start, int64_t end, uint32_t spot) {
+    if (end <= start) return;
+    std::size_t leaf = leafOf(start);
+    gaps[leaf].insert({end, spot});
+    refresh(leaf);
+}
+
+void ReservationTimeline::removeGap(int64_t start, int64_t end, uint32_t spot) {
+    if (end <= start) return;
+    std::size_t leaf = leafOf(start);
+    auto it = gaps.find(leaf);
+    if (it == gaps.end()) return;
+    it->second.erase({end, spot});
+    refresh(leaf);
+}
+
+// ---------------------- QUERIES ----------------------
+
+std::size_t ReservationTimeline::findEndingAfter(std::size_t node, std::size_t lo,
+                                                 std::size_t hi, std::size_t to,
+                                                 int64_t end) const {
+    if (lo > to || latestEnd[node] < end) return size;
+    if (hi - lo == 1) return lo;
+    std::size_t mid = (lo + hi) / 2;
+    std::size_t found = findEndingAfter(2 * node, lo, mid, to, end);
+    if (found != size) return found;
+    return findEndingAfter(2 * node + 1, mid, hi, to, end);
+}
+
+std::size_t ReservationTimeline::firstLongEnough(std::size_t node, std::size_t lo,
+                                                 std::size_t hi, std::size_t from,
+                                                 int64_t length) const {
+    if (hi <= from || longest[node] < length) return size;
+    if (hi - lo == 1) return lo;
+    std::size_t mid = (lo + hi) / 2;
+    std::size_t found = firstLongEnough(2 * node, lo, mid, from, length);
+    if (found != size) return found;
+    return firstLongEnough(2 * node + 1, mid, hi, from, length);
+}
+
+int64_t ReservationTimeline::findFree(int64_t start, int64_t end) const {
+    start = std::max(start, origin);
+    if (end <= start) return -1;
+    std::size_t leaf = findEndingAfter(1, 0, size, leafOf(start), end);
+    if (leaf == size) return -1;
+    // Any gap of that leaf ending late enough covers [start, end)
+    return gaps.find(leaf)->second.rbegin()->second;
+}
+
+int64_t ReservationTimeline::earliestFree(int64_t from, int64_t length) const {
+    from = std::max(from, origin);
+    if (length <= 0 || from > origin + span) return -1;
+    if (findFree(from, from + length) >= 0) return from;
+    std::size_t leaf = firstLongEnough(1, 0, size, leafOf(from) + 1, length);
+    if (leaf == size) return -1;
+    return origin + static_cast<int64_t>(leaf);
+}
@@ -0,0 +1,62 @@
+// ===================== ReservationTimeline.h =====================
+#ifndef RESERVATION_TIMELINE_H
+#define RESERVATION_TIMELINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Free gaps between the reservations of one zone's spots, indexed by the
+// minute each gap starts.
+//
+// Times are whole minutes inside a window [origin, origin + minutes]; a
+// gap that began before the window sits on its first minute and an open
+// gap ends at OPEN. Two max segment trees run over the start minutes:
+// the latest gap end and the longest gap starting there. "Some spot is
+// free over [a, b)" is a prefix query (a gap starting at or before a
+// that ends at or after b) and the earliest start for a stay of d
+// minutes is either a itself or the first later minute whose longest gap
+// is >= d, both one walk down a tree.
+class ReservationTimeline {
+public:
+    static constexpr int64_t OPEN = std::numeric_limits<int64_t>::max();
+
+private:
+    int64_t origin = 0;
+    int64_t span = 0;                 // minutes; leaves cover origin .. origin + span
+    std::size_t size = 1;             // leaves, power of two
+    std::vector<int64_t> latestEnd;   // tree of max gap end
+    std::vector<int64_t> longest;     // tree of max (gap end - leaf minute)
+    // leaf -> gaps starting there as (end, spot)
+    std::unordered_map<std::size_t, std::set<std::pair<int64_t, uint32_t>>> gaps;
+
+    std::size_t leafOf(int64_t minute) const;
+    void refresh(std::size_t leaf);
+    // Leftmost leaf in [from, size) with longest >= length, size if none
+    std::size_t firstLongEnough(std::size_t node, std::size_t lo, std::size_t hi,
+                                std::size_t from, int64_t length) const;
+    // Some leaf in [0, to] with latestEnd >= end, size if none
+    std::size_t findEndingAfter(std::size_t node, std::size_t lo, std::size_t hi,
+                                std::size_t to, int64_t end) const;
+
+public:
+    explicit ReservationTimeline(int64_t origin = 0, int64_t minutes = 7 * 1440);
+
+    int64_t windowStart() const { return origin; }
+    int64_t windowEnd() const { return origin + span; }
+
+    void addGap(int64_t start, int64_t end, uint32_t spot);
+    void removeGap(int64_t start, int64_t end, uint32_t spot);
+
+    // A spot that is free over all of [start, end), -1 if none
+    int64_t findFree(int64_t start, int64_t end) const;
+    // Earliest minute t >= from with some spot free over [t, t + length),
+    // -1 if none starts inside the window
+    int64_t earliestFree(int64_t from, int64_t length) const;
+};
+
+#endif
@@ -0,0 +1,169 @@
+// ===================== SignalScheduler.cpp =====================
+#include "SignalScheduler.h"
+#include <algorithm>
+
+namespace {
+constexpr int64_t SLOT_MASK = SignalScheduler::SLOTS - 1;
+}
+
+SignalScheduler::SignalScheduler(TrafficController &t) : traffic(t) {
+    clear();
+}
+
+void SignalScheduler::clear() {
+    for (int level = 0; level < LEVELS; ++level) {
+        std::fill(heads[level], heads[level] + SLOTS, -1);
+        std::fill(occupied[level], occupied[level] + SLOTS / 64, 0);
+    }
+    overflow.clear();
+    scheduled = 0;
+}
+
+// ---------------- WHEEL ----------------
+
+void SignalScheduler::insert(int32_t index) {
+    // The highest bit in which the event time differs from the clock
+    // picks the wheel; the event's digit there picks the slot
+    uint64_t diff = static_cast<uint64_t>(due[index] ^ clock);
+    int level = diff == 0 ? 0 : (63 - __builtin_clzll(diff)) / SLOT_BITS;
+    if (level >= LEVELS) {
+        overflow.push_back(index);
+        return;
+    }
+    int slot = static_cast<int>((due[index] >> (level * SLOT_BITS)) & SLOT_MASK);
+    link[index] = heads[level][slot];
+    heads[level][slot] = index;
+    occupied[level][slot >> 6] |= 1ULL << (slot & 63);
+}
+
+int32_t SignalScheduler::takeSlot(int level, int slot) {
+    int32_t list = heads[level][slot];
+    heads[level][slot] = -1;
+    occupied[level][slot >> 6] &= ~(1ULL << (slot & 63));
+    return list;
+}
+
+void SignalScheduler::cascade(int level) {
+    int slot = static_cast<int>((clock >> (level * SLOT_BITS)) & SLOT_MASK);
+    for (int32_t i = takeSlot(level, slot); i >= 0;) {
+        int32_t next = link[i];
+        insert(i);
+        i = next;
+    }
+}
+
+void SignalScheduler::fire(int32_t index) {
+    traffic.advanceAt(index);
+    int count = 0;
+    const SignalPhase *phases = traffic.phaseList(index, count);
+    int duration = phases[traffic.phaseOf(index)].duration;
+    if (duration <= 0) {
+        due[index] = -1;
+        --scheduled;
+        return;
+    }
+    due[index] = clock + duration;
+    insert(index);
+}
+
+// ---------------- COORDINATION ----------------
+
+void SignalScheduler::setOffset(int index, int64_t seconds) {
+    if (index < 0) return;
+    if (static_cast<std::size_t>(index) >= offsets.size()) offsets.resize(index + 1, 0);
+    offsets[index] = seconds;
+}
+
+int64_t SignalScheduler::offsetOf(int index) const {
+    return index >= 0 && static_cast<std::size_t>(index) < offsets.size() ? offsets[index] : 0;
+}
+
+void SignalScheduler::coordinateCorridor(const std::vector<int> &indices,
+                                         const std::vector<int64_t> &travelSeconds,
+                                         int64_t startOffset) {
+    int64_t offset = startOffset;
+    for (std::size_t k = 0; k < indices.size(); ++k) {
+        setOffset(indices[k], offset);
+        if (k < travelSeconds.size()) offset += travelSeconds[k];
+    }
+}
+
+// ---------------- CLOCK ----------------
+
+void SignalScheduler::start(int64_t now) {
+    clear();
+    clock = now;
+    int count = traffic.intersectionCount();
+    offsets.resize(std::max<std::size_t>(offsets.size(), count), 0);
+    due.assign(count, -1);
+    link.assign(count, -1);
+
+    for (int i = 0; i < count; ++i) {
+        int phaseTotal = 0;
+        const SignalPhase *phases = traffic.phaseList(i, phaseTotal);
+        int64_t cycle = 0;
+        bool timed = phaseTotal > 0;
+        for (int p = 0; p < phaseTotal; ++p) {
+            if (phases[p].duration <= 0) timed = false;
+            cycle += phases[p].duration;
+        }
+        if (!timed) continue;
+
+        int64_t pos = (now - offsets[i]) % cycle;
+        if (pos < 0) pos += cycle;
+        int p = 0;
+        while (pos >= phases[p].duration) pos -= phases[p++].duration;
+        traffic.setPhase(i, p, static_cast<int>(pos));
+        due[i] = now + phases[p].duration - pos;
+        insert(i);
+        ++scheduled;
+    }
+}
+
+std::size_t SignalScheduler::advanceTo(int64_t time) {
+    std::size_t changes = 0;
+    while (clock < time) {
+        // Next occupied slot of the lowest wheel in this turn, or the turn's
+        // end, where the upper wheels cascade down
+        int low = static_cast<int>(clock & SLOT_MASK);
+        int slot = SLOTS;
+        for (int w = (low + 1) >> 6; w < SLOTS / 64 && (low + 1) < SLOTS; ++w) {
+            uint64_t bits = occupied[0][w];
+            if (w == (low + 1) >> 6) bits &= ~0ULL << ((low + 1) & 63);
+            if (bits) {
+                slot = (w << 6) + __builtin_ctzll(bits);
+                break;
+            }
+        }
+        int64_t next = clock - low + slot;
+        if (next > time) {
+            clock = time;
+            break;
+        }
+        clock = next;
+
+        if ((clock & SLOT_MASK) == 0) {
+            int top = 1;
+            while (top < LEVELS - 1 && (clock & ((int64_t{1} << ((top + 1) * SLOT_BITS)) - 1)) == 0) ++top;
+            if (top == LEVELS - 1 &&
+                (clock & ((int64_t{1} << (LEVELS * SLOT_BITS)) - 1)) == 0) {
+                std::vector<int32_t> waiting;
+                waiting.swap(overflow);
+                for (int32_t i : waiting) insert(i);
+            }
+            for (int level = top; level >= 1; --level) cascade(level);
+        }
+
+        for (int32_t i = takeSlot(0, static_cast<int>(clock & SLOT_MASK)); i >= 0;) {
+            int32_t nextInSlot = link[i];
+            fire(i);
+            ++changes;
+            i = nextInSlot;
+        }
+    }
+    return changes;
+}
+
+int64_t SignalScheduler::nextChange(int index) const {
+    return index >= 0 && static_cast<std::size_t>(index) < due.size() ? due[index] : -1;
+}
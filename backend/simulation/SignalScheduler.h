@@ -0,0 +1,75 @@
+// ===================== SignalScheduler.h =====================
+#ifndef SIGNAL_SCHEDULER_H
+#define SIGNAL_SCHEDULER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "TrafficController.h"
+
+// Fires the phase changes of every intersection of a TrafficController at
+// the end of each SignalPhase::duration, on a simulated clock in seconds.
+//
+// Every signal has exactly one pending event, its next phase change, kept
+// in a hierarchical timing wheel: LEVELS wheels of SLOTS slots, level L
+// holding events whose time first differs from the clock in bits
+// 8L .. 8L+7. Slots are intrusive lists through a per-intersection link,
+// so scheduling, firing and each of the (at most LEVELS) cascades of an
+// event are O(1), and the clock jumps straight to the next occupied slot
+// via a per-level occupancy bitmap.
+//
+// A signal's cycle starts phase 0 at its offset (mod the cycle length):
+// giving consecutive signals of a corridor offsets that grow by the
+// travel time between them makes a green wave.
+class SignalScheduler {
+public:
+    static constexpr int LEVELS = 4;
+    static constexpr int SLOT_BITS = 8;
+    static constexpr int SLOTS = 1 << SLOT_BITS;
+
+private:
+    TrafficController &traffic;
+    int64_t clock = 0;
+    std::vector<int64_t> offsets;     // per intersection
+    std::vector<int64_t> due;         // next change, -1 when unscheduled
+    std::vector<int32_t> link;        // next in the same slot, -1 ends
+    int32_t heads[LEVELS][SLOTS];
+    uint64_t occupied[LEVELS][SLOTS / 64];
+    std::vector<int32_t> overflow;    // beyond the top wheel
+    std::size_t scheduled = 0;
+
+    void clear();
+    void insert(int32_t index);
+    // Empties slot `slot` of `level` and returns its list
+    int32_t takeSlot(int level, int slot);
+    void cascade(int level);
+    // Advances the signal to its next phase and schedules the change after
+    void fire(int32_t index);
+
+public:
+    explicit SignalScheduler(TrafficController &traffic);
+
+    // ---------------- COORDINATION ----------------
+    void setOffset(int index, int64_t seconds);
+    int64_t offsetOf(int index) const;
+    // offsets[k + 1] = offsets[k] + travelSeconds[k] along the corridor
+    // (intersection indices), starting from startOffset
+    void coordinateCorridor(const std::vector<int> &indices,
+                            const std::vector<int64_t> &travelSeconds,
+                            int64_t startOffset = 0);
+
+    // ---------------- CLOCK ----------------
+    // Sets the clock to now, puts every signal in the phase its cycle has
+    // reached and schedules its next change. Call again after phases or
+    // offsets change. Signals with a phase of duration <= 0 keep manual
+    // control (advancePhase) and are not scheduled.
+    void start(int64_t now);
+    // Fires every change due up to time, in time order; returns how many
+    std::size_t advanceTo(int64_t time);
+    int64_t now() const { return clock; }
+    // Time of the signal's next change, -1 if unscheduled
+    int64_t nextChange(int index) const;
+    std::size_t pending() const { return scheduled; }
+};
+
+#endif
@@ -0,0 +1,53 @@
+// ===================== SimulationSnapshot.cpp =====================
+#include "SimulationSnapshot.h"
+#include "SnapshotFile.h"
+#include <iostream>
+
+SimulationSnapshot::SimulationSnapshot(CoreEngineService *e, TrafficController *t,
+                                       ParkingManager *p, VehicleSimulator *v)
+    : engine(e), traffic(t), parking(p), vehicles(v) {}
+
+bool SimulationSnapshot::snapshot(const std::string &path) {
+    failure.clear();
+    SnapshotWriter out;
+    if (out.open(path)) {
+        if (engine) engine->saveState(out);
+        if (traffic) traffic->saveState(out);
+        if (parking) parking->saveState(out);
+        if (vehicles) vehicles->saveState(out);
+    }
+    if (!out.finish()) {
+        failure = out.error();
+        std::cerr << "Snapshot failed: " << path << " (" << failure << ")\n";
+        return false;
+    }
+    bytes = out.bytesWritten();
+    return true;
+}
+
+bool SimulationSnapshot::restore(const std::string &path, bool verify) {
+    failure.clear();
+    SnapshotReader in;
+
+    // Every section is read and checked into fresh state first; nothing
+    // live changes unless all of them load
+    EngineState engineState;
+    TrafficController signals;
+    ParkingManager spots;
+    VehicleTable fleet;
+    bool ok = in.open(path, verify) && (!engine || engine->readState(in, engineState)) &&
+              (!traffic || signals.loadState(in)) && (!parking || spots.loadState(in)) &&
+              (!vehicles || fleet.loadState(in));
+    if (!ok) {
+        failure = in.error();
+        std::cerr << "Restore failed: " << path << " (" << failure << ")\n";
+        return false;
+    }
+
+    if (engine) engine->replaceState(std::move(engineState));
+    if (traffic) *traffic = std::move(signals);
+    if (parking) parking->replaceState(std::move(spots));
+    if (vehicles) vehicles->replaceVehicles(std::move(fleet));
+    bytes = in.fileBytes();
+    return true;
+}
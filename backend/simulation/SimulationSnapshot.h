@@ -0,0 +1,48 @@
+// ===================== SimulationSnapshot.h =====================
+#ifndef SIMULATION_SNAPSHOT_H
+#define SIMULATION_SNAPSHOT_H
+
+#include <cstdint>
+#include <string>
+#include "CoreEngineService.h"
+#include "ParkingManager.h"
+#include "TrafficController.h"
+#include "VehicleSimulator.h"
+
+// Saves and resumes a run: one snapshot file (see SnapshotFile.h) with a
+// section per component given here; null components are left out.
+//
+// snapshot() streams every section to disk in one sequential pass.
+// restore() maps the file, checks it, and rebuilds every component's
+// state from its section into fresh objects (large arrays are copied
+// straight out of the mapping). Only when all of them have loaded are
+// they swapped in, so a malformed or partial file leaves every component
+// as it was; the engine must sit on the same road graph the snapshot was
+// taken on. Restoring briefly holds the old and new state. Undo history,
+// caches and signal schedules are not part of the state: undo starts
+// empty and a SignalScheduler driving the controller should be started
+// again after a restore.
+class SimulationSnapshot {
+private:
+    CoreEngineService *engine;
+    TrafficController *traffic;
+    ParkingManager *parking;
+    VehicleSimulator *vehicles;
+    std::string failure;
+    uint64_t bytes = 0;
+
+public:
+    SimulationSnapshot(CoreEngineService *engine, TrafficController *traffic,
+                       ParkingManager *parking, VehicleSimulator *vehicles);
+
+    bool snapshot(const std::string &path);
+    // verify = false skips the checksum pass over the file
+    bool restore(const std::string &path, bool verify = true);
+
+    // Why the last call failed
+    const std::string &error() const { return failure; }
+    // Size of the file last written or read
+    uint64_t fileBytes() const { return bytes; }
+};
+
+#endif
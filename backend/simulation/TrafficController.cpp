@@ -1,78 +1,312 @@
 // ===================== TrafficController.cpp =====================
 #include "TrafficController.h"
-#include <iostream>
+#include "SnapshotFile.h"
+#include <algorithm>
+#include <cctype>
 
-TrafficController::TrafficController() {}
+// ---------------- DIRECTIONS ----------------
+
+uint8_t parseApproaches(const std::string &direction) {
+    uint8_t mask = 0;
+    bool tokenStart = true;
+    for (char ch : direction) {
+        if (ch == '-' || ch == '/' || ch == ',' || ch == ' ' || ch == '+') {
+            tokenStart = true;
+            continue;
+        }
+        if (!tokenStart) continue;
+        tokenStart = false;
+        switch (std::toupper(static_cast<unsigned char>(ch))) {
+        case 'N': mask |= approachBit(Approach::North); break;
+        case 'E': mask |= approachBit(Approach::East); break;
+        case 'S': mask |= approachBit(Approach::South); break;
+        case 'W': mask |= approachBit(Approach::West); break;
+        default: break;
+        }
+    }
+    return mask;
+}
+
+std::string approachesName(uint8_t mask) {
+    static const char letters[APPROACHES] = {'N', 'E', 'S', 'W'};
+    // Opposite approaches read better paired: N-S before E-W
+    static const int order[APPROACHES] = {0, 2, 1, 3};
+    std::string name;
+    for (int k : order) {
+        if (!(mask & (1u << k))) continue;
+        if (!name.empty()) name += '-';
+        name += letters[k];
+    }
+    return name;
+}
+
+TrafficController::TrafficController(int capacity) : laneCapacity(std::max(capacity, 1)) {}
 
 // ---------------- SETUP ----------------
 
-void TrafficController::addIntersection(int intersectionID) {
-    if (intersectionQueues.find(intersectionID) == intersectionQueues.end()) {
-        intersectionQueues[intersectionID] = {};
-        signalPhases[intersectionID] = {};
-        currentPhaseIndex[intersectionID] = 0;
+int TrafficController::addIntersection(int intersectionID) {
+    auto it = indexOf.find(intersectionID);
+    if (it != indexOf.end()) return it->second;
+
+    int index = static_cast<int>(ids.size());
+    indexOf.emplace(intersectionID, index);
+    ids.push_back(intersectionID);
+    phases.resize(phases.size() + MAX_PHASES, SignalPhase{0, 0, false});
+    phaseCount.push_back(0);
+    currentPhase.push_back(0);
+    phaseElapsed.push_back(0);
+    nextServe.push_back(0);
+    laneHead.resize(laneHead.size() + APPROACHES, 0);
+    laneCount.resize(laneCount.size() + APPROACHES, 0);
+    arena.resize(arena.size() + static_cast<std::size_t>(APPROACHES) * laneCapacity);
+    return index;
+}
+
+bool TrafficController::addSignalPhase(int index, uint8_t green, int duration, bool yellow) {
+    if (index < 0 || index >= intersectionCount() || phaseCount[index] >= MAX_PHASES) {
+        return false;
     }
+    phases[static_cast<std::size_t>(index) * MAX_PHASES + phaseCount[index]++] = {green, duration, yellow};
+    return true;
 }
 
-void TrafficController::addSignalPhase(int intersectionID,
+bool TrafficController::addSignalPhase(int intersectionID,
                                        const std::string &direction,
                                        int duration) {
-    addIntersection(intersectionID);
-    signalPhases[intersectionID].push_back({direction, duration});
+    // "N-S yellow" marks a clearance phase
+    bool yellow = direction.find("yellow") != std::string::npos ||
+                  direction.find("amber") != std::string::npos;
+    std::string approaches = direction.substr(0, direction.find(' '));
+    return addSignalPhase(addIntersection(intersectionID), parseApproaches(approaches),
+                          duration, yellow);
+}
+
+int TrafficController::intersectionIndex(int intersectionID) const {
+    auto it = indexOf.find(intersectionID);
+    return it == indexOf.end() ? -1 : it->second;
 }
 
 // ---------------- QUEUE HANDLING ----------------
 
-void TrafficController::enqueueVehicle(int intersectionID,
+bool TrafficController::enqueueVehicle(int index, Approach approach, int vehicleID) {
+    if (index < 0 || index >= intersectionCount()) return false;
+    std::size_t lane = static_cast<std::size_t>(index) * APPROACHES + static_cast<int>(approach);
+    if (laneCount[lane] == static_cast<uint32_t>(laneCapacity)) return false;
+
+    uint32_t slot = (laneHead[lane] + laneCount[lane]) % laneCapacity;
+    arena[lane * laneCapacity + slot] = vehicleID;
+    ++laneCount[lane];
+    return true;
+}
+
+bool TrafficController::enqueueVehicle(int intersectionID,
                                        const std::string &direction,
                                        int vehicleID) {
-    addIntersection(intersectionID);
-    intersectionQueues[intersectionID][direction].vehicles.push(vehicleID);
+    uint8_t mask = parseApproaches(direction);
+    if (mask == 0) return false;
+    int first = 0;
+    while (!(mask & (1u << first))) ++first;
+    return enqueueVehicle(addIntersection(intersectionID), static_cast<Approach>(first), vehicleID);
 }
 
-int TrafficController::dequeueVehicle(int intersectionID) {
-    std::string currentDir = getCurrentDirection(intersectionID);
-    if (currentDir.empty()) return -1;
+int TrafficController::popLane(std::size_t lane) {
+    int v = arena[lane * laneCapacity + laneHead[lane]];
+    laneHead[lane] = (laneHead[lane] + 1) % laneCapacity;
+    --laneCount[lane];
+    return v;
+}
 
-    auto &lane = intersectionQueues[intersectionID][currentDir].vehicles;
+int TrafficController::dequeueAt(int index) {
+    uint8_t green = greenMask(index);
+    if (green == 0) return -1;
 
-    if (lane.empty()) return -1;
-    int v = lane.front();
-    lane.pop();
-    return v;
+    std::size_t base = static_cast<std::size_t>(index) * APPROACHES;
+    for (int k = 0; k < APPROACHES; ++k) {
+        int a = (nextServe[index] + k) % APPROACHES;
+        if (!(green & (1u << a)) || laneCount[base + a] == 0) continue;
+        nextServe[index] = static_cast<uint8_t>((a + 1) % APPROACHES);
+        return popLane(base + a);
+    }
+    return -1;
+}
+
+int TrafficController::dequeueVehicle(int intersectionID) {
+    int index = intersectionIndex(intersectionID);
+    return index < 0 ? -1 : dequeueAt(index);
 }
 
 // ---------------- SIGNAL HANDLING ----------------
 
+void TrafficController::advanceAt(int index) {
+    if (index < 0 || index >= intersectionCount() || phaseCount[index] == 0) return;
+    currentPhase[index] = static_cast<uint8_t>((currentPhase[index] + 1) % phaseCount[index]);
+    phaseElapsed[index] = 0;
+}
+
 void TrafficController::advancePhase(int intersectionID) {
-    auto it = signalPhases.find(intersectionID);
-    if (it == signalPhases.end() || it->second.empty()) return;
+    advanceAt(intersectionIndex(intersectionID));
+}
 
-    int &idx = currentPhaseIndex[intersectionID];
-    idx = (idx + 1) % static_cast<int>(it->second.size());
+uint8_t TrafficController::greenMask(int index) const {
+    if (index < 0 || index >= intersectionCount() || phaseCount[index] == 0) return 0;
+    return phases[static_cast<std::size_t>(index) * MAX_PHASES + currentPhase[index]].green;
 }
 
 std::string TrafficController::getCurrentDirection(int intersectionID) const {
-    auto it = signalPhases.find(intersectionID);
-    if (it == signalPhases.end() || it->second.empty()) return "";
+    int index = intersectionIndex(intersectionID);
+    if (index < 0 || phaseCount[index] == 0) return "";
+    const SignalPhase &phase = phases[static_cast<std::size_t>(index) * MAX_PHASES + currentPhase[index]];
+    return approachesName(phase.green) + (phase.yellow ? " yellow" : "");
+}
 
-    auto idxIt = currentPhaseIndex.find(intersectionID);
-    int idx = 0;
-    if (idxIt != currentPhaseIndex.end()) idx = idxIt->second;
-    if (idx < 0 || idx >= static_cast<int>(it->second.size())) idx = 0;
+const SignalPhase *TrafficController::phaseList(int index, int &count) const {
+    count = phaseCount[index];
+    return phases.data() + static_cast<std::size_t>(index) * MAX_PHASES;
+}
 
-    return it->second[idx].direction;
+void TrafficController::setPhase(int index, int phase, int elapsed) {
+    if (index < 0 || index >= intersectionCount() || phaseCount[index] == 0) return;
+    currentPhase[index] = static_cast<uint8_t>(phase % phaseCount[index]);
+    phaseElapsed[index] = elapsed;
+}
+
+void TrafficController::tickAll(int seconds, int perLane, std::vector<int> *discharged) {
+    int count = intersectionCount();
+    for (int i = 0; i < count; ++i) {
+        int phaseTotal = phaseCount[i];
+        if (phaseTotal == 0) continue;
+
+        const SignalPhase *own = phases.data() + static_cast<std::size_t>(i) * MAX_PHASES;
+        int cur = currentPhase[i];
+        int elapsed = phaseElapsed[i] + seconds;
+        while (own[cur].duration > 0 && elapsed >= own[cur].duration) {
+            elapsed -= own[cur].duration;
+            cur = (cur + 1) % phaseTotal;
+        }
+        currentPhase[i] = static_cast<uint8_t>(cur);
+        phaseElapsed[i] = elapsed;
+
+        dischargeAt(i, own[cur].green, perLane, discharged);
+    }
+}
+
+void TrafficController::dischargeAt(int index, uint8_t green, int perLane,
+                                    std::vector<int> *discharged) {
+    std::size_t base = static_cast<std::size_t>(index) * APPROACHES;
+    for (int a = 0; a < APPROACHES; ++a) {
+        if (!(green & (1u << a))) continue;
+        std::size_t lane = base + a;
+        for (int k = 0; k < perLane && laneCount[lane] > 0; ++k) {
+            int v = popLane(lane);
+            if (discharged) discharged->push_back(v);
+        }
+    }
+}
+
+void TrafficController::dischargeAll(int perLane, std::vector<int> *discharged) {
+    int count = intersectionCount();
+    for (int i = 0; i < count; ++i) {
+        if (phaseCount[i] == 0) continue;
+        dischargeAt(i, phases[static_cast<std::size_t>(i) * MAX_PHASES + currentPhase[i]].green,
+                    perLane, discharged);
+    }
 }
 
 // ---------------- MONITORING ----------------
 
+int TrafficController::queueLength(int index, Approach approach) const {
+    if (index < 0 || index >= intersectionCount()) return 0;
+    return static_cast<int>(laneCount[static_cast<std::size_t>(index) * APPROACHES +
+                                      static_cast<int>(approach)]);
+}
+
 int TrafficController::getQueueLength(int intersectionID,
                                       const std::string &direction) const {
-    auto it = intersectionQueues.find(intersectionID);
-    if (it == intersectionQueues.end()) return 0;
+    uint8_t mask = parseApproaches(direction);
+    if (mask == 0) return 0;
+    int first = 0;
+    while (!(mask & (1u << first))) ++first;
+    return queueLength(intersectionIndex(intersectionID), static_cast<Approach>(first));
+}
 
-    auto laneIt = it->second.find(direction);
-    if (laneIt == it->second.end()) return 0;
+// ---------------- SNAPSHOT ----------------
+
+namespace {
+constexpr uint32_t SIGNALS_VERSION = 2;   // 2: phases as columns
+}
+
+void TrafficController::saveState(SnapshotWriter &out) const {
+    out.beginSection(SNAPSHOT_SIGNALS, SIGNALS_VERSION);
+    out.put<int64_t>(laneCapacity);
+    out.putArray(ids);
+    // Phases field by field: SignalPhase's padding must not reach the file
+    std::vector<uint8_t> green(phases.size()), yellow(phases.size());
+    std::vector<int> duration(phases.size());
+    for (std::size_t p = 0; p < phases.size(); ++p) {
+        green[p] = phases[p].green;
+        duration[p] = phases[p].duration;
+        yellow[p] = phases[p].yellow ? 1 : 0;
+    }
+    out.putArray(green);
+    out.putArray(duration);
+    out.putArray(yellow);
+    out.putArray(phaseCount);
+    out.putArray(currentPhase);
+    out.putArray(phaseElapsed);
+    out.putArray(nextServe);
+    out.putArray(laneHead);
+    out.putArray(laneCount);
+    out.putArray(arena);
+    out.endSection();
+}
 
-    return static_cast<int>(laneIt->second.vehicles.size());
+bool TrafficController::loadState(SnapshotReader &in) {
+    uint32_t version = 0;
+    int64_t capacity = 0;
+    TrafficController loaded;
+    std::vector<uint8_t> green, yellow;
+    std::vector<int> duration;
+    if (!in.enter(SNAPSHOT_SIGNALS, SIGNALS_VERSION, version)) return false;
+    if (version < 2) return in.fail("signal section is from an older build");
+    if (!in.get(capacity) || !in.getArray(loaded.ids) || !in.getArray(green) ||
+        !in.getArray(duration) || !in.getArray(yellow) || !in.getArray(loaded.phaseCount) ||
+        !in.getArray(loaded.currentPhase) || !in.getArray(loaded.phaseElapsed) ||
+        !in.getArray(loaded.nextServe) || !in.getArray(loaded.laneHead) ||
+        !in.getArray(loaded.laneCount) || !in.getArray(loaded.arena)) {
+        return false;
+    }
+
+    std::size_t count = loaded.ids.size();
+    std::size_t lanes = count * APPROACHES;
+    if (capacity < 1 || capacity > (int64_t{1} << 24) || green.size() != count * MAX_PHASES ||
+        duration.size() != green.size() || yellow.size() != green.size() ||
+        loaded.phaseCount.size() != count || loaded.currentPhase.size() != count ||
+        loaded.phaseElapsed.size() != count || loaded.nextServe.size() != count ||
+        loaded.laneHead.size() != lanes || loaded.laneCount.size() != lanes ||
+        loaded.arena.size() != lanes * static_cast<std::size_t>(capacity)) {
+        return in.fail("signal arrays do not match the intersection count");
+    }
+    loaded.laneCapacity = static_cast<int>(capacity);
+    loaded.phases.resize(green.size());
+    for (std::size_t p = 0; p < green.size(); ++p) {
+        if (yellow[p] > 1) return in.fail("signal phase yellow flag is not 0 or 1");
+        loaded.phases[p] = {green[p], duration[p], yellow[p] == 1};
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        if (loaded.phaseCount[i] > MAX_PHASES ||
+            (loaded.phaseCount[i] > 0 && loaded.currentPhase[i] >= loaded.phaseCount[i])) {
+            return in.fail("signal phase out of range at intersection " + std::to_string(loaded.ids[i]));
+        }
+        if (!loaded.indexOf.emplace(loaded.ids[i], static_cast<int>(i)).second) {
+            return in.fail("intersection " + std::to_string(loaded.ids[i]) + " appears twice");
+        }
+    }
+    for (std::size_t lane = 0; lane < lanes; ++lane) {
+        if (loaded.laneHead[lane] >= static_cast<uint32_t>(capacity) ||
+            loaded.laneCount[lane] > static_cast<uint32_t>(capacity)) {
+            return in.fail("signal lane out of range");
+        }
+    }
+    *this = std::move(loaded);
+    return true;
 }
@@ -2,50 +2,117 @@
 #ifndef TRAFFIC_CONTROLLER_H
 #define TRAFFIC_CONTROLLER_H
 
-#include <queue>
+#include <cstdint>
 #include <unordered_map>
 #include <vector>
 #include <string>
 
-// Represents a lane queue at an intersection
-struct LaneQueue {
-    std::queue<int> vehicles;   // store vehicle IDs
+class SnapshotWriter;
+class SnapshotReader;
+
+// Approach lanes of an intersection; a phase turns a set of them green
+enum class Approach : uint8_t {
+    North,
+    East,
+    South,
+    West
 };
+constexpr int APPROACHES = 4;
+inline uint8_t approachBit(Approach a) { return static_cast<uint8_t>(1u << static_cast<int>(a)); }
+
+// "N-S", "E", "north/south", ... -> approach bits (0 if nothing matches)
+uint8_t parseApproaches(const std::string &direction);
+// Inverse of parseApproaches for display: "N-S", "E-W", "N", ...
+std::string approachesName(uint8_t mask);
 
 // Represents a traffic light phase
 struct SignalPhase {
-    std::string direction; // e.g. "N-S", "E-W"
-    int duration;          // in seconds (for future extension)
+    uint8_t green;         // approach bits
+    int duration;          // in seconds; <= 0 only changes on advancePhase
+    bool yellow = false;   // clearance interval of the green approaches
 };
 
+// Intersections are interned to dense indices (addIntersection order) and
+// all state lives in flat arrays: up to MAX_PHASES phases per
+// intersection, and one fixed-capacity ring buffer of vehicle ids per
+// approach, all rings in a single arena. Intersection ids and direction
+// strings are only translated at the API boundary.
 class TrafficController {
+public:
+    static constexpr int MAX_PHASES = 8;
+
 private:
-    // intersectionID -> direction -> queue
-    std::unordered_map<int, std::unordered_map<std::string, LaneQueue>> intersectionQueues;
+    int laneCapacity;
+    std::unordered_map<int, int> indexOf;   // intersectionID -> index
+    std::vector<int> ids;                   // index -> intersectionID
 
-    // intersectionID -> list of phases
-    std::unordered_map<int, std::vector<SignalPhase>> signalPhases;
+    // Per intersection
+    std::vector<SignalPhase> phases;        // MAX_PHASES slots each
+    std::vector<uint8_t> phaseCount;
+    std::vector<uint8_t> currentPhase;
+    std::vector<int> phaseElapsed;          // seconds into the current phase
+    std::vector<uint8_t> nextServe;         // round-robin start among green lanes
 
-    // intersectionID -> current phase index
-    std::unordered_map<int, int> currentPhaseIndex;
+    // Per lane (index * APPROACHES + approach)
+    std::vector<uint32_t> laneHead;
+    std::vector<uint32_t> laneCount;
+    std::vector<int> arena;                 // laneCapacity slots per lane
+
+    int popLane(std::size_t lane);
+    void dischargeAt(int index, uint8_t green, int perLane, std::vector<int> *discharged);
 
 public:
-    TrafficController();
+    // laneCapacity: vehicles each approach lane can hold
+    explicit TrafficController(int laneCapacity = 64);
 
     // ---------------- SETUP ----------------
-    void addIntersection(int intersectionID);
-    void addSignalPhase(int intersectionID, const std::string &direction, int duration);
+    // Returns the intersection's index (existing ids keep theirs)
+    int addIntersection(int intersectionID);
+    // False once the intersection has MAX_PHASES phases
+    bool addSignalPhase(int intersectionID, const std::string &direction, int duration);
+    bool addSignalPhase(int index, uint8_t green, int duration, bool yellow = false);
+    // -1 if unknown
+    int intersectionIndex(int intersectionID) const;
+    int intersectionCount() const { return static_cast<int>(ids.size()); }
+    int intersectionId(int index) const { return ids[index]; }
 
     // ---------------- QUEUE HANDLING ----------------
-    void enqueueVehicle(int intersectionID, const std::string &direction, int vehicleID);
+    // False if the lane is full. A direction naming several approaches
+    // (a phase label such as "N-S") queues on the first of them.
+    bool enqueueVehicle(int intersectionID, const std::string &direction, int vehicleID);
+    bool enqueueVehicle(int index, Approach approach, int vehicleID);
+    // Next vehicle from a green lane, round robin over the green lanes;
+    // -1 if they are all empty
     int dequeueVehicle(int intersectionID);
+    int dequeueAt(int index);
 
     // ---------------- SIGNAL HANDLING ----------------
     void advancePhase(int intersectionID);
+    void advanceAt(int index);
     std::string getCurrentDirection(int intersectionID) const;
+    uint8_t greenMask(int index) const;
+    int phaseOf(int index) const { return currentPhase[index]; }
+    const SignalPhase *phaseList(int index, int &count) const;
+    void setPhase(int index, int phase, int elapsed = 0);
+
+    // One pass over every intersection: phase clocks run for `seconds`
+    // (rolling over to the next phase(s) when their durations end), then
+    // each green lane lets up to perLane vehicles go. Discharged vehicle
+    // ids are appended to discharged when given.
+    void tickAll(int seconds = 1, int perLane = 1, std::vector<int> *discharged = nullptr);
+    // The discharge half of tickAll, for when a SignalScheduler drives
+    // the phase changes
+    void dischargeAll(int perLane = 1, std::vector<int> *discharged = nullptr);
 
     // ---------------- MONITORING ----------------
     int getQueueLength(int intersectionID, const std::string &direction) const;
+    int queueLength(int index, Approach approach) const;
+
+    // ---------------- SNAPSHOT ----------------
+    // Intersections, phase plans and clocks, and every queued vehicle;
+    // loading replaces them (lane capacity included)
+    void saveState(SnapshotWriter &out) const;
+    bool loadState(SnapshotReader &in);
 };
 
 #endif
@@ -0,0 +1,91 @@
+// ===================== UndoJournal.cpp =====================
+#include "UndoJournal.h"
+
+namespace {
+std::size_t powerOfTwo(std::size_t n) {
+    std::size_t size = 1;
+    while (size < n) size <<= 1;
+    return size;
+}
+}
+
+UndoJournal::UndoJournal(std::size_t entries, std::size_t checkpoints) {
+    resize(entries, checkpoints);
+}
+
+void UndoJournal::resize(std::size_t entries, std::size_t checkpoints) {
+    ring.assign(powerOfTwo(entries), UndoEntry{});
+    mask = ring.size() - 1;
+    marks.assign(powerOfTwo(checkpoints), 0);
+    markMask = marks.size() - 1;
+    clear();
+}
+
+void UndoJournal::clear() {
+    head = tail = 0;
+    markHead = markTail = 0;
+    depth = 0;
+    started = false;
+}
+
+// ---------------- LOGGING ----------------
+
+void UndoJournal::record(UndoEntry entry) {
+    entry.actionStart = depth == 0 || !started;
+    started = depth > 0;
+    ring[head & mask] = entry;
+    ++head;
+    if (head - tail > ring.size()) {
+        tail = head - ring.size();
+        while (markTail < markHead && marks[markTail & markMask] < tail) ++markTail;
+    }
+}
+
+void UndoJournal::openAction() {
+    ++depth;
+}
+
+void UndoJournal::closeAction() {
+    if (depth > 0 && --depth == 0) started = false;
+}
+
+void UndoJournal::checkpoint() {
+    if (markHead > markTail && marks[(markHead - 1) & markMask] == head) return;
+    marks[markHead & markMask] = head;
+    ++markHead;
+    if (markHead - markTail > marks.size()) markTail = markHead - marks.size();
+}
+
+// ---------------- UNDO ----------------
+
+void UndoJournal::unwind(uint64_t seq, const Apply &apply) {
+    for (uint64_t s = head; s > seq;) {
+        --s;
+        if (apply) apply(at(s));
+    }
+    head = seq;
+    while (markHead > markTail && marks[(markHead - 1) & markMask] > head) --markHead;
+}
+
+std::size_t UndoJournal::undoActions(std::size_t n, const Apply &apply) {
+    // Find the start of the n-th action back without touching any state
+    uint64_t seq = head;
+    std::size_t found = 0;
+    for (uint64_t s = head; found < n && s > tail;) {
+        --s;
+        if (at(s).actionStart) {
+            seq = s;
+            ++found;
+        }
+    }
+    unwind(seq, apply);
+    return found;
+}
+
+bool UndoJournal::rollback(std::size_t steps, const Apply &apply) {
+    if (steps == 0 || steps > checkpoints()) return false;
+    uint64_t seq = marks[(markHead - steps) & markMask];
+    if (seq < tail) return false;
+    unwind(seq, apply);
+    return true;
+}
@@ -0,0 +1,102 @@
+// ===================== UndoJournal.h =====================
+#ifndef UNDO_JOURNAL_H
+#define UNDO_JOURNAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Which component an entry belongs to; kind is that component's own enum
+enum class UndoDomain : uint8_t {
+    Vehicles,   // VehicleChange
+    Parking     // ParkingChange
+};
+
+// One logged change with the state it replaced. Plain data, 32 bytes.
+struct UndoEntry {
+    UndoDomain domain;
+    uint8_t kind;
+    uint8_t actionStart;   // 1 on the first entry of an action
+    uint8_t reserved;
+    int32_t target;        // vehicle id, spot id
+    int32_t before;        // previous node, previous vehicle in the spot, ...
+    int32_t flag;          // previous parked / occupied bit
+    int64_t start;         // reservation interval
+    int64_t end;
+};
+
+// Undo log shared by the simulation components, kept in a ring of fixed
+// capacity: once it is full the oldest entries are overwritten, so memory
+// stays flat however long a run is, and only the most recent history can
+// be undone.
+//
+// Entries are grouped into actions (one user-level change, e.g. a parking
+// that touches a spot and a vehicle): an entry logged outside an
+// openAction / closeAction pair is an action of its own, inside one only
+// the first entry starts it. Checkpoints mark step boundaries (one per
+// simulation tick); rolling back N steps jumps straight to the N-th
+// latest checkpoint and applies the entries after it newest first in one
+// pass over the ring.
+//
+// Components never undo themselves: the journal hands each entry to an
+// apply function, which the owner of a shared journal sets to dispatch on
+// entry.domain. Applying must not log.
+class UndoJournal {
+public:
+    using Apply = std::function<void(const UndoEntry &)>;
+
+private:
+    std::vector<UndoEntry> ring;
+    std::size_t mask = 0;
+    uint64_t head = 0;                   // sequence number of the next entry
+    uint64_t tail = 0;                   // oldest entry still in the ring
+    std::vector<uint64_t> marks;         // checkpoint sequence numbers (ring)
+    std::size_t markMask = 0;
+    uint64_t markHead = 0, markTail = 0;
+    int depth = 0;                       // open actions
+    bool started = false;                // the open action has its first entry
+    Apply applier;
+
+    const UndoEntry &at(uint64_t seq) const { return ring[seq & mask]; }
+    // Undoes entries down to seq (exclusive of older ones) and drops the
+    // checkpoints past it
+    void unwind(uint64_t seq, const Apply &apply);
+
+public:
+    // Capacities are rounded up to powers of two
+    explicit UndoJournal(std::size_t entries = 1 << 16, std::size_t checkpoints = 256);
+    // Drops the history
+    void resize(std::size_t entries, std::size_t checkpoints = 256);
+    void clear();
+
+    // ---------------- LOGGING ----------------
+    void record(UndoEntry entry);
+    void openAction();
+    void closeAction();
+    // Marks the current state as a step boundary
+    void checkpoint();
+
+    // ---------------- UNDO ----------------
+    void setApplier(Apply apply) { applier = std::move(apply); }
+    // Undoes the last n actions, or fewer when the ring no longer holds
+    // all of them (a partly overwritten action is never applied); returns
+    // how many were undone
+    std::size_t undoActions(std::size_t n, const Apply &apply);
+    std::size_t undoActions(std::size_t n) { return undoActions(n, applier); }
+    // Back to the n-th latest checkpoint (1: the latest), which is kept;
+    // false and nothing done if that checkpoint is not in the ring
+    bool rollback(std::size_t steps, const Apply &apply);
+    bool rollback(std::size_t steps) { return rollback(steps, applier); }
+
+    // ---------------- STATUS ----------------
+    std::size_t size() const { return static_cast<std::size_t>(head - tail); }
+    std::size_t capacity() const { return ring.size(); }
+    std::size_t checkpoints() const { return static_cast<std::size_t>(markHead - markTail); }
+    bool empty() const { return head == tail; }
+    std::size_t memoryBytes() const {
+        return ring.capacity() * sizeof(UndoEntry) + marks.capacity() * sizeof(uint64_t);
+    }
+};
+
+#endif
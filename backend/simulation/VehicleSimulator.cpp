@@ -1,112 +1,195 @@
 // ===================== VehicleSimulator.cpp =====================
 #include "VehicleSimulator.h"
+#include <algorithm>
 #include <iostream>
 #include <limits>
 
 VehicleSimulator::VehicleSimulator(TrafficController *t,
                                    ParkingManager *p,
                                    CoreEngineService *c)
-    : trafficController(t), parkingManager(p), coreEngine(c) {}
+    : trafficController(t), parkingManager(p), coreEngine(c) {
+    journal.setApplier([this](const UndoEntry &entry) { applyUndo(entry); });
+    if (parkingManager) parkingManager->attachJournal(&journal);
+}
+
+VehicleSimulator::~VehicleSimulator() {
+    if (parkingManager) parkingManager->attachJournal(nullptr);
+}
 
 // ---------------- VEHICLE MANAGEMENT ----------------
 
 void VehicleSimulator::addVehicle(int id, int startNode, int destinationNode) {
-    Vehicle v;
-    v.id = id;
-    v.currentNode = startNode;
-    v.destinationNode = destinationNode;
-    v.parked = false;
-    vehicles[id] = v;
+    vehicles.add(id, startNode, destinationNode);
 }
 
 void VehicleSimulator::removeVehicle(int id) {
-    vehicles.erase(id);
+    vehicles.remove(id);
 }
 
 // ---------------- MOVEMENT / SIMULATION ----------------
 
 void VehicleSimulator::moveVehicle(int id) {
-    auto it = vehicles.find(id);
-    if (it == vehicles.end() || !coreEngine) return;
+    int64_t found = vehicles.find(id);
+    if (found < 0 || !coreEngine) return;
 
-    Vehicle &v = it->second;
-    if (v.parked) return;
+    uint32_t slot = static_cast<uint32_t>(found);
+    if (vehicles.parked(slot)) return;
 
-    // For now, just compute distance and "jump" to destination if reachable.
-    std::vector<double> dist = coreEngine->computeRoute(v.currentNode);
-
-    if (v.destinationNode <= 0 ||
-        v.destinationNode >= static_cast<int>(dist.size())) {
-        return;
-    }
-
-    if (dist[v.destinationNode] == std::numeric_limits<double>::infinity()) {
+    std::vector<double> cost = coreEngine->computeTripCosts({vehicles.node(slot)},
+                                                            {vehicles.destination(slot)});
+    if (cost[0] == std::numeric_limits<double>::infinity()) {
         // No path known
         return;
     }
+    commitMove(slot);
+}
 
-    // Save undo action
-    UndoAction action;
-    action.type = "movement";
-    action.targetID = std::to_string(v.id);
-    action.prevOccupied = false;
-    action.prevVehicleID = v.currentNode;
-    undoStack.pushAction(action);
+void VehicleSimulator::commitMove(uint32_t slot) {
+    UndoEntry entry{};
+    entry.domain = UndoDomain::Vehicles;
+    entry.kind = static_cast<uint8_t>(VehicleChange::Move);
+    entry.target = vehicles.id(slot);
+    entry.before = vehicles.node(slot);
+    journal.record(entry);
 
     // Simplified: directly move to destination
-    v.currentNode = v.destinationNode;
+    vehicles.setNode(slot, vehicles.destination(slot));
+    vehicles.setCursor(slot, 0);
 }
 
 void VehicleSimulator::simulateStep() {
-    for (auto &kv : vehicles) {
-        moveVehicle(kv.first);
+    if (!coreEngine) return;
+    journal.checkpoint();
+
+    // Snapshot the trips in id order; the parallel phase only reads these
+    std::vector<uint32_t> slots;
+    vehicles.unparked(slots);
+    const int32_t *ids = vehicles.idColumn();
+    std::sort(slots.begin(), slots.end(), [ids](uint32_t a, uint32_t b) { return ids[a] < ids[b]; });
+
+    const int32_t *nodes = vehicles.nodeColumn();
+    const int32_t *destinations = vehicles.destinationColumn();
+    std::vector<int> sources(slots.size()), dests(slots.size());
+    for (std::size_t k = 0; k < slots.size(); ++k) {
+        sources[k] = nodes[slots[k]];
+        dests[k] = destinations[slots[k]];
+    }
+
+    std::vector<double> cost = coreEngine->computeTripCosts(sources, dests);
+
+    // Merge: state changes and undo entries in id order
+    for (std::size_t k = 0; k < slots.size(); ++k) {
+        if (cost[k] == std::numeric_limits<double>::infinity()) continue;
+        commitMove(slots[k]);
     }
 }
 
 // ---------------- PARKING ----------------
 
+void VehicleSimulator::recordParking(uint32_t slot) {
+    UndoEntry entry{};
+    entry.domain = UndoDomain::Vehicles;
+    entry.kind = static_cast<uint8_t>(VehicleChange::Parked);
+    entry.target = vehicles.id(slot);
+    entry.flag = vehicles.parked(slot) ? 1 : 0;
+    journal.record(entry);
+
+    vehicles.setParked(slot, true);
+}
+
 bool VehicleSimulator::tryParking(int vehicleID, int zone) {
     if (!parkingManager) return false;
 
-    auto it = vehicles.find(vehicleID);
-    if (it == vehicles.end()) return false;
+    int64_t slot = vehicles.find(vehicleID);
+    if (slot < 0 || vehicles.parked(static_cast<uint32_t>(slot))) return false;
 
-    Vehicle &v = it->second;
-    if (v.parked) return false;
+    int spot = parkingManager->findFreeSpot(zone);
+    if (spot < 0) return false;
 
-    std::string spotID = parkingManager->findNearestFreeSpot(zone);
-    if (spotID.empty()) return false;
+    // The spot's entry and the vehicle's form one action
+    journal.openAction();
+    bool parked = parkingManager->assignSpot(static_cast<uint32_t>(spot), vehicleID);
+    if (parked) recordParking(static_cast<uint32_t>(slot));
+    journal.closeAction();
+    return parked;
+}
+
+bool VehicleSimulator::tryParkingNearby(int vehicleID, double maxCost) {
+    if (!parkingManager || !coreEngine) return false;
 
-    if (!parkingManager->assignSpot(spotID, vehicleID)) return false;
+    int64_t slot = vehicles.find(vehicleID);
+    if (slot < 0 || vehicles.parked(static_cast<uint32_t>(slot))) return false;
 
-    // Save parking undo action (we delegate actual state revert to ParkingManager)
-    UndoAction action;
-    action.type = "parking";
-    action.targetID = spotID;
-    action.prevOccupied = false;
-    action.prevVehicleID = -1;
-    undoStack.pushAction(action);
+    std::vector<ParkingMatch> match = parkingManager->findNearestFreeSpots(
+        coreEngine->roadGraph(), vehicles.node(static_cast<uint32_t>(slot)), 1, maxCost);
+    if (match.empty()) return false;
+
+    journal.openAction();
+    bool parked = parkingManager->assignSpot(static_cast<uint32_t>(match[0].spot), vehicleID);
+    if (parked) recordParking(static_cast<uint32_t>(slot));
+    journal.closeAction();
+    return parked;
+}
 
-    v.parked = true;
+// ---------------- STATUS ----------------
+
+bool VehicleSimulator::getVehicle(int id, Vehicle &out) const {
+    int64_t slot = vehicles.find(id);
+    if (slot < 0) return false;
+    uint32_t s = static_cast<uint32_t>(slot);
+    out = {id, vehicles.node(s), vehicles.destination(s), vehicles.parked(s)};
     return true;
 }
 
+std::vector<int> VehicleSimulator::vehiclesAt(int node) const {
+    std::vector<uint32_t> slots;
+    vehicles.unparkedAt(node, slots);
+    std::vector<int> out(slots.size());
+    for (std::size_t k = 0; k < slots.size(); ++k) out[k] = vehicles.id(slots[k]);
+    return out;
+}
+
 // ---------------- UNDO ----------------
 
 void VehicleSimulator::undoLastAction() {
-    if (!undoStack.hasUndo()) return;
-
-    UndoAction a = undoStack.popAction();
-
-    if (a.type == "movement") {
-        int id = std::stoi(a.targetID);
-        auto it = vehicles.find(id);
-        if (it != vehicles.end()) {
-            it->second.currentNode = a.prevVehicleID;
-        }
-    } else if (a.type == "parking") {
-        if (parkingManager) {
-            parkingManager->undoLastChange();
-        }
+    journal.undoActions(1);
+}
+
+bool VehicleSimulator::rollbackSteps(std::size_t steps) {
+    return journal.rollback(steps);
+}
+
+void VehicleSimulator::setUndoCapacity(std::size_t entries, std::size_t steps) {
+    journal.resize(entries, steps);
+}
+
+void VehicleSimulator::applyUndo(const UndoEntry &entry) {
+    if (entry.domain == UndoDomain::Parking) {
+        if (parkingManager) parkingManager->applyUndo(entry);
+        return;
+    }
+    int64_t slot = vehicles.find(entry.target);
+    if (slot < 0) return;
+    switch (static_cast<VehicleChange>(entry.kind)) {
+    case VehicleChange::Move:
+        vehicles.setNode(static_cast<uint32_t>(slot), entry.before);
+        break;
+    case VehicleChange::Parked:
+        vehicles.setParked(static_cast<uint32_t>(slot), entry.flag != 0);
+        break;
     }
 }
+
+// ---------------- SNAPSHOT ----------------
+
+bool VehicleSimulator::loadState(SnapshotReader &in) {
+    VehicleTable loaded;
+    if (!loaded.loadState(in)) return false;
+    replaceVehicles(std::move(loaded));
+    return true;
+}
+
+void VehicleSimulator::replaceVehicles(VehicleTable &&loaded) {
+    vehicles = std::move(loaded);
+    journal.clear();
+}
@@ -2,15 +2,16 @@
 #ifndef VEHICLE_SIMULATOR_H
 #define VEHICLE_SIMULATOR_H
 
-#include <unordered_map>
 #include <vector>
 #include <string>
+#include <limits>
 #include "TrafficController.h"
 #include "ParkingManager.h"
-#include "UndoStack.h"
+#include "UndoJournal.h"
+#include "VehicleTable.h"
 #include "../core/CoreEngineService.h"   // Person 1 integration
 
-// Represents a vehicle in the city simulation
+// Snapshot of a vehicle in the city simulation
 struct Vehicle {
     int id;
     int currentNode;
@@ -18,17 +19,32 @@ struct Vehicle {
     bool parked;
 };
 
+// Kinds of the vehicle entries in the undo journal (target: vehicle id)
+enum class VehicleChange : uint8_t {
+    Move,      // before: previous node
+    Parked     // flag: previous parked bit
+};
+
 class VehicleSimulator {
 private:
-    std::unordered_map<int, Vehicle> vehicles; // vehicleID -> Vehicle
+    VehicleTable vehicles;
 
     TrafficController *trafficController;
     ParkingManager *parkingManager;
     CoreEngineService *coreEngine;
-    UndoStack undoStack;
+    // Shared with the parking manager, which logs its own spot changes
+    UndoJournal journal;
+
+    void commitMove(uint32_t slot);
+    // Parks the vehicle in slot (its spot already assigned) and logs it
+    void recordParking(uint32_t slot);
+    void applyUndo(const UndoEntry &entry);
 
 public:
     VehicleSimulator(TrafficController *t, ParkingManager *p, CoreEngineService *c);
+    ~VehicleSimulator();
+    VehicleSimulator(const VehicleSimulator &) = delete;
+    VehicleSimulator &operator=(const VehicleSimulator &) = delete;
 
     // ---------------- VEHICLE MANAGEMENT ----------------
     void addVehicle(int id, int startNode, int destinationNode);
@@ -36,13 +52,43 @@ public:
 
     // ---------------- MOVEMENT / SIMULATION ----------------
     void moveVehicle(int id);
+    // One tick: every unparked vehicle's route is checked in parallel on the
+    // engine's worker pool, then moves and undo entries are applied in
+    // vehicle id order, so a run is identical for any thread count. Each
+    // tick starts at an undo checkpoint.
     void simulateStep();
 
+    // ---------------- STATUS ----------------
+    int vehicleCount() const { return static_cast<int>(vehicles.size()); }
+    bool getVehicle(int id, Vehicle &out) const;
+    const VehicleTable &vehicleTable() const { return vehicles; }
+    // Unparked vehicles at node
+    std::vector<int> vehiclesAt(int node) const;
+
     // ---------------- PARKING ----------------
     bool tryParking(int vehicleID, int zone);
+    // Parks in the free spot closest to the vehicle's node by road cost,
+    // in any zone (none farther than maxCost)
+    bool tryParkingNearby(int vehicleID,
+                          double maxCost = std::numeric_limits<double>::infinity());
 
     // ---------------- UNDO ----------------
+    // A move, or a parking (spot and vehicle together)
     void undoLastAction();
+    // Back to the start of the n-th latest tick; false if it is no longer
+    // in the journal
+    bool rollbackSteps(std::size_t steps);
+    // Entries kept (older ones are overwritten); drops the history
+    void setUndoCapacity(std::size_t entries, std::size_t steps = 256);
+    const UndoJournal &undoJournal() const { return journal; }
+
+    // ---------------- SNAPSHOT ----------------
+    // The vehicles only; the parking manager saves its own section.
+    // Loading replaces them and clears the undo history; replaceVehicles
+    // does the same with a table loaded on its own (VehicleTable::loadState).
+    void saveState(SnapshotWriter &out) const { vehicles.saveState(out); }
+    bool loadState(SnapshotReader &in);
+    void replaceVehicles(VehicleTable &&loaded);
 };
 
 #endif
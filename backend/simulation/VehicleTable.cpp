@@ -0,0 +1,214 @@
+// ===================== VehicleTable.cpp =====================
+#include "VehicleTable.h"
+#include "SnapshotFile.h"
+#include <algorithm>
+
+// ---------------- INDEX ----------------
+
+int64_t VehicleTable::locate(int id) const {
+    if (index.empty()) return -1;
+    uint64_t key = static_cast<uint64_t>(static_cast<uint32_t>(id)) << 32;
+    for (std::size_t i = home(id);; i = (i + 1) & mask) {
+        uint64_t entry = index[i];
+        if (entry == EMPTY) return -1;
+        if ((entry & 0xFFFFFFFF00000000ULL) == key) return static_cast<int64_t>(i);
+    }
+}
+
+void VehicleTable::place(int id, uint32_t slot) {
+    std::size_t i = home(id);
+    while (index[i] != EMPTY) i = (i + 1) & mask;
+    index[i] = (static_cast<uint64_t>(static_cast<uint32_t>(id)) << 32) | slot;
+}
+
+void VehicleTable::resizeIndex(std::size_t capacity) {
+    index.assign(capacity, EMPTY);
+    mask = capacity - 1;
+    shift = 64;
+    for (std::size_t c = capacity; c > 1; c >>= 1) --shift;
+    for (uint32_t slot = 0; slot < ids.size(); ++slot) place(ids[slot], slot);
+}
+
+// ---------------- MEMBERSHIP ----------------
+
+uint32_t VehicleTable::add(int id, int node, int destination) {
+    int64_t pos = locate(id);
+    if (pos >= 0) {
+        uint32_t slot = static_cast<uint32_t>(index[pos]);
+        nodes[slot] = node;
+        destinations[slot] = destination;
+        parkedFlags[slot] = 0;
+        cursors[slot] = 0;
+        return slot;
+    }
+
+    uint32_t slot = static_cast<uint32_t>(ids.size());
+    ids.push_back(id);
+    nodes.push_back(node);
+    destinations.push_back(destination);
+    parkedFlags.push_back(0);
+    cursors.push_back(0);
+    if (4 * ids.size() > 3 * index.size()) {
+        resizeIndex(index.empty() ? 16 : index.size() * 2);   // places this one too
+    } else {
+        place(id, slot);
+    }
+    return slot;
+}
+
+bool VehicleTable::remove(int id) {
+    int64_t pos = locate(id);
+    if (pos < 0) return false;
+
+    uint32_t slot = static_cast<uint32_t>(index[pos]);
+    uint32_t last = static_cast<uint32_t>(ids.size() - 1);
+
+    // Backward-shift delete: pull later entries of the probe run into the
+    // hole unless that would move them before their home position
+    std::size_t hole = static_cast<std::size_t>(pos);
+    for (std::size_t j = (hole + 1) & mask; index[j] != EMPTY; j = (j + 1) & mask) {
+        std::size_t want = home(static_cast<int>(index[j] >> 32));
+        bool movable = hole <= j ? (want <= hole || want > j) : (want <= hole && want > j);
+        if (movable) {
+            index[hole] = index[j];
+            hole = j;
+        }
+    }
+    index[hole] = EMPTY;
+
+    if (slot != last) {
+        ids[slot] = ids[last];
+        nodes[slot] = nodes[last];
+        destinations[slot] = destinations[last];
+        parkedFlags[slot] = parkedFlags[last];
+        cursors[slot] = cursors[last];
+        int64_t moved = locate(ids[slot]);
+        index[moved] = (index[moved] & 0xFFFFFFFF00000000ULL) | slot;
+    }
+    ids.pop_back();
+    nodes.pop_back();
+    destinations.pop_back();
+    parkedFlags.pop_back();
+    cursors.pop_back();
+    return true;
+}
+
+int64_t VehicleTable::find(int id) const {
+    int64_t pos = locate(id);
+    return pos < 0 ? -1 : static_cast<int64_t>(static_cast<uint32_t>(index[pos]));
+}
+
+void VehicleTable::reserve(std::size_t vehicles) {
+    ids.reserve(vehicles);
+    nodes.reserve(vehicles);
+    destinations.reserve(vehicles);
+    parkedFlags.reserve(vehicles);
+    cursors.reserve(vehicles);
+    std::size_t capacity = 16;
+    while (3 * capacity < 4 * vehicles) capacity *= 2;
+    if (capacity > index.size()) resizeIndex(capacity);
+}
+
+void VehicleTable::clear() {
+    ids.clear();
+    nodes.clear();
+    destinations.clear();
+    parkedFlags.clear();
+    cursors.clear();
+    std::fill(index.begin(), index.end(), EMPTY);
+}
+
+// ---------------- FILTERS ----------------
+
+void VehicleTable::unparked(std::vector<uint32_t> &out) const {
+    std::size_t count = ids.size();
+    out.resize(count);
+    const uint8_t *parked = parkedFlags.data();
+    uint32_t *dst = out.data();
+    std::size_t k = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        dst[k] = static_cast<uint32_t>(i);
+        k += parked[i] == 0;
+    }
+    out.resize(k);
+}
+
+void VehicleTable::unparkedAt(int node, std::vector<uint32_t> &out) const {
+    std::size_t count = ids.size();
+    out.resize(count);
+    const int32_t *at = nodes.data();
+    const uint8_t *parked = parkedFlags.data();
+    uint32_t *dst = out.data();
+    std::size_t k = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        dst[k] = static_cast<uint32_t>(i);
+        k += (at[i] == node) & (parked[i] == 0);
+    }
+    out.resize(k);
+}
+
+// ---------------- SNAPSHOT ----------------
+
+namespace {
+constexpr uint32_t VEHICLES_VERSION = 1;
+}
+
+void VehicleTable::saveState(SnapshotWriter &out) const {
+    out.beginSection(SNAPSHOT_VEHICLES, VEHICLES_VERSION);
+    out.putArray(ids);
+    out.putArray(nodes);
+    out.putArray(destinations);
+    out.putArray(parkedFlags);
+    out.putArray(cursors);
+    out.putArray(index);
+    out.endSection();
+}
+
+bool VehicleTable::loadState(SnapshotReader &in) {
+    uint32_t version = 0;
+    VehicleTable loaded;
+    if (!in.enter(SNAPSHOT_VEHICLES, VEHICLES_VERSION, version) || !in.getArray(loaded.ids) ||
+        !in.getArray(loaded.nodes) || !in.getArray(loaded.destinations) ||
+        !in.getArray(loaded.parkedFlags) || !in.getArray(loaded.cursors) ||
+        !in.getArray(loaded.index)) {
+        return false;
+    }
+    std::size_t count = loaded.ids.size();
+    std::size_t capacity = loaded.index.size();
+    if (loaded.nodes.size() != count || loaded.destinations.size() != count ||
+        loaded.parkedFlags.size() != count || loaded.cursors.size() != count ||
+        (capacity & (capacity - 1)) != 0 || 4 * count > 3 * capacity) {
+        return in.fail("vehicle columns do not match");
+    }
+
+    // The index is taken as saved (no rehash) once every entry points at
+    // its own vehicle and is the one a lookup of that id reaches from its
+    // home slot; that also rules out an id indexed twice, so with one entry
+    // per vehicle every slot is covered exactly once
+    if (capacity > 0) {
+        loaded.mask = capacity - 1;
+        for (std::size_t c = capacity; c > 1; c >>= 1) --loaded.shift;
+    }
+    std::size_t used = 0;
+    for (std::size_t i = 0; i < capacity; ++i) {
+        uint64_t entry = loaded.index[i];
+        if (entry == EMPTY) continue;
+        uint32_t slot = static_cast<uint32_t>(entry);
+        if (slot >= count || static_cast<uint32_t>(loaded.ids[slot]) != static_cast<uint32_t>(entry >> 32) ||
+            loaded.locate(loaded.ids[slot]) != static_cast<int64_t>(i)) {
+            return in.fail("vehicle index does not match the columns");
+        }
+        ++used;
+    }
+    if (used != count) return in.fail("vehicle index does not match the columns");
+    *this = std::move(loaded);
+    return true;
+}
+
+std::size_t VehicleTable::memoryBytes() const {
+    std::size_t columns = ids.capacity() * sizeof(int32_t) + nodes.capacity() * sizeof(int32_t) +
+                          destinations.capacity() * sizeof(int32_t) +
+                          parkedFlags.capacity() * sizeof(uint8_t) +
+                          cursors.capacity() * sizeof(uint32_t);
+    return columns + index.capacity() * sizeof(uint64_t);
+}
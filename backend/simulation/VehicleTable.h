@@ -0,0 +1,88 @@
+// ===================== VehicleTable.h =====================
+#ifndef VEHICLE_TABLE_H
+#define VEHICLE_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class SnapshotWriter;
+class SnapshotReader;
+
+// Dense structure-of-arrays store of the simulated vehicles. Vehicle ids
+// map to slots 0 .. size()-1; each field is one contiguous array indexed
+// by slot, so a tick scans plain arrays. Removing a vehicle moves the last
+// slot into the hole (swap-remove), so slots of other vehicles may change
+// on remove and iteration order is not id order.
+//
+// The id -> slot index is an open-addressing table of packed (id, slot)
+// words with linear probing and backward-shift deletion: 8 bytes per
+// entry, at most 3/4 full, no per-vehicle allocation.
+class VehicleTable {
+private:
+    static constexpr uint64_t EMPTY = ~0ULL;   // slot 0xffffffff never occurs
+
+    std::vector<int32_t> ids;
+    std::vector<int32_t> nodes;           // current node
+    std::vector<int32_t> destinations;
+    std::vector<uint8_t> parkedFlags;     // 0 / 1
+    std::vector<uint32_t> cursors;        // position along the vehicle's route
+    std::vector<uint64_t> index;          // (uint32 id << 32) | slot, or EMPTY
+    std::size_t mask = 0;
+    int shift = 64;                       // 64 - log2(index.size())
+
+    // Fibonacci hashing: the top bits of id * 2^64 / phi
+    std::size_t home(int id) const {
+        return static_cast<std::size_t>(
+            (static_cast<uint64_t>(static_cast<uint32_t>(id)) * 0x9E3779B97F4A7C15ULL) >> shift);
+    }
+    void resizeIndex(std::size_t capacity);
+    // Position of id in index, -1 if absent
+    int64_t locate(int id) const;
+    void place(int id, uint32_t slot);
+
+public:
+    // ---------------- MEMBERSHIP ----------------
+    // Returns the vehicle's slot; an id already present keeps its slot and
+    // gets the new fields (unparked, cursor 0)
+    uint32_t add(int id, int node, int destination);
+    // False if unknown
+    bool remove(int id);
+    // -1 if unknown
+    int64_t find(int id) const;
+    std::size_t size() const { return ids.size(); }
+    void reserve(std::size_t vehicles);
+    void clear();
+
+    // ---------------- FIELDS (by slot) ----------------
+    int id(uint32_t slot) const { return ids[slot]; }
+    int node(uint32_t slot) const { return nodes[slot]; }
+    int destination(uint32_t slot) const { return destinations[slot]; }
+    bool parked(uint32_t slot) const { return parkedFlags[slot] != 0; }
+    uint32_t cursor(uint32_t slot) const { return cursors[slot]; }
+    void setNode(uint32_t slot, int node) { nodes[slot] = node; }
+    void setDestination(uint32_t slot, int destination) { destinations[slot] = destination; }
+    void setParked(uint32_t slot, bool parked) { parkedFlags[slot] = parked ? 1 : 0; }
+    void setCursor(uint32_t slot, uint32_t cursor) { cursors[slot] = cursor; }
+
+    // Whole columns, size() entries each
+    const int32_t *idColumn() const { return ids.data(); }
+    const int32_t *nodeColumn() const { return nodes.data(); }
+    const int32_t *destinationColumn() const { return destinations.data(); }
+    const uint8_t *parkedColumn() const { return parkedFlags.data(); }
+
+    // ---------------- FILTERS ----------------
+    // Slots of unparked vehicles, in slot order (replaces out). Branch-free
+    // loops over the columns, which the compiler can vectorise.
+    void unparked(std::vector<uint32_t> &out) const;
+    // Same, only those at node
+    void unparkedAt(int node, std::vector<uint32_t> &out) const;
+
+    // Columns and id index as a snapshot section; loading replaces them
+    void saveState(SnapshotWriter &out) const;
+    bool loadState(SnapshotReader &in);
+
+    std::size_t memoryBytes() const;
+};
+
+#endif
@@ -0,0 +1,75 @@
+// ===================== GraphConvert.cpp =====================
+// Converts the text city graph (node file "id [lat lon]", edge file
+// "u v w [id]") into the binary graph file the engine maps at startup.
+//
+//   GraphConvert <nodes.txt> <edges.txt> <out.graph>
+//   GraphConvert --check <file.graph>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include "GraphFile.h"
+#include "GraphManager.h"
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+int check(const std::string &path) {
+    auto t0 = std::chrono::steady_clock::now();
+    GraphFileView view;
+    std::string error;
+    if (!openGraphFile(path, view, error, true)) {
+        std::fprintf(stderr, "%s: %s\n", path.c_str(), error.c_str());
+        return 1;
+    }
+    std::printf("%s: version %u, %u nodes, %u edges, %s, %llu bytes, checksum ok (%.3f s)\n",
+                path.c_str(), view.header.version, view.header.nodes, view.header.edges,
+                view.lat ? "with coordinates" : "no coordinates",
+                static_cast<unsigned long long>(view.header.fileBytes), secondsSince(t0));
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    if (argc == 3 && std::string(argv[1]) == "--check") return check(argv[2]);
+    if (argc != 4) {
+        std::fprintf(stderr, "usage: %s <nodes.txt> <edges.txt> <out.graph>\n"
+                             "       %s --check <file.graph>\n", argv[0], argv[0]);
+        return 2;
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    GraphManager graph;
+    graph.loadGraph(argv[1], argv[2]);
+    graph.freeze();
+    double parseSec = secondsSince(t0);
+    if (graph.edgeCount() == 0) {
+        std::fprintf(stderr, "no roads read from %s\n", argv[2]);
+        return 1;
+    }
+
+    t0 = std::chrono::steady_clock::now();
+    if (!graph.saveBinaryGraph(argv[3])) return 1;
+    double writeSec = secondsSince(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    GraphManager mapped;
+    if (!mapped.loadBinaryGraph(argv[3])) return 1;
+    double loadSec = secondsSince(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    GraphManager unchecked;
+    unchecked.loadBinaryGraph(argv[3], false);
+    double mapSec = secondsSince(t0);
+
+    std::printf("%d nodes, %zu edges%s\n", graph.nodeCount(), graph.edgeCount(),
+                graph.hasCoordinates() ? ", with coordinates" : "");
+    std::printf("text parse      : %8.3f s\n", parseSec);
+    std::printf("binary write    : %8.3f s\n", writeSec);
+    std::printf("binary load     : %8.3f s  (checksum verified)\n", loadSec);
+    std::printf("binary map only : %8.3f s\n", mapSec);
+    return 0;
+}